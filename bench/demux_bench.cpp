@@ -0,0 +1,180 @@
+// 解复用 IO 基准: libavformat 默认 file 协议 vs mmap 输入 (MmapInput)
+//
+// 两种方式各自完整解复用同一文件 (打开 + 探测 + av_read_frame 读完所有包), 对比
+// 吞吐、CPU 时间、read 系统调用次数 (/proc/self/io 的 syscr) 和缺页次数.
+// 应使用 1 GB 以上的文件, 否则打开和探测的固定开销占比过大.
+// --cold 在每一轮之前用 posix_fadvise(POSIX_FADV_DONTNEED) 把文件逐出页缓存 (不需要 root),
+// 对比的是真正从磁盘读取; 不加时第一轮之后文件通常已在页缓存中.
+//
+// 用法: xmake build demux_bench && xmake run demux_bench -i movie.mkv [-n 轮数] [--cold]
+
+#include <algorithm>
+#include <avplayer/core.hpp>
+#include <avplayer/logger.hpp>
+#include <avplayer/mmap_io.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cxxopts.hpp>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 进程级计数的快照
+struct Counters {
+    uint64_t read_syscalls_{0};  // read 类系统调用次数
+    uint64_t minor_faults_{0};   // 不需要读盘的缺页 (页已在页缓存中)
+    uint64_t major_faults_{0};   // 需要读盘的缺页
+    double cpu_sec_{0};          // 用户态 + 内核态
+};
+
+Counters Sample() {
+    Counters counters;
+#ifdef __linux__
+    std::ifstream io{"/proc/self/io"};
+    std::string key;
+    uint64_t value = 0;
+    while (io >> key >> value) {
+        if (key == "syscr:") {
+            counters.read_syscalls_ = value;
+        }
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    counters.minor_faults_ = static_cast<uint64_t>(usage.ru_minflt);
+    counters.major_faults_ = static_cast<uint64_t>(usage.ru_majflt);
+    counters.cpu_sec_ = static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                        static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+    return counters;
+}
+
+// 把文件逐出页缓存 (只对未修改的页有效, 普通媒体文件都满足)
+void EvictPageCache(const std::string& path) {
+#ifdef __linux__
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+struct Result {
+    bool ok_{false};
+    double wall_sec_{0};
+    uint64_t io_bytes_{0};
+    uint64_t packets_{0};
+    Counters delta_;
+    avplayer::MmapInput::Stats mmap_;
+};
+
+// 完整解复用一次 (use_mmap 为 true 时通过 MmapInput 读取)
+Result Demux(const std::string& path, bool use_mmap) {
+    Result result;
+    Counters before = Sample();
+    auto start = Clock::now();
+
+    avplayer::MmapInput mmap_input;  // NOTE: 必须比 format_ctx 活得更久
+    AVFormatContext* fmt_ctx = avformat_alloc_context();
+    if (use_mmap) {
+        if (!mmap_input.Open(path)) {
+            avformat_free_context(fmt_ctx);
+            return result;
+        }
+        fmt_ctx->pb = mmap_input.GetContext();
+    }
+    if (avformat_open_input(&fmt_ctx, path.c_str(), nullptr, nullptr) < 0) {
+        return result;
+    }
+    avplayer::UniqueAVFormatContext format_ctx{fmt_ctx};
+    if (avformat_find_stream_info(format_ctx.get(), nullptr) < 0) {
+        return result;
+    }
+    avplayer::UniqueAVPacket packet{av_packet_alloc()};
+    while (av_read_frame(format_ctx.get(), packet.get()) >= 0) {
+        ++result.packets_;
+        av_packet_unref(packet.get());
+    }
+    result.io_bytes_ = format_ctx->pb ? static_cast<uint64_t>(format_ctx->pb->bytes_read) : 0;
+    format_ctx.reset();
+
+    result.wall_sec_ = std::chrono::duration<double>(Clock::now() - start).count();
+    Counters after = Sample();
+    result.delta_.read_syscalls_ = after.read_syscalls_ - before.read_syscalls_;
+    result.delta_.minor_faults_ = after.minor_faults_ - before.minor_faults_;
+    result.delta_.major_faults_ = after.major_faults_ - before.major_faults_;
+    result.delta_.cpu_sec_ = after.cpu_sec_ - before.cpu_sec_;
+    result.mmap_ = mmap_input.GetStats();
+    result.ok_ = true;
+    return result;
+}
+
+void Report(const char* name, const Result& result) {
+    if (!result.ok_) {
+        std::printf("%-8s %10s\n", name, "failed");
+        return;
+    }
+    // mmap 输入没有 read 系统调用, 与 IO 相关的系统调用只有 madvise
+    uint64_t syscalls = result.delta_.read_syscalls_ + result.mmap_.madvise_calls_;
+    std::printf("%-8s %9.2f %9.1f %9.2f %10llu %10llu %10llu %10llu\n", name, result.wall_sec_,
+                result.io_bytes_ / 1048576.0 / result.wall_sec_, result.delta_.cpu_sec_,
+                static_cast<unsigned long long>(result.packets_),
+                static_cast<unsigned long long>(syscalls),
+                static_cast<unsigned long long>(result.delta_.minor_faults_),
+                static_cast<unsigned long long>(result.delta_.major_faults_));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options(argv[0], "解复用 IO 基准: file 协议 vs mmap 输入");
+    std::string path;
+    // clang-format off
+    options.add_options()
+      ("h,help", "打印帮助信息")
+      ("i,inputfile", "媒体文件 (建议 1 GB 以上)", cxxopts::value<std::string>(path))
+      ("n,rounds", "每种方式的轮数 (交替进行)", cxxopts::value<int>()->default_value("3"))
+      ("cold", "每一轮之前把文件逐出页缓存");
+    // clang-format on
+    options.parse_positional({"inputfile"});
+    auto result = options.parse(argc, argv);
+    if (result.count("help") || path.empty()) {
+        std::printf("%s\n", options.help().c_str());
+        return path.empty() ? 1 : 0;
+    }
+    int rounds = std::max(1, result["rounds"].as<int>());
+    bool cold = result.count("cold") > 0;
+    spdlog::set_level(spdlog::level::warn);  // 每轮打开文件的日志会打乱结果表格
+
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    auto file_size = static_cast<double>(file.tellg());
+    std::printf("file=%s size=%.2f GB rounds=%d cache=%s\n", path.c_str(), file_size / 1073741824.0,
+                rounds, cold ? "cold" : "warm");
+    if (file_size < 1073741824.0) {
+        std::printf("NOTE: 文件小于 1 GB, 打开和探测的固定开销会掩盖读取方式的差异\n");
+    }
+    std::printf("%-8s %9s %9s %9s %10s %10s %10s %10s\n", "mode", "wall s", "MB/s", "cpu s",
+                "packets", "syscalls", "minflt", "majflt");
+    // 两种方式交替进行, 避免页缓存状态和 CPU 频率的变化只影响其中一种
+    for (int round = 0; round < rounds; ++round) {
+        for (bool use_mmap : {false, true}) {
+            if (cold) {
+                EvictPageCache(path);
+            }
+            Report(use_mmap ? "mmap" : "file", Demux(path, use_mmap));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+// PacketQueue 竞争微基准: 无锁 SPSC 环形队列 vs 原 std::queue + std::condition_variable 实现
+//
+// 模拟播放器音频路径: 生产者线程 (ReadLoop) 阻塞 Push, 消费者线程 (SDL 音频回调) 轮询 TryPop,
+// 另起若干空转线程制造 CPU 超订, 放大 "持锁线程被抢占" 对 TryPop 尾延迟的影响.
+//
+// 用法: xmake build packet_queue_bench && xmake run packet_queue_bench [-n 包数] [-t 干扰线程数]
+
+#include <algorithm>
+#include <atomic>
+#include <avplayer/core.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cxxopts.hpp>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using avplayer::UniqueAVPacket;
+using Clock = std::chrono::steady_clock;
+
+// 原实现 (互斥锁 + 条件变量), 仅保留基准需要的接口
+class LockedPacketQueue {
+public:
+    explicit LockedPacketQueue(std::size_t max_data_bytes) : max_data_bytes_(max_data_bytes) {}
+
+    bool Push(UniqueAVPacket packet) {
+        std::unique_lock lk{mtx_};
+        cv_can_push_.wait(lk, [this] { return closed_ || curr_data_bytes_ < max_data_bytes_; });
+        if (closed_) {
+            return false;
+        }
+        curr_data_bytes_ += packet->size;
+        queue_.push(std::move(packet));
+        cv_can_pop_.notify_one();
+        return true;
+    }
+
+    std::optional<UniqueAVPacket> TryPop() {
+        std::unique_lock lk{mtx_};
+        if (queue_.empty()) {
+            return std::nullopt;
+        }
+        auto packet{std::move(queue_.front())};
+        queue_.pop();
+        curr_data_bytes_ -= packet->size;
+        cv_can_push_.notify_one();
+        return packet;
+    }
+
+    void Close() {
+        std::unique_lock lk{mtx_};
+        closed_ = true;
+        cv_can_pop_.notify_all();
+        cv_can_push_.notify_all();
+    }
+
+private:
+    std::queue<UniqueAVPacket> queue_;
+    std::size_t curr_data_bytes_{0};
+    std::size_t max_data_bytes_{0};
+    std::mutex mtx_;
+    std::condition_variable cv_can_pop_;
+    std::condition_variable cv_can_push_;
+    bool closed_{false};
+};
+
+struct BenchResult {
+    double seconds{};
+    std::vector<int64_t> try_pop_ns;  // 每次 TryPop 调用耗时 (含空队列)
+};
+
+template <typename Queue>
+BenchResult RunBench(Queue& queue, int num_packets, int packet_bytes) {
+    BenchResult result;
+    result.try_pop_ns.reserve(static_cast<std::size_t>(num_packets) * 4);
+
+    auto start = Clock::now();
+    std::jthread producer{[&] {
+        for (int i = 0; i < num_packets; ++i) {
+            UniqueAVPacket packet{av_packet_alloc()};
+            packet->size = packet_bytes;  // 只参与字节预算统计, 不分配数据区
+            packet->duration = 1;
+            queue.Push(std::move(packet));
+        }
+    }};
+
+    int received = 0;
+    while (received < num_packets) {
+        auto t0 = Clock::now();
+        auto packet = queue.TryPop();
+        auto t1 = Clock::now();
+        result.try_pop_ns.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        if (packet) {
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    queue.Close();
+    return result;
+}
+
+void Report(const char* name, BenchResult& result, int num_packets) {
+    auto& ns = result.try_pop_ns;
+    std::sort(ns.begin(), ns.end());
+    auto percentile = [&](double p) {
+        return ns[std::min(ns.size() - 1, static_cast<std::size_t>(p * ns.size()))];
+    };
+    std::printf("%-10s %10.2f %10lld %10lld %10lld %12lld\n", name,
+                num_packets / result.seconds / 1e6, static_cast<long long>(percentile(0.50)),
+                static_cast<long long>(percentile(0.99)),
+                static_cast<long long>(percentile(0.999)), static_cast<long long>(ns.back()));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options(argv[0], "PacketQueue 竞争微基准");
+    // clang-format off
+    options.add_options()
+      ("h,help", "打印帮助信息")
+      ("n,packets", "传输的包数量", cxxopts::value<int>()->default_value("2000000"))
+      ("s,size", "每个包计入预算的字节数", cxxopts::value<int>()->default_value("512"))
+      ("b,budget", "队列字节预算", cxxopts::value<int>()->default_value("262144"))
+      ("t,noise", "空转干扰线程数 (默认: 硬件线程数)", cxxopts::value<int>()->default_value("-1"));
+    // clang-format on
+    auto result = options.parse(argc, argv);
+    if (result.count("help")) {
+        std::printf("%s\n", options.help().c_str());
+        return 0;
+    }
+    int num_packets = result["packets"].as<int>();
+    int packet_bytes = result["size"].as<int>();
+    auto budget = static_cast<std::size_t>(result["budget"].as<int>());
+    int noise = result["noise"].as<int>();
+    if (noise < 0) {
+        noise = static_cast<int>(std::thread::hardware_concurrency());
+    }
+
+    // 干扰线程: 与生产者/消费者争抢 CPU, 使持锁线程更容易被抢占
+    std::atomic_bool stop_noise{false};
+    std::vector<std::jthread> noise_threads;
+    for (int i = 0; i < noise; ++i) {
+        noise_threads.emplace_back([&] {
+            while (!stop_noise.load(std::memory_order_relaxed)) {
+            }
+        });
+    }
+
+    std::printf("packets=%d size=%dB budget=%zuB noise_threads=%d\n", num_packets, packet_bytes,
+                budget, noise);
+    std::printf("%-10s %10s %10s %10s %10s %12s\n", "queue", "Mpkt/s", "p50(ns)", "p99(ns)",
+                "p99.9(ns)", "max(ns)");
+    {
+        LockedPacketQueue queue{budget};
+        auto bench = RunBench(queue, num_packets, packet_bytes);
+        Report("mutex+cv", bench, num_packets);
+    }
+    {
+        avplayer::PacketQueue queue{budget};
+        auto bench = RunBench(queue, num_packets, packet_bytes);
+        Report("spsc-ring", bench, num_packets);
+    }
+
+    stop_noise.store(true);
+    return 0;
+}
@@ -0,0 +1,237 @@
+// 预读输入基准与校验: ReadAheadInput 的 io_uring 后端 vs 线程池后端
+//
+// 每个后端先通过 AVIOContext 顺序读完整个文件, 再做若干次随机 seek + 读取, 与直接 pread
+// 读到的数据逐字节比对; 数据不一致时以非零状态退出. 输出实际使用的后端 (内核不支持
+// IORING_OP_READ 时为 "io_uring (readv)"), 吞吐、请求数和平均队列深度.
+// --io-throttle-mbps / --io-latency-ms 模拟慢速存储, 与播放器的同名选项相同.
+//
+// 用法: xmake build read_ahead_bench && xmake run read_ahead_bench -i movie.mkv [-n 轮数]
+
+#include <algorithm>
+#include <avplayer/core.hpp>
+#include <avplayer/logger.hpp>
+#include <avplayer/read_ahead.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cxxopts.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kChunkSize = 32 * 1024;  // 每次 avio_read 的大小 (与 libavformat 的默认缓冲相同)
+
+// 直接 pread 的参考数据
+class Reference {
+public:
+    explicit Reference(const std::string& path) {
+#ifdef __linux__
+        fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ >= 0) {
+            size_ = lseek(fd_, 0, SEEK_END);
+        }
+#else
+        (void)path;
+#endif
+    }
+    ~Reference() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+    Reference(const Reference&) = delete;
+
+    int64_t Size() const { return size_; }
+
+    // 读取 [offset, offset + length), 返回读到的字节数
+    int64_t Read(int64_t offset, uint8_t* data, int64_t length) const {
+        int64_t total = 0;
+#ifdef __linux__
+        while (total < length) {
+            ssize_t bytes = pread(fd_, data + total, static_cast<std::size_t>(length - total),
+                                  offset + total);
+            if (bytes <= 0) {
+                break;
+            }
+            total += bytes;
+        }
+#else
+        (void)offset;
+        (void)data;
+        (void)length;
+#endif
+        return total;
+    }
+
+    // 整个文件的 FNV-1a 哈希
+    uint64_t Hash() const;
+
+private:
+    int fd_{-1};
+    int64_t size_{0};
+};
+
+uint64_t Fnv1a(uint64_t hash, const uint8_t* data, std::size_t length) {
+    for (std::size_t i = 0; i < length; ++i) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+
+uint64_t Reference::Hash() const {
+    std::vector<uint8_t> buffer(avplayer::kReadAheadBlockSize);
+    uint64_t hash = kFnvOffset;
+    for (int64_t offset = 0; offset < size_;) {
+        int64_t bytes = Read(offset, buffer.data(), static_cast<int64_t>(buffer.size()));
+        if (bytes <= 0) {
+            break;
+        }
+        hash = Fnv1a(hash, buffer.data(), static_cast<std::size_t>(bytes));
+        offset += bytes;
+    }
+    return hash;
+}
+
+struct Result {
+    bool ok_{false};      // 打开成功且数据一致
+    std::string error_;   // 失败原因
+    double wall_sec_{0};  // 顺序读取耗时
+    uint64_t bytes_{0};   // 顺序读取的字节数
+    int seek_reads_{0};   // 随机读取次数
+    avplayer::ReadAheadInput::Stats stats_;
+};
+
+Result Run(const Reference& reference, uint64_t expected_hash, bool io_uring,
+           const avplayer::ReadAheadInput::Options& base, const std::string& path, int seeks) {
+    Result result;
+    result.stats_.backend_ = io_uring ? "io_uring" : "线程池 pread";
+    avplayer::ReadAheadInput input;
+    auto options = base;
+    options.io_uring = io_uring;
+    if (!input.Open(path, options)) {
+        result.error_ = "打开失败";
+        return result;
+    }
+    result.stats_.backend_ = input.GetStats().backend_;  // 实际使用的后端
+    AVIOContext* io_ctx = input.GetContext();
+    std::vector<uint8_t> buffer(kChunkSize);
+    std::vector<uint8_t> expected(kChunkSize);
+
+    // 顺序读完整个文件
+    auto start = Clock::now();
+    uint64_t hash = kFnvOffset;
+    while (true) {
+        int bytes = avio_read(io_ctx, buffer.data(), kChunkSize);
+        if (bytes <= 0) {
+            if (bytes != AVERROR_EOF) {
+                result.error_ = "顺序读取失败: " + std::string{av_err2str(bytes)};
+                return result;
+            }
+            break;
+        }
+        hash = Fnv1a(hash, buffer.data(), static_cast<std::size_t>(bytes));
+        result.bytes_ += static_cast<uint64_t>(bytes);
+    }
+    result.wall_sec_ = std::chrono::duration<double>(Clock::now() - start).count();
+    if (result.bytes_ != static_cast<uint64_t>(reference.Size()) || hash != expected_hash) {
+        result.error_ = "顺序读取的数据与 pread 不一致";
+        return result;
+    }
+
+    // 随机 seek + 读取 (固定种子, 两个后端读取相同的位置)
+    std::mt19937_64 rng{42};
+    std::uniform_int_distribution<int64_t> position{0, reference.Size() - 1};
+    for (int i = 0; i < seeks; ++i) {
+        int64_t offset = position(rng);
+        if (avio_seek(io_ctx, offset, SEEK_SET) != offset) {
+            result.error_ = "seek 失败";
+            return result;
+        }
+        int bytes = avio_read(io_ctx, buffer.data(), kChunkSize);
+        int64_t want = reference.Read(offset, expected.data(), kChunkSize);
+        if (bytes != want ||
+            std::memcmp(buffer.data(), expected.data(), static_cast<std::size_t>(want)) != 0) {
+            result.error_ = "偏移 " + std::to_string(offset) + " 处随机读取的数据与 pread 不一致";
+            return result;
+        }
+        ++result.seek_reads_;
+    }
+    result.stats_ = input.GetStats();
+    result.ok_ = true;
+    return result;
+}
+
+void Report(const Result& result) {
+    if (!result.ok_) {
+        std::printf("%-18s FAILED: %s\n", result.stats_.backend_, result.error_.c_str());
+        return;
+    }
+    std::printf("%-18s %9.2f %9.1f %10llu %10.2f %8d %8s\n", result.stats_.backend_,
+                result.wall_sec_, result.bytes_ / 1048576.0 / result.wall_sec_,
+                static_cast<unsigned long long>(result.stats_.requests_),
+                result.stats_.avg_queue_depth_, result.seek_reads_, "ok");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options(argv[0], "预读输入基准与校验: io_uring vs 线程池");
+    std::string path;
+    // clang-format off
+    options.add_options()
+      ("h,help", "打印帮助信息")
+      ("i,inputfile", "输入文件", cxxopts::value<std::string>(path))
+      ("n,rounds", "每个后端的轮数 (交替进行)", cxxopts::value<int>()->default_value("3"))
+      ("window", "预读窗口块数 (块大小 1 MB)", cxxopts::value<int>()->default_value(std::to_string(avplayer::kReadAheadWindowMb)))
+      ("seeks", "每轮随机 seek + 读取的次数", cxxopts::value<int>()->default_value("200"))
+      ("io-throttle-mbps", "模拟慢速存储的带宽 MB/s (0 表示不限)", cxxopts::value<double>()->default_value("0"))
+      ("io-latency-ms", "模拟慢速存储每个读请求的延迟 (毫秒)", cxxopts::value<double>()->default_value("0"));
+    // clang-format on
+    options.parse_positional({"inputfile"});
+    auto result = options.parse(argc, argv);
+    if (result.count("help") || path.empty()) {
+        std::printf("%s\n", options.help().c_str());
+        return path.empty() ? 1 : 0;
+    }
+    int rounds = std::max(1, result["rounds"].as<int>());
+    int seeks = std::max(0, result["seeks"].as<int>());
+    avplayer::ReadAheadInput::Options io_options;
+    io_options.window_blocks = std::max(0, result["window"].as<int>());
+    io_options.throttle_mbps = result["io-throttle-mbps"].as<double>();
+    io_options.latency_ms = result["io-latency-ms"].as<double>();
+    spdlog::set_level(spdlog::level::warn);  // 每轮打开文件的日志会打乱结果表格
+
+    Reference reference{path};
+    if (reference.Size() <= 0) {
+        std::printf("无法读取 %s\n", path.c_str());
+        return 1;
+    }
+    uint64_t expected_hash = reference.Hash();
+    std::printf("file=%s size=%.1f MB window=%d rounds=%d\n", path.c_str(),
+                reference.Size() / 1048576.0, io_options.window_blocks, rounds);
+    std::printf("%-18s %9s %9s %10s %10s %8s %8s\n", "backend", "wall s", "MB/s", "requests",
+                "avg depth", "seeks", "data");
+    bool ok = true;
+    // 两个后端交替进行, 避免页缓存状态的变化只影响其中一种
+    for (int round = 0; round < rounds; ++round) {
+        for (bool io_uring : {true, false}) {
+            Result run = Run(reference, expected_hash, io_uring, io_options, path, seeks);
+            Report(run);
+            ok = ok && run.ok_;
+        }
+    }
+    return ok ? 0 : 1;
+}
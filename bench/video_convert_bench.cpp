@@ -0,0 +1,179 @@
+// 10 位 -> 8 位视频转换微基准: VideoConverter 的 SIMD 内核 (各指令集级别) vs 通用 swscale
+//
+// 用同一组合成的 10 位帧 (yuv420p10le / P010, 渐变 + 噪声) 分别转换为 8 位 YUV420P,
+// 对比每帧耗时. swscale 使用转换前播放器的参数 (SWS_BILINEAR), 线程数可调.
+//
+// 用法: xmake build video_convert_bench && xmake run video_convert_bench [-s 3840x2160] [-n 帧数]
+
+#include <algorithm>
+#include <avplayer/core.hpp>
+#include <avplayer/video_convert.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cxxopts.hpp>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+namespace {
+
+using avplayer::SimdLevel;
+using avplayer::UniqueAVFrame;
+using avplayer::UniqueSwsContext;
+using Clock = std::chrono::steady_clock;
+
+// 合成的 10 位源帧: 水平渐变叠加噪声, 避免全零数据让某条路径走捷径
+std::vector<UniqueAVFrame> MakeFrames(AVPixelFormat format, int width, int height, int count) {
+    std::vector<UniqueAVFrame> frames;
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> noise{-32, 32};
+    int shift = format == AV_PIX_FMT_P010LE ? 6 : 0;  // P010 的样本在高 10 位
+    for (int i = 0; i < count; ++i) {
+        UniqueAVFrame frame{av_frame_alloc()};
+        frame->width = width;
+        frame->height = height;
+        frame->format = format;
+        frame->color_range = AVCOL_RANGE_MPEG;
+        if (av_frame_get_buffer(frame.get(), 0) < 0) {
+            return {};
+        }
+        int planes = format == AV_PIX_FMT_P010LE ? 2 : 3;
+        for (int plane = 0; plane < planes; ++plane) {
+            int plane_height = plane == 0 ? height : (height + 1) / 2;
+            // P010 的色度平面是交织的 UV, 每行样本数是色度宽度的两倍
+            int samples = plane == 0 ? width : (width + 1) / 2 * (planes == 2 ? 2 : 1);
+            for (int y = 0; y < plane_height; ++y) {
+                auto row = reinterpret_cast<uint16_t*>(frame->data[plane] +
+                                                       y * frame->linesize[plane]);
+                for (int x = 0; x < samples; ++x) {
+                    int value = std::clamp(64 + (x + i * 8) * 876 / samples + noise(rng), 0, 1023);
+                    row[x] = static_cast<uint16_t>(value << shift);
+                }
+            }
+        }
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+// 依次转换所有源帧, 重复 rounds 轮, 返回每帧平均耗时 (毫秒)
+double RunBench(const std::vector<UniqueAVFrame>& frames, int rounds,
+                const std::function<bool(const AVFrame*)>& convert) {
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& frame : frames) {
+            if (!convert(frame.get())) {
+                return -1;
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return elapsed / (rounds * static_cast<double>(frames.size()));
+}
+
+void Report(const char* name, double ms, double baseline_ms) {
+    if (ms < 0) {
+        std::printf("%-22s %10s\n", name, "failed");
+        return;
+    }
+    std::printf("%-22s %10.3f %10.1f %9.2fx\n", name, ms, 1000.0 / ms, baseline_ms / ms);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options(argv[0], "10 位 -> 8 位视频转换微基准");
+    // clang-format off
+    options.add_options()
+      ("h,help", "打印帮助信息")
+      ("s,size", "帧尺寸 (宽x高)", cxxopts::value<std::string>()->default_value("3840x2160"))
+      ("n,frames", "每种路径转换的帧数", cxxopts::value<int>()->default_value("200"))
+      ("t,threads", "swscale 多线程对比的线程数 (0: 不对比)", cxxopts::value<int>()->default_value("4"));
+    // clang-format on
+    auto result = options.parse(argc, argv);
+    if (result.count("help")) {
+        std::printf("%s\n", options.help().c_str());
+        return 0;
+    }
+    int width = 0;
+    int height = 0;
+    if (std::sscanf(result["size"].as<std::string>().c_str(), "%dx%d", &width, &height) != 2 ||
+        width <= 0 || height <= 0) {
+        std::printf("无效的帧尺寸\n");
+        return 1;
+    }
+    constexpr int kSourceFrames = 8;  // 轮流转换的源帧数, 覆盖多于 L2 的数据量
+    int rounds = std::max(1, result["frames"].as<int>() / kSourceFrames);
+    int sws_threads = result["threads"].as<int>();
+    SimdLevel max_level = avplayer::GetSimdLevel();
+
+    std::printf("size=%dx%d frames=%d cpu=%s\n", width, height, rounds * kSourceFrames,
+                avplayer::GetSimdLevelName(max_level));
+    for (auto format : {AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_P010LE}) {
+        auto frames = MakeFrames(format, width, height, kSourceFrames);
+        if (frames.empty()) {
+            std::printf("分配源帧失败\n");
+            return 1;
+        }
+        std::printf("\n%s -> yuv420p\n", av_get_pix_fmt_name(format));
+        std::printf("%-22s %10s %10s %10s\n", "path", "ms/frame", "fps", "speedup");
+
+        UniqueAVFrame out{av_frame_alloc()};
+        auto sws = [&](int threads) {
+            UniqueSwsContext ctx{sws_alloc_context()};
+            av_opt_set_int(ctx.get(), "srcw", width, 0);
+            av_opt_set_int(ctx.get(), "srch", height, 0);
+            av_opt_set_int(ctx.get(), "src_format", format, 0);
+            av_opt_set_int(ctx.get(), "dstw", width, 0);
+            av_opt_set_int(ctx.get(), "dsth", height, 0);
+            av_opt_set_int(ctx.get(), "dst_format", AV_PIX_FMT_YUV420P, 0);
+            av_opt_set_int(ctx.get(), "sws_flags", SWS_BILINEAR, 0);
+            av_opt_set_int(ctx.get(), "threads", threads, 0);
+            if (sws_init_context(ctx.get(), nullptr, nullptr) < 0) {
+                return -1.0;
+            }
+            return RunBench(frames, rounds, [&](const AVFrame* in) {
+                av_frame_unref(out.get());
+                return sws_scale_frame(ctx.get(), out.get(), in) >= 0;
+            });
+        };
+        double baseline = sws(1);
+        Report("swscale (1 线程)", baseline, baseline);
+        if (sws_threads > 1) {
+            auto name = "swscale (" + std::to_string(sws_threads) + " 线程)";
+            Report(name.c_str(), sws(sws_threads), baseline);
+        }
+
+        auto kernel = [&](SimdLevel level, AVColorTransferCharacteristic trc) {
+            avplayer::SetSimdLevel(level);
+            avplayer::VideoConverter converter;
+            converter.Init({}, 1, true);  // 不声明原生格式: 输出 IYUV (YUV420P)
+            UniqueAVFrame in{av_frame_alloc()};
+            uint32_t texture_format = 0;
+            return RunBench(frames, rounds, [&](const AVFrame* src) {
+                // Convert 会取走输入帧的引用, 每次先引用一份源帧
+                if (av_frame_ref(in.get(), src) < 0) {
+                    return false;
+                }
+                in->color_trc = trc;
+                av_frame_unref(out.get());
+                return converter.Convert(in.get(), out.get(), &texture_format) >= 0;
+            });
+        };
+        for (auto level : {SimdLevel::kScalar, SimdLevel::kSse41, SimdLevel::kAvx2}) {
+            if (level > max_level) {
+                continue;
+            }
+            auto name = std::string{"kernel ("} + avplayer::GetSimdLevelName(level) + ")";
+            Report(name.c_str(), kernel(level, AVCOL_TRC_UNSPECIFIED), baseline);
+        }
+        Report("kernel + PQ 色调映射", kernel(max_level, AVCOL_TRC_SMPTE2084), baseline);
+        avplayer::SetSimdLevel(max_level);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <avplayer/core.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace avplayer {
+
+// ================== Sample Conversion Kernels ==================
+// 常见解码输出格式 -> S16 交织 (SDL 输出格式)
+// x86-64 使用 SSE2, AArch64 使用 NEON, 其他平台 (以及尾部样本) 使用标量实现
+// 浮点转换与 libswresample 一致: 乘以 32768 后就近取整并饱和到 [-32768, 32767]
+// S32 转换与 libswresample 一致: 取高 16 位
+
+// FLT (交织) -> S16, count 为样本总数 (样本数 * 声道数)
+void ConvertFltToS16(const float* in, int16_t* out, std::size_t count);
+
+// S32 (交织) -> S16, count 为样本总数 (样本数 * 声道数)
+void ConvertS32ToS16(const int32_t* in, int16_t* out, std::size_t count);
+
+// FLTP (平面) -> S16 交织
+void InterleaveFltpToS16(const float* const* in, int channels, int16_t* out, std::size_t samples);
+
+// S16P (平面) -> S16 交织
+void InterleaveS16pToS16(const int16_t* const* in, int channels, int16_t* out,
+                         std::size_t samples);
+
+// S32P (平面) -> S16 交织
+void InterleaveS32pToS16(const int32_t* const* in, int channels, int16_t* out,
+                         std::size_t samples);
+
+// ================== AudioConverter Class ==================
+// 解码帧 -> SDL 输出 PCM (S16 交织) 的转换器, 仅音频解码线程使用
+// 按输入参数选择转换路径:
+// - kPassthrough: 输入已是 S16 交织且采样率/声道数与输出一致, 直接输出帧数据, 零拷贝
+// - kKernel:      采样率/声道数一致, 只需格式转换 (FLT/FLTP/S16P/S32/S32P), 使用 SIMD 内核
+// - kResample:    采样率或声道布局变化, 或其他采样格式, 交给 libswresample
+// 输出缓冲在 Init 时按 SDL_AudioSpec 一次分配, 之后不再分配: 一帧超出缓冲时分多段输出
+class AudioConverter {
+public:
+    enum class Path {
+        kPassthrough,
+        kKernel,
+        kResample,
+    };
+
+public:
+    AudioConverter() = default;
+    ~AudioConverter();
+    AudioConverter(const AudioConverter&) = delete;
+    AudioConverter(AudioConverter&&) = delete;
+
+public:
+    // 按 SDL 协商结果 (S16) 分配输出缓冲, 并根据解码器输出参数选择转换路径
+    // 失败时输出错误并返回 false (不抛出异常, 可在音频解码线程中调用), 之后的帧被丢弃
+    bool Init(const SDL_AudioSpec& spec, const AVCodecContext* codec_ctx);
+
+    // 开始转换一帧 (frame 在本帧的 Next 返回 0 之前必须保持有效)
+    // NOTE: 帧参数与当前输入参数不同时 (例如 HE-AAC 首帧后采样率变化) 重新选择路径,
+    //       失败时 (已输出错误) 丢弃这种输入的帧
+    void Begin(const AVFrame* frame);
+
+    // 取下一段输出, 返回字节数并通过 data 返回数据指针, 返回 0 表示本帧已转换完
+    std::size_t Next(const uint8_t** data);
+
+    // 输入结束 (播放列表切换到下一项之前): 之后的 Next 取出重采样器内部缓存的样本,
+    // 返回 0 时已取完; 其他路径没有缓存, 直接返回 0
+    void BeginDrain();
+    // 丢弃重采样器内部缓存的样本 (seek 之后调用)
+    void Reset();
+
+    Path GetPath() const { return path_; }
+
+private:
+    // 按输入参数选择转换路径 (kResample 时创建重采样上下文), 失败时返回 false
+    bool Configure(AVSampleFormat format, const AVChannelLayout& layout, int sample_rate);
+
+    // 用 SIMD 内核转换当前帧从 offset_ 开始的 count 个样本到 output_
+    void ConvertKernel(int count);
+
+private:
+    // 输出参数 (来自 SDL_AudioSpec)
+    int out_sample_rate_{0};
+    AVChannelLayout out_layout_{};
+    int out_frame_bytes_{0};       // 每个样本 (所有声道) 的输出字节数
+    int out_capacity_{0};          // 输出缓冲可容纳的样本数
+    std::vector<uint8_t> output_;  // 输出缓冲 (仅在 Init 时分配)
+
+    // 输入参数
+    AVSampleFormat in_format_{AV_SAMPLE_FMT_NONE};
+    AVChannelLayout in_layout_{};
+    int in_sample_rate_{0};
+
+    Path path_{Path::kResample};
+    UniqueSwrContext swr_ctx_;  // 重采样上下文 (仅 kResample, 创建失败时为空)
+
+    // 当前帧转换进度
+    const AVFrame* frame_{nullptr};
+    int offset_{0};              // 已转换的样本数
+    bool resample_more_{false};  // 重采样器内部是否可能还有待输出的样本
+    bool draining_{false};       // 正在取出重采样器内部缓存的样本 (见 BeginDrain)
+};
+
+}  // namespace avplayer
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace avplayer {
+
+// ================== SeqLock Class ==================
+// 顺序锁: 读者不加锁、不阻塞写者, 读到写了一半的数据时重试; 适合小而读多写少的快照
+// - 写者: 序号由偶数 CAS 为奇数 (多个写者之间互斥, 竞争时自旋), 写入后再加 1 变回偶数
+// - 读者: 前后两次读到相同的偶数序号才接受快照
+// - 数据按 8 字节拆成原子字存储 (relaxed 读写 + 栅栏), 读者与写者之间没有数据竞争
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    SeqLock() { Store(T{}); }
+    SeqLock(const SeqLock&) = delete;
+    SeqLock(SeqLock&&) = delete;
+
+public:
+    T Load() const {
+        std::array<uint64_t, kWords> words;
+        while (true) {
+            uint32_t seq = seq_.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;  // 写者正在写入
+            }
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == seq) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    // 在写锁内读取当前值并交给 update 修改, 再整体写回
+    template <typename F>
+    void Update(F&& update) {
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        while ((seq & 1) || !seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                                        std::memory_order_relaxed)) {
+            seq = seq_.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        std::array<uint64_t, kWords> words;
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        update(value);
+        std::memcpy(words.data(), &value, sizeof(T));
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    void Store(const T& value) {
+        Update([&value](T& current) { current = value; });
+    }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> seq_{0};
+    std::array<std::atomic<uint64_t>, kWords> words_{};
+};
+
+// ================== SyncClock Class ==================
+// 同步时钟: 记录某一时刻 (系统时间) 对应的媒体时间戳, 任意时刻的时钟值按 1 倍速外推
+// (pts + 此后经过的时间, 即 drift + 当前时刻); 暂停时停在暂停时刻的值
+// - 写入 (Set) 和读取 (Get) 都不加锁 (SeqLock), 可以在音频回调等实时线程中调用
+// - 每个样本带有播放序号, 与调用者给出的当前序号不同 (seek 之后尚未重建) 时时钟无效 (NAN)
+// 所有时刻均为秒 (av_gettime_relative 时间轴)
+class SyncClock {
+public:
+    struct Sample {
+        double pts_{NAN};     // 时间戳 (秒)
+        double time_{0};      // pts_ 对应的系统时刻
+        double drift_{NAN};   // pts_ - time_, 未暂停时时钟值 = drift_ + 当前时刻
+        int serial_{-1};      // 所属的播放序号
+        bool paused_{false};  // 是否暂停
+    };
+
+public:
+    SyncClock() = default;
+    ~SyncClock() = default;
+    SyncClock(const SyncClock&) = delete;
+    SyncClock(SyncClock&&) = delete;
+
+public:
+    // 记录 time 时刻的时间戳为 pts (暂停状态不变)
+    void Set(double pts, double time, int serial);
+
+    // 暂停 (停在 time 时刻的值) 或从 time 时刻继续
+    void SetPaused(bool paused, double time);
+
+    // time 时刻的时钟值, 序号不是 serial 时返回 NAN
+    double Get(double time, int serial) const;
+
+    Sample GetSample() const { return sample_.Load(); }
+
+private:
+    SeqLock<Sample> sample_;
+};
+
+}  // namespace avplayer
@@ -4,18 +4,24 @@ extern "C" {
 #include <SDL2/SDL.h>
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
+#include <libavutil/buffer.h>
 #include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/mem.h>
+#include <libavutil/pixdesc.h>
 #include <libavutil/time.h>
 #include <libswresample/swresample.h>
+#include <libswscale/swscale.h>
 #define SDL_MAIN_HANDLED
 }
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <queue>
 #include <vector>
 
 namespace avplayer {
@@ -24,13 +30,32 @@ namespace avplayer {
 
 constexpr int kDefaultWidth = 1920;                         // SDL 窗口默认宽度
 constexpr int kDefaultHeight = 1080;                        // SDL 窗口默认高度
-constexpr int kMaxFrameQueueSize = 3;                       // 视频帧环形队列大小
-constexpr int kMaxPacketQueueDataBytes = 15 * 1024 * 1024;  // 15 MB
+constexpr int kMaxDownscaleLevel = 3;                       // 解码端降分辨率最高级别 (1/8)
+constexpr int kMaxFrameQueueSize = 3;                       // 视频帧环形队列默认大小
+constexpr int kMaxFrameQueueCapacity = 256;                 // 视频帧环形队列大小上限
+constexpr int kMaxBufferDataBytes = 64 * 1024 * 1024;       // 两路包队列共享的全局字节预算 64 MB
+constexpr double kMinBufferDuration = 1.0;                  // 包队列低水位 (秒)
+constexpr double kMaxBufferDuration = 5.0;                  // 包队列高水位 (秒)
+constexpr int kMinBufferPackets = 25;                       // 包无时长信息时, 每秒按此包数估算
+constexpr std::size_t kPacketQueueCapacity = 4096;          // 包队列环形槽位数 (2 的幂)
+constexpr std::size_t kCacheLineSize = 64;                  // 缓存行大小 (避免伪共享)
+constexpr std::size_t kPacketPoolMaxIdle = 8192;            // 包池最多缓存的空闲 AVPacket 数
 constexpr int kSdlAudioBufferSize = 1024;                   // SDL 音频缓冲区每次填充的字节数
+constexpr int kAudioBufferMs = 200;                         // PCM 环形缓冲默认填充目标 (毫秒)
 constexpr double kMaxAvSyncThreshold = 0.100;               // 100ms
 constexpr double kMinAvSyncThreshold = 0.040;               // 40ms
 constexpr double kAvNoSyncThreshold = 10.0;                 // 10s (严重到没必要同步)
-constexpr int kFFRefreshEvent = SDL_USEREVENT + 1;
+constexpr int kFrameSkipWindowMs = 500;                     // 解码跳帧反馈的评估窗口 (毫秒)
+constexpr int kFrameSkipRecoverWindows = 4;                 // 连续多少个窗口不落后才降低跳帧级别
+constexpr int kTextureRingSize = 3;                         // 纹理环上传模式的流式纹理数
+constexpr int kRenderWakeupMs = 20;                         // 渲染线程单次睡眠上限 (毫秒)
+constexpr int kMmapIoBufferSize = 1024 * 1024;              // mmap 输入的 AVIOContext 缓冲 1 MB
+constexpr int64_t kMmapReadAheadBytes = 32 * 1024 * 1024;   // mmap 输入 MADV_WILLNEED 窗口 32 MB
+constexpr int kReadAheadBlockSize = 1024 * 1024;            // 预读输入每个读请求的大小 1 MB
+constexpr int kReadAheadWindowMb = 16;                      // 预读输入默认窗口 (MB, 即块数)
+constexpr std::size_t kReadAheadMaxWorkers = 8;             // 预读输入线程池后端的最大线程数
+constexpr int kProbeCacheHeaderBytes = 64 * 1024;           // 探测缓存: 计入文件标识的文件头字节数
+constexpr double kPlaylistPreopenSec = 10.0;                 // 读到当前项最后几秒时预先打开下一项
 
 // ================== FFmpeg Deleters ==================
 
@@ -58,12 +83,12 @@ struct AVFrameDeleter {
     }
 };
 
+class PacketPool;
+
+// pool_ 非空时归还到包池 (见 PacketPool), 否则直接释放
 struct AVPacketDeleter {
-    void operator()(AVPacket* p) const {
-        if (p) {
-            av_packet_free(&p);
-        }
-    }
+    PacketPool* pool_{nullptr};
+    void operator()(AVPacket* p) const;
 };
 
 struct SwrContextDeleter {
@@ -74,6 +99,20 @@ struct SwrContextDeleter {
     }
 };
 
+struct SwsContextDeleter {
+    void operator()(SwsContext* p) const { sws_freeContext(p); }
+};
+
+// 自定义 IO 的 AVIOContext: 缓冲可能已被 libavformat 重新分配, 以 ctx->buffer 为准释放
+struct AVIOContextDeleter {
+    void operator()(AVIOContext* p) const {
+        if (p) {
+            av_freep(&p->buffer);
+            avio_context_free(&p);
+        }
+    }
+};
+
 // ================== FFmpeg unique_ptr Aliases ==================
 
 using UniqueAVFormatContext = std::unique_ptr<AVFormatContext, AVFormatContextDeleter>;
@@ -81,6 +120,57 @@ using UniqueAVCodecContext = std::unique_ptr<AVCodecContext, AVCodecContextDelet
 using UniqueAVFrame = std::unique_ptr<AVFrame, AVFrameDeleter>;
 using UniqueAVPacket = std::unique_ptr<AVPacket, AVPacketDeleter>;
 using UniqueSwrContext = std::unique_ptr<SwrContext, SwrContextDeleter>;
+using UniqueSwsContext = std::unique_ptr<SwsContext, SwsContextDeleter>;
+using UniqueAVIOContext = std::unique_ptr<AVIOContext, AVIOContextDeleter>;
+
+// ================== PacketPool Class ==================
+// AVPacket 结构体 (壳) 对象池, 避免读取线程每个包都 av_packet_alloc/av_packet_free
+// - Acquire: 仅读取线程调用, 优先复用空闲壳 (命中), 否则 av_packet_alloc (未命中)
+// - Release: 任意线程 (UniqueAVPacket 析构时), av_packet_unref 后压入无锁空闲栈
+// 空闲栈是多生产者/单消费者的: 消费者用 exchange 一次取走整条链, 因此没有 ABA 问题
+// NOTE: 空闲链借用 AVPacket::opaque 作为 next 指针 (unref 之后该字段不再有意义)
+class PacketPool {
+public:
+    struct Stats {
+        uint64_t hits_{0};     // 复用空闲壳次数
+        uint64_t misses_{0};   // 新分配次数
+        std::size_t idle_{0};  // 当前空闲壳数
+    };
+
+public:
+    explicit PacketPool(std::size_t max_idle = kPacketPoolMaxIdle) : max_idle_(max_idle) {}
+    ~PacketPool();
+    PacketPool(const PacketPool&) = delete;
+    PacketPool(PacketPool&&) = delete;
+
+public:
+    // 获取一个空包 (仅一个线程调用), 分配失败时返回空指针
+    UniqueAVPacket Acquire();
+
+    // 归还一个包 (任意线程)
+    void Release(AVPacket* packet);
+
+    Stats GetStats() const;
+
+private:
+    AVPacket* local_free_{nullptr};                // 仅 Acquire 线程访问的私有空闲链
+    std::atomic<AVPacket*> shared_free_{nullptr};  // 归还的空闲链 (Treiber 栈)
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<std::size_t> idle_{0};
+    std::size_t max_idle_{0};
+};
+
+inline void AVPacketDeleter::operator()(AVPacket* p) const {
+    if (!p) {
+        return;
+    }
+    if (pool_) {
+        pool_->Release(p);
+    } else {
+        av_packet_free(&p);
+    }
+}
 
 // ================== SDL Deleters ==================
 
@@ -114,60 +204,258 @@ using UniqueSDLWindow = std::unique_ptr<SDL_Window, SDLWindowDeleter>;
 using UniqueSDLRenderer = std::unique_ptr<SDL_Renderer, SDLRendererDeleter>;
 using UniqueSDLTexture = std::unique_ptr<SDL_Texture, SDLTextureDeleter>;
 
+// ================== AtomicSignal Class ==================
+// 基于 std::atomic::wait/notify (Linux 下即 futex) 的轻量唤醒信号
+// 等待方: 先 Prepare() 取序号 -> 检查条件 -> 条件不满足则 Wait(序号)
+// 通知方: 先修改条件 -> 再 Notify*(), 序号变化保证不会丢失唤醒
+// NOTE: 没有等待者时 notify 不会陷入内核, 只多一次原子加法
+class AtomicSignal {
+public:
+    uint32_t Prepare() const { return seq_.load(std::memory_order_acquire); }
+
+    void Wait(uint32_t seq) const { seq_.wait(seq, std::memory_order_acquire); }
+
+    void NotifyOne() {
+        seq_.fetch_add(1, std::memory_order_release);
+        seq_.notify_one();
+    }
+
+    void NotifyAll() {
+        seq_.fetch_add(1, std::memory_order_release);
+        seq_.notify_all();
+    }
+
+private:
+    std::atomic<uint32_t> seq_{0};
+};
+
 // ================== PacketQueue Class ==================
+// 有界单生产者/单消费者 (SPSC) 无锁环形包队列
+// - 生产者: ReadLoop (Push)
+// - 消费者: 解码线程 (Pop) 或 SDL 音频回调 (TryPop)
+// 边界同时受槽位数和总字节数 max_data_bytes_ 约束, 只有 Push/Pop 在满/空时才会阻塞 (futex)
+// 每个包附带播放序号 (serial), seek 后序号递增, 消费者据此识别并丢弃过期的包
 class PacketQueue {
 public:
-    PacketQueue(std::size_t max_data_bytes) : max_data_bytes_(max_data_bytes) {}
+    explicit PacketQueue(std::size_t max_data_bytes,
+                         std::size_t capacity = kPacketQueueCapacity);
     ~PacketQueue() = default;
     PacketQueue(const PacketQueue&) = delete;
     PacketQueue(PacketQueue&&) = delete;
 
 public:
-    // Push (阻塞)
-    bool Push(UniqueAVPacket packet);
+    // Push (阻塞, 仅生产者线程)
+    // time_base: 包时长的时间基, 时长入队时即换算为 AV_TIME_BASE 单位, 队列中可以混有不同
+    //            时间基的包 (播放列表切换时上一项的包尚未消耗完); 为 {0, 1} 时不计时长
+    bool Push(UniqueAVPacket packet, int serial = 0, AVRational time_base = {0, 1});
 
-    // Pop (阻塞)
-    std::optional<UniqueAVPacket> Pop();
+    // Pop (阻塞, 仅消费者线程), serial 非空时返回包的序号
+    std::optional<UniqueAVPacket> Pop(int* serial = nullptr);
 
-    // 非阻塞 Pop
-    std::optional<UniqueAVPacket> TryPop();
+    // 非阻塞 Pop (无等待, 仅消费者线程), serial 非空时返回包的序号
+    std::optional<UniqueAVPacket> TryPop(int* serial = nullptr);
 
 public:
-    // 清空队列
+    // 清空队列 (仅生产者线程)
+    // NOTE: 只记录清空位置, 被丢弃的包由消费者在下一次 Pop/TryPop 时释放;
+    //       它们的字节数和时长立即从 GetTotalDataSize/GetDuration 中扣除
     void Clear();
 
     // 关闭队列
     void Close();
 
-    // 获取当前总字节大小
+    // 获取当前总字节大小 (不含已清空的包)
     std::size_t GetTotalDataSize() const;
 
+    // 获取当前包数量
+    std::size_t GetSize() const;
+
+    // 获取当前缓冲的总时长 (秒, 不含已清空的包)
+    double GetDuration() const;
+
+private:
+    // 取出 head 处的包并推进读索引 (仅消费者线程)
+    UniqueAVPacket TakeFront(uint64_t head, int* serial = nullptr);
+
+    // 丢弃 Clear() 之前入队的包 (仅消费者线程)
+    void DropCleared();
+
+private:
+    std::vector<UniqueAVPacket> slots_;  // 环形槽位
+    std::vector<int> serials_;           // 各槽位中包的序号
+    std::vector<int64_t> durations_;     // 各槽位中包的时长 (AV_TIME_BASE 单位)
+    uint64_t mask_{0};                   // 槽位索引掩码 (容量 - 1)
+    std::size_t max_data_bytes_{0};      // 最大总字节大小
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> head_{0};  // 读索引 (消费者独占写)
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail_{0};  // 写索引 (生产者独占写)
+    alignas(kCacheLineSize) std::atomic<uint64_t> clear_index_{0};  // 该索引之前的包均已作废
+    std::atomic_bool closed_{false};                                // 队列是否已关闭
+    AtomicSignal can_pop_;                                          // 能 pop 的信号
+    AtomicSignal can_push_;                                         // 能 push 的信号
+
+    // 字节数和时长按单调递增的累计值记账: 当前值 = 入队累计 - max(出队累计, 清空时的入队累计),
+    // 已清空但尚未被消费者释放的包 [head, clear_index) 不再计入
+    alignas(kCacheLineSize) std::atomic<uint64_t> pushed_bytes_{0};  // 入队累计 (生产者独占写)
+    std::atomic<int64_t> pushed_duration_{0};  // 时长均为 AV_TIME_BASE 单位
+    std::atomic<uint64_t> cleared_bytes_{0};  // clear_index_ 之前的入队累计 (生产者独占写)
+    std::atomic<int64_t> cleared_duration_{0};
+    alignas(kCacheLineSize) std::atomic<uint64_t> popped_bytes_{0};  // 出队累计 (消费者独占写)
+    std::atomic<int64_t> popped_duration_{0};
+};
+
+// ================== PcmRingBuffer Class ==================
+// 单生产者/单消费者无锁 PCM 字节环形缓冲
+// - 生产者: 音频解码线程 (WaitUntilBelow/Write), 缓冲满时阻塞 (futex)
+// - 消费者: SDL 音频回调 (Read), 永不阻塞, 只做 memcpy;
+//           或无界面模式的空音频设备 (不按时钟消费时用 WaitForData 等待数据)
+// 读写位置为单调递增的字节计数, 同时可作为 "已写入/已播放" 的总字节数用于计算音频时钟
+class PcmRingBuffer {
+public:
+    PcmRingBuffer() = default;
+    ~PcmRingBuffer() = default;
+    PcmRingBuffer(const PcmRingBuffer&) = delete;
+    PcmRingBuffer(PcmRingBuffer&&) = delete;
+
+public:
+    // 分配缓冲 (向上取 2 的幂, 需在生产者/消费者启动前调用)
+    void SetCapacity(std::size_t capacity);
+
+    // 写入 size 字节 (空间不足时阻塞, 仅生产者线程), 关闭时返回 false
+    bool Write(const uint8_t* data, std::size_t size);
+
+    // 阻塞直到缓冲字节数低于 bytes (仅生产者线程), 关闭时返回 false
+    bool WaitUntilBelow(std::size_t bytes);
+
+    // 读取最多 size 字节 (非阻塞, 仅消费者线程), 返回实际读取的字节数
+    std::size_t Read(uint8_t* data, std::size_t size);
+
+    // 阻塞直到有数据可读 (仅消费者线程), 关闭且已读完时返回 false
+    // NOTE: 关闭后剩余的数据仍可读出
+    bool WaitForData();
+
+public:
+    // 清空缓冲 (任意线程)
+    // NOTE: 只记录清空位置, 消费者在下一次 Read 时跳过作废的数据
+    void Clear();
+
+    // 关闭缓冲
+    void Close();
+
+    bool IsClosed() const { return closed_.load(std::memory_order_acquire); }
+
+    // 获取当前缓冲的有效字节数
+    std::size_t GetSize() const;
+
+    std::size_t GetCapacity() const { return buffer_.size(); }
+
+    // 获取已写入的总字节数
+    uint64_t GetWritePosition() const { return write_pos_.load(std::memory_order_acquire); }
+
+    // 获取已读出 (含作废跳过) 的总字节数
+    uint64_t GetReadPosition() const;
+
+private:
+    std::vector<uint8_t> buffer_;
+    uint64_t mask_{0};
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> read_pos_{0};   // 读位置 (消费者独占写)
+    alignas(kCacheLineSize) std::atomic<uint64_t> write_pos_{0};  // 写位置 (生产者独占写)
+    alignas(kCacheLineSize) std::atomic<uint64_t> clear_pos_{0};  // 该位置之前的数据均已作废
+    std::atomic_bool closed_{false};
+    AtomicSignal can_write_;
+    AtomicSignal can_read_;
+};
+
+// ================== FrameBufferPool Class ==================
+// 解码器帧缓冲池, 通过 AVCodecContext::get_buffer2 安装, 让解码器跨帧复用图像/采样缓冲
+// - 视频: 按 (宽, 高, 像素格式) 计算对齐后的各平面大小, 每个平面一个 AVBufferPool,
+//         分辨率或像素格式变化时重建 (旧池在其缓冲全部归还后自动释放)
+// - 音频: 按 (样本数, 声道数, 采样格式) 计算平面大小, 需要更大缓冲时重建
+// 统计池分配的驻留/峰值内存; 驻留内存达到 max_bytes_ 后池子不再扩容 (仍复用已有空闲缓冲),
+// 取不到缓冲时退化为默认分配器 (用完即释放), 以此限制每路流的内存占用
+// NOTE: 池内缓冲释放时会回调本对象做统计, 因此本对象必须比所有使用它的解码器和帧活得更久
+class FrameBufferPool {
+public:
+    struct Stats {
+        std::size_t resident_bytes_{0};  // 当前驻留字节数 (使用中 + 池中空闲)
+        std::size_t peak_bytes_{0};      // 峰值驻留字节数
+        uint64_t allocs_{0};             // 池新分配缓冲次数
+        uint64_t fallbacks_{0};          // 退化为默认分配器的次数
+        uint64_t rebuilds_{0};           // 因尺寸/格式变化重建池的次数
+    };
+
+public:
+    // max_bytes: 驻留内存上限 (0 表示不限制)
+    explicit FrameBufferPool(std::size_t max_bytes = 0) : max_bytes_(max_bytes) {}
+    ~FrameBufferPool();
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool(FrameBufferPool&&) = delete;
+
+public:
+    // 安装到解码器上下文 (需在 avcodec_open2 之前调用), 解码器不支持 DR1 时不安装
+    bool Install(AVCodecContext* codec_ctx);
+
+    // 为视频帧分配缓冲 (frame->width/height/format 已设置), codec_ctx 可为空
+    int GetVideoBuffer(AVFrame* frame, AVCodecContext* codec_ctx, int flags);
+
+    // 为音频帧分配缓冲 (frame->nb_samples/format/ch_layout 已设置), codec_ctx 可为空
+    int GetAudioBuffer(AVFrame* frame, AVCodecContext* codec_ctx, int flags);
+
+    Stats GetStats() const;
+
 private:
-    std::queue<UniqueAVPacket> queue_;  // 队列
-    std::size_t curr_data_bytes_{0};    // 当前总字节大小
-    std::size_t max_data_bytes_{0};     // 最大总字节大小
-    int64_t duration_{0};               // 总时长
-    mutable std::mutex mtx_;
-    std::condition_variable cv_can_pop_;   // 能 pop 的条件变量
-    std::condition_variable cv_can_push_;  // 能 push 的条件变量
-    bool closed_{false};                   // 队列是否已关闭
+    static int GetBuffer2Wrapper(AVCodecContext* codec_ctx, AVFrame* frame, int flags);
+    static AVBufferRef* AllocWrapper(void* opaque, std::size_t size);
+    static void FreeWrapper(void* opaque, uint8_t* data);
+
+    // 退化为默认分配器
+    int FallbackGetBuffer(AVFrame* frame, AVCodecContext* codec_ctx, int flags);
+    // 从 plane 号平面池为 frame 取 count 个缓冲, 失败时释放已取到的缓冲 (调用方持有 mtx_)
+    bool TakeBuffers(AVFrame* frame, int plane, int count);
+    // 释放当前所有平面池 (调用方持有 mtx_)
+    void ResetPools();
+
+private:
+    std::mutex mtx_;
+    std::array<AVBufferPool*, 4> pools_{};      // 各平面缓冲池
+    std::array<std::size_t, 4> pool_sizes_{};  // 各平面缓冲大小
+    std::array<int, 4> linesizes_{};           // 视频各平面行宽
+    int width_{0};                             // 视频: 帧宽
+    int height_{0};                            // 视频: 帧高
+    int format_{-1};                           // 像素/采样格式
+
+    std::size_t max_bytes_{0};
+    std::atomic<std::size_t> resident_bytes_{0};
+    std::atomic<std::size_t> peak_bytes_{0};
+    std::atomic<uint64_t> allocs_{0};
+    std::atomic<uint64_t> fallbacks_{0};
+    std::atomic<uint64_t> rebuilds_{0};
 };
 
 // ================== Decoded Frame Wrapper ==================
 struct DecodedFrame {
-    UniqueAVFrame frame_;  // 解码后的 AVFrame 指针 (unique_ptr)
-    double pts_{};         // 帧的显示时间戳
-    double duration_{};    // 帧的估计持续时间
-    int64_t pos_{};        // 帧在输入文件或流中的字节位置 (NOTE: 精确跳转 (Seek) 快进快退)
-    int width_{};          // 帧的宽度
-    int height_{};         // 帧的高度
-    int format_{};         // 帧的像素格式
-    AVRational sar_{};     // 帧的宽高比
+    UniqueAVFrame frame_;        // 解码后的 AVFrame 指针 (unique_ptr)
+    double pts_{};               // 帧的显示时间戳
+    double duration_{};          // 帧的估计持续时间
+    int64_t pos_{};              // 帧对应的包在输入文件中的字节位置 (-1 表示未知)
+    int serial_{};               // 帧所属的播放序号 (与 Player::serial_ 不同即为 seek 前的过期帧)
+    std::size_t item_{};         // 帧所属的播放列表项
+    int width_{};                // 帧的宽度
+    int height_{};               // 帧的高度
+    int format_{};               // 帧的像素格式
+    uint32_t texture_format_{};  // 上传用的 SDL 纹理格式 (见 VideoConverter)
+    AVRational sar_{};           // 帧的宽高比
 };
 
 // ================== FrameQueue Class ==================
+// 单生产者/单消费者无锁帧环形队列
+// - 生产者: 视频解码线程 (PeekWritable/MoveWriteIndex)
+// - 消费者: 渲染线程 (PeekReadable/MoveReadIndex/Clear)
+// 读写索引为单调递增的原子变量并按缓存行隔离, 只有在队列满/空时才会阻塞 (futex)
 class FrameQueue {
 public:
+    // max_size: 队列深度, 限制在 [1, kMaxFrameQueueCapacity]
     explicit FrameQueue(int max_size);
 
     ~FrameQueue() = default;
@@ -177,37 +465,38 @@ public:
     FrameQueue(FrameQueue&&) = delete;  // 禁止移动
 
 public:
-    // 获取当前可写 Frame 指针 (阻塞)
+    // 获取当前可写 Frame 指针 (阻塞, 仅生产者线程)
     DecodedFrame* PeekWritable();
 
-    // 移动写入索引
+    // 移动写入索引 (仅生产者线程)
     void MoveWriteIndex();
 
-    // 获取当前可读 Frame 指针 (阻塞)
+    // 获取当前可读 Frame 指针 (阻塞, 仅消费者线程)
     DecodedFrame* PeekReadable();
 
-    // 移动读取索引
+    // 移动读取索引 (仅消费者线程)
     void MoveReadIndex();
 
     std::size_t GetSize() const;
 
-    // 清空队列
+    std::size_t GetMaxSize() const { return max_size_; }
+
+    // 清空队列 (仅消费者线程)
     void Clear();
 
     // 关闭队列
     void Close();
 
 private:
-    size_t rindex_{0};    // 读取索引
-    size_t windex_{0};    // 写入索引
-    size_t size_{0};      // 当前帧数
-    size_t max_size_{0};  // 最大帧数
+    std::size_t max_size_{0};  // 最大帧数
 
     std::vector<DecodedFrame> decoded_frames_;  // 解码帧环形队列
-    std::condition_variable cv_can_write_;
-    std::condition_variable cv_can_read_;
-    mutable std::mutex mtx_;
-    bool closed_{false};  // 队列是否已关闭
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> rindex_{0};  // 读取索引 (消费者独占写)
+    alignas(kCacheLineSize) std::atomic<uint64_t> windex_{0};  // 写入索引 (生产者独占写)
+    std::atomic_bool closed_{false};                           // 队列是否已关闭
+    AtomicSignal can_write_;
+    AtomicSignal can_read_;
 };
 
 }  // namespace avplayer
\ No newline at end of file
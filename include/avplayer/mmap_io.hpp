@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <avplayer/core.hpp>
+#include <cstdint>
+#include <string>
+
+namespace avplayer {
+
+// ================== MmapInput Class ==================
+// 本地文件的 mmap 输入: 把整个文件映射到内存, 通过自定义 AVIOContext 交给 libavformat,
+// 读取不再经过 file 协议每次几十 KB 的 read() 系统调用
+// - 读取: 从映射区直接拷贝到 AVIOContext 的大缓冲 (kMmapIoBufferSize), 缺页由内核预读填充
+// - 预读提示: 打开时对整个映射 MADV_SEQUENTIAL (加大预读窗口, 尽快回收已读过的页);
+//             读取位置进入预读窗口的后半段时, 对之后 kMmapReadAheadBytes 字节 MADV_WILLNEED
+// - seek: 对目标位置起的一个窗口 MADV_WILLNEED, 内核在后台读入, demuxer 不必逐页等待缺页
+// 回调只在打开文件的线程和读取线程中被调用 (与 AVFormatContext 相同)
+// NOTE: AVIOContext 由本类释放, 必须比使用它的 AVFormatContext 活得更久
+class MmapInput {
+public:
+    struct Stats {
+        uint64_t reads_{0};          // 读回调次数 (每次填满一个 AVIOContext 缓冲, 不是系统调用)
+        uint64_t read_bytes_{0};     // 读回调拷贝的字节数
+        uint64_t seeks_{0};          // seek 回调次数
+        uint64_t madvise_calls_{0};  // madvise 系统调用次数 (mmap 输入唯一的 IO 相关系统调用)
+    };
+
+public:
+    MmapInput() = default;
+    ~MmapInput();
+    MmapInput(const MmapInput&) = delete;
+    MmapInput(MmapInput&&) = delete;
+
+public:
+    // 映射 path 并创建 AVIOContext; 不是普通文件、映射失败或平台不支持时返回 false
+    bool Open(const std::string& path);
+
+    // 解除映射并释放 AVIOContext (可重复调用)
+    void Close();
+
+    // 设置给 AVFormatContext::pb, 未打开时为空
+    AVIOContext* GetContext() const { return io_ctx_.get(); }
+
+    // 文件大小 (字节)
+    int64_t GetSize() const { return size_; }
+
+    Stats GetStats() const;
+
+private:
+    // AVIOContext 回调
+    static int ReadPacket(void* opaque, uint8_t* buf, int buf_size);
+    static int64_t Seek(void* opaque, int64_t offset, int whence);
+
+    // 对 [offset, offset + kMmapReadAheadBytes) 发出 MADV_WILLNEED, 更新 advised_end_
+    void Prefetch(int64_t offset);
+
+private:
+    uint8_t* data_{nullptr};  // 映射区起始地址
+    int64_t size_{0};         // 文件大小
+    int64_t pos_{0};          // 当前读取位置
+    int64_t advised_end_{0};  // 已发出 MADV_WILLNEED 的范围终点
+    UniqueAVIOContext io_ctx_;
+
+    std::atomic<uint64_t> reads_{0};
+    std::atomic<uint64_t> read_bytes_{0};
+    std::atomic<uint64_t> seeks_{0};
+    std::atomic<uint64_t> madvise_calls_{0};
+};
+
+}  // namespace avplayer
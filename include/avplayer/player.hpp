@@ -1,21 +1,235 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <avplayer/audio_convert.hpp>
+#include <avplayer/clock.hpp>
 #include <avplayer/core.hpp>
 #include <avplayer/logger.hpp>
+#include <avplayer/playlist.hpp>
+#include <avplayer/read_ahead.hpp>
+#include <avplayer/seek_index.hpp>
+#include <avplayer/video_convert.hpp>
+#include <avplayer/vsync.hpp>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 // NOTE: 选择音频时钟作为主时钟:
 
 namespace avplayer {
 
+// ================== Player Options ==================
+// 视频解码多线程方式
+enum class VideoThreadType {
+    kAuto,   // 帧级 + 片级, 由解码器选择支持的方式
+    kFrame,  // 帧级多线程 (吞吐高, 输出延迟多若干帧)
+    kSlice,  // 片级多线程 (延迟低, 加速比取决于码流切片数)
+};
+
+// 视频帧上传到纹理的方式 (用于对比测量, 默认 kUpdate)
+// NOTE: SDL_LockTexture 返回的内存由渲染器决定: OpenGL / OpenGLES2 渲染器返回 SDL 的暂存缓冲,
+//       解锁时再从暂存缓冲上传, 比 kUpdate (直接从帧上传) 多一次 CPU 拷贝; 只有锁定时映射
+//       纹理内存的渲染器 (例如 direct3d11 的动态纹理) kLock 才不会多拷贝
+enum class UploadMode {
+    kUpdate,  // SDL_Update*Texture (渲染器直接从帧的内存上传)
+    kLock,    // 拷贝到 SDL_LockTexture 返回的内存, 行宽恰好一致的平面整块拷贝, 否则逐行拷贝
+    kRing,    // 同 kLock, 但轮流写入多个流式纹理, 避免覆盖 GPU 可能仍在读取的纹理
+};
+
+struct PlayerOptions {
+    // 视频帧环形队列深度 (高帧率内容可适当加大)
+    int frame_queue_size{kMaxFrameQueueSize};
+    // 每路流解码帧缓冲池内存上限 (0 表示不限制)
+    std::size_t max_frame_pool_bytes{0};
+    // 包队列低水位 (秒): 任一路低于它时必须继续读取
+    double buffer_low_sec{kMinBufferDuration};
+    // 包队列高水位 (秒): 所有路都达到后暂停读取
+    double buffer_high_sec{kMaxBufferDuration};
+    // 两路包队列共享的全局字节预算
+    std::size_t max_buffer_bytes{kMaxBufferDataBytes};
+    // 视频解码线程数 (0: 按核数和分辨率自动)
+    int video_decode_threads{0};
+    // 视频解码多线程方式
+    VideoThreadType video_thread_type{VideoThreadType::kAuto};
+    // PCM 环形缓冲填充目标 (毫秒)
+    int audio_buffer_ms{kAudioBufferMs};
+    // 后台建立视频关键帧索引, seek 时直接定位关键帧
+    bool seek_index{true};
+    // 关键帧索引保存到媒体文件旁的 sidecar 文件 (<文件名>.avpidx), 下次打开时复用
+    bool seek_index_sidecar{false};
+    // 精确 seek: 从关键帧追赶到目标时刻 (跳过非参考帧, 丢弃目标之前的帧)
+    bool exact_seek{false};
+    // 视频持续落后于音频时钟时, 让解码器逐级跳过帧和环路滤波 (解码是瓶颈时降低 CPU 负载)
+    bool frame_skip{true};
+    // 视频帧上传到纹理的方式
+    UploadMode upload_mode{UploadMode::kUpdate};
+    // 10 位 PQ / HLG (HDR) 内容降到 8 位时做简单的色调映射
+    bool tonemap{true};
+    // 窗口远小于视频时在解码端降低分辨率 (解码器 lowres 或解码线程预缩放)
+    bool downscale{true};
+    // 按显示器垂直同步槽位安排视频帧 (需要渲染器开启垂直同步)
+    bool vsync_pacing{true};
+    // 音频时钟扣除音频设备延迟 (关闭时时钟超前一个设备延迟, 用于对比音画偏差)
+    bool audio_latency_comp{true};
+    // 音频后端在 SDL 设备缓冲之外的输出延迟 (毫秒, 例如 PulseAudio/PipeWire 服务端的队列),
+    // 计入设备延迟; SDL2 无法查询, 可取 pactl list sinks 的 Latency 或 pw-top 的 QUANT/RATE
+    double audio_output_latency_ms{0};
+    // 无界面: 不创建窗口和音频设备, 视频帧和 PCM 由空设备消费 (CI / 无显示器的机器上测吞吐)
+    bool headless{false};
+    // 不按时钟播放: 帧和 PCM 产出即消费, 测量流水线最大吞吐 (隐含 headless)
+    bool no_clock{false};
+    // 本地文件用 mmap + 自定义 AVIOContext 读取 (不经过 file 协议的 read() 调用), 失败时退回
+    bool mmap_io{false};
+    // 异步预读窗口 (MB): -1 表示不使用预读输入, 0 表示经过预读输入但不预读 (对比的基线)
+    int read_ahead_mb{-1};
+    // 预读输入在可用时使用 io_uring, 否则线程池 pread
+    bool io_uring{true};
+    // 模拟慢速存储 (测试预读): 带宽 (MB/s) 和每个请求的延迟 (毫秒), 非零时隐含使用预读输入
+    double io_throttle_mbps{0};
+    double io_latency_ms{0};
+    // 选择视频/音频流: 全数字为流索引, 否则为语言标签 (例如 jpn, 不区分大小写); 空表示第一路
+    std::string video_stream;
+    std::string audio_stream;
+    // 流探测上限: 读取的字节数和分析的时长 (秒), 0 表示 FFmpeg 默认 (5 MB / 5 秒);
+    // 调小可以缩短打开时间, 但过小时可能得不到完整的流参数
+    int64_t probesize{0};
+    double analyze_duration{0};
+    // 缓存流探测结果 (按文件大小、修改时间和文件头哈希校验), 再次打开同一文件时跳过探测
+    bool probe_cache{true};
+    // 探测缓存目录, 空表示 $XDG_CACHE_HOME/avplayer/probe 或 ~/.cache/avplayer/probe
+    std::string probe_cache_dir;
+    // 播放列表: 读到当前项最后几秒时在后台打开下一项 (输入, 探测, 解码器)
+    double preopen_sec{kPlaylistPreopenSec};
+};
+
 // ================== Player Class ==================
 class Player {
 public:
-    explicit Player(std::string file_path);
+    // 流水线各阶段 (每个阶段一个线程), 用于统计 CPU 时间
+    enum class Stage {
+        kRead,         // 读取线程
+        kVideoDecode,  // 视频解码线程 (含 FFmpeg 解码工作线程)
+        kAudioDecode,  // 音频解码线程
+        kRender,       // 渲染线程
+        kAudioOutput,  // 空音频设备线程 (仅无界面模式, SDL 音频回调线程不统计)
+    };
+    static constexpr std::size_t kStageCount = 5;
+
+    struct ThroughputStats {
+        double wall_sec_{0};          // 起播到播放结束 (或当前) 的墙钟时间
+        uint64_t video_frames_{0};    // 呈现 (无界面模式下由空设备消费) 的视频帧数
+        double fps_{0};               // 视频帧吞吐
+        double input_mb_per_sec_{0};  // 读取的压缩数据吞吐
+        double video_mb_per_sec_{0};  // 呈现的图像数据吞吐 (按帧的图像大小计算)
+        double audio_speed_{0};       // 音频输出速度 (相对实时的倍数)
+        std::array<double, kStageCount> stage_cpu_sec_{};  // 各阶段线程退出时的 CPU 时间
+    };
+
+    struct AudioStats {
+        uint64_t underruns_{0};          // 回调取不到足够数据的次数
+        uint64_t underrun_bytes_{0};     // 欠载时静音填充的总字节数
+        std::size_t buffered_bytes_{0};  // PCM 环形缓冲当前字节数
+    };
+
+    struct VideoSkipStats {
+        int level_{0};                // 当前跳帧级别 (0: 不跳, 1: 非参考帧, 2: 双向帧, 3: 非关键帧)
+        int max_level_{0};            // 达到过的最高级别
+        uint64_t escalations_{0};     // 升级次数
+        uint64_t recoveries_{0};      // 解码追上后降级的次数
+        uint64_t skipped_frames_{0};  // 解码器跳过的帧数 (按跳帧期间送入的包数与输出帧数之差估算)
+        uint64_t late_dropped_{0};    // 已解码但显示时落后而被丢弃的帧数
+    };
+
+    struct UploadStats {
+        uint64_t frames_{0};                    // 上传帧数
+        uint64_t strided_frames_{0};            // 行宽与纹理不一致、逐行拷贝的帧数 (仅 kLock/kRing)
+        double avg_ms_{0};                      // 每帧平均上传耗时
+        double max_ms_{0};                      // 每帧最大上传耗时
+        UploadMode mode_{UploadMode::kUpdate};  // 实际使用的方式 (锁定失败时退回 kUpdate)
+    };
+
+    struct PresentStats {
+        // 抖动直方图各桶的上界 (微秒): 桶 i 统计 [上界 i-1, 上界 i) 的帧, 最后一个桶不设上界
+        static constexpr std::array<int64_t, 8> kBucketUpperUs{0,    500,  1000,  2000,
+                                                               4000, 8000, 16000, 33000};
+        uint64_t frames_{0};             // 呈现帧数
+        double avg_jitter_ms_{0};        // 平均抖动 (实际呈现时刻 - 目标时刻)
+        double max_jitter_ms_{0};        // 最大抖动
+        std::array<uint64_t, kBucketUpperUs.size() + 1> histogram_{};  // 抖动直方图
+    };
+
+    // 音画偏差: 声音起点 (静音之后的第一个非静音采样) 实际输出的时刻 - 画面显示同一时间戳的时刻
+    // (>0: 画面超前); 输出时刻 = 音频回调交出该采样的时刻 + 设备延迟, 不经过音频时钟,
+    // 但设备延迟之外的部分 (例如声卡硬件) 测不到
+    struct AvSyncStats {
+        uint64_t onsets_{0};               // 统计的声音起点数 (有视频且找到对应的帧时)
+        double avg_offset_ms_{0};          // 平均偏差
+        double avg_abs_offset_ms_{0};      // 偏差绝对值的平均
+        double max_abs_offset_ms_{0};      // 偏差绝对值的最大值
+        double device_latency_ms_{0};      // 音频设备延迟 (设备缓冲 + 后端输出延迟)
+        double output_latency_ms_{0};      // 其中后端输出延迟 (--audio-output-latency-ms)
+        bool latency_compensated_{false};  // 主时钟是否扣除了设备延迟
+    };
+
+    struct DemuxStats {
+        uint64_t io_bytes_{0};         // 从输入读取的字节数 (AVIOContext)
+        double read_frame_ms_{0};      // 读取线程阻塞在 av_read_frame 中的总时长
+        double max_read_frame_ms_{0};  // 单次 av_read_frame 的最长时长
+        uint64_t demuxed_bytes_{0};    // demuxer 输出的包字节数
+        uint64_t demuxed_packets_{0};  // demuxer 输出的包数
+        uint64_t dropped_bytes_{0};    // 其中不属于所选流、读取后丢弃的字节数
+        uint64_t dropped_packets_{0};  // 其中丢弃的包数
+        int discarded_streams_{0};     // 在 demuxer 处丢弃 (AVDISCARD_ALL) 的流数
+        uint64_t audio_switches_{0};   // 运行时切换音频流的次数
+    };
+
+    // 启动各阶段耗时 (毫秒): SDL 初始化与打开输入 + 探测并行, 之后依次打开解码器、启动线程
+    struct StartupStats {
+        double sdl_ms_{0};             // SDL 初始化和创建窗口
+        double open_input_ms_{0};      // avformat_open_input (读取容器头部)
+        double probe_ms_{0};           // 流探测 (命中缓存时为读取缓存)
+        bool probe_cache_hit_{false};  // 是否命中探测缓存
+        double open_codecs_ms_{0};     // 打开解码器和音频设备
+        double start_threads_ms_{0};   // 创建渲染器 (到起播时刻)
+        double first_audio_ms_{-1};    // 构造开始到首个音频采样交给设备 (-1 表示尚未发生)
+        double first_video_ms_{-1};    // 构造开始到首帧呈现 (-1 表示尚未发生)
+    };
+
+    // 播放列表项之间的切换: 间隙为前一项最后一个采样 (帧) 与下一项第一个之间多出的时长,
+    // 有音频时按音频设备输出的静音计算, 否则按视频帧的呈现间隔计算
+    struct PlaylistStats {
+        std::size_t items_{0};       // 播放列表项数
+        uint64_t transitions_{0};    // 已完成的切换次数
+        uint64_t skipped_items_{0};  // 打开失败或流布局与第一项不同而跳过的项数
+        double last_gap_ms_{0};      // 最近一次切换的间隙
+        double max_gap_ms_{0};       // 最大间隙
+    };
+
+    struct SeekStats {
+        uint64_t requests_{0};      // SeekTo 调用次数
+        uint64_t executed_{0};      // 读取线程实际执行的次数 (其余请求被合并)
+        uint64_t failures_{0};      // 执行失败次数
+        uint64_t shown_{0};         // 显示出首帧的次数
+        double avg_exec_ms_{0};     // demuxer 定位平均耗时
+        double max_exec_ms_{0};     // demuxer 定位最大耗时
+        double avg_latency_ms_{0};  // 请求到首帧显示平均耗时
+        double max_latency_ms_{0};  // 请求到首帧显示最大耗时
+        double shown_per_sec_{0};   // 首帧显示吞吐: 第一次请求到最近一次首帧显示期间每秒次数
+    };
+
+public:
+    explicit Player(std::string file_path, PlayerOptions options = {});
+
+    // 依次无缝播放 playlist 中的各项 (流布局与第一项不同或打开失败的项被跳过)
+    explicit Player(std::vector<std::string> playlist, PlayerOptions options = {});
 
     ~Player();
 
@@ -29,109 +243,382 @@ public:
 public:
     // =============== 初始化 ===============
     void InitSDL();
-    void OpenInputFile();
-    void FindStreams();
+    // 打开 item->path_ 并探测流信息 (预打开线程也调用, 不修改 Player 状态)
+    void OpenInputFile(MediaItem* item) const;
+    // 选择视频/音频流, 其余的流在 demuxer 处丢弃
+    void FindStreams(MediaItem* item) const;
+    // 当前的音频流选择条件 (--astream, 运行时切换后为新流的语言或索引; 预打开线程也调用)
+    std::string GetAudioStreamSpec() const;
+    // 按流参数创建并打开解码器 (只安装共用的帧缓冲池), 失败时抛出 std::runtime_error
+    UniqueAVCodecContext OpenDecoder(const AVStream* stream);
+    // 打开第一项的解码器, 音频还要打开音频设备并确定输出格式
     void OpenStreamComponent(int stream_index);
     void StartThreads();
 
+    // =============== 播放列表 ===============
+    // 打开播放列表中从 index 开始第一个可以播放的项 (输入, 探测, 解码器), 都失败时返回空;
+    // 不是第一项 (first 为 false) 时视频/音频组合必须与第一项相同 (预打开线程调用)
+    std::shared_ptr<MediaItem> OpenItem(std::size_t index, bool first);
+    // 在后台开始打开下一项 (仅读取线程)
+    void StartPreopen();
+    // 当前项已读完: 切换到预打开的下一项继续读取, 没有下一项时返回 false (仅读取线程)
+    bool AdvancePlaylist();
+    // 向包队列写入项边界标记 (带当前读取的项), 解码线程收到后排空解码器并切换到该项
+    void PushItemMarkers();
+    // 按当前的音频流选择条件重新选择正在读取的项的音频流 (仅读取线程, 切换到下一项时调用)
+    void ReselectAudioStream();
+    // 切换到 item: 接管它预先打开的解码器 (仅对应的解码线程, 旧解码器已排空)
+    void SwitchVideoItem(std::shared_ptr<MediaItem> item);
+    // record_gap: 是否统计切换间隙 (seek 引起的切换不是连续播放, 不统计)
+    void SwitchAudioItem(std::shared_ptr<MediaItem> item, bool record_gap);
+    // 记录一次切换的间隙 (毫秒)
+    void RecordItemGap(double gap_ms);
+    // 输出 item 的输入层统计 (预读输入, mmap 输入)
+    void LogInputStats(const MediaItem& item) const;
+
     // =============== 线程循环 ===============
     // 读取线程
     void ReadLoop();
+    // 读取线程是否需要继续读取 (按时长水位和全局字节预算判断)
+    bool NeedMorePackets();
+    // 设置请求标志 (stop_ / seek_pending_ / audio_switch_pending_) 之后调用, 唤醒等待缓冲的读取线程
+    void WakeReadLoop();
+    // 切换音频流后重新读取时是否丢弃 packet: 已入队的视频包, 早于播放位置的新流音频包;
+    // 同时记录已入队视频包的最大时间戳 (仅读取线程)
+    bool SkipReadPacket(const AVPacket* packet, bool is_video, AVRational time_base);
+    // 在读取线程中执行 seek, 成功后递增播放序号 (exact 为 true 时解码线程追赶到目标时刻)
+    bool ExecuteSeek(double time_sec, bool exact);
+    // 在读取线程中切换音频流: 重新启用新流并丢弃旧流, 只对音频从播放位置重新同步
+    void ExecuteAudioSwitch();
     // 视频解码线程
     void VideoDecodeLoop();
+    // 按 CPU 核数和分辨率估算视频解码线程数
+    static int AutoVideoDecodeThreads(int width, int height);
+    // 输出视频解码吞吐和各解码线程 CPU 时间 (观察多线程扩展性)
+    void LogVideoDecodeStats() const;
+    // 按显示端反馈的落后情况调整解码器跳帧级别 (仅视频解码线程, 每个包调用一次)
+    void UpdateVideoSkipLevel();
+    // 按当前窗口尺寸计算 width x height 的画面可以降低的分辨率级别 (1 / 2^level)
+    int GetDownscaleLevel(int width, int height, AVRational sar) const;
+    // 以新的 lowres 重新打开视频解码器 (仅视频解码线程, 在关键帧处调用)
+    bool ReopenVideoDecoder(int lowres);
 
     // =============== 音频处理 ===============
-    // 解码音频帧 (包含更新音频时钟)
+    // 音频解码线程
+    void AudioDecodeLoop();
+    // 解码音频帧并写入 PCM 环形缓冲 (包含更新音频时钟)
     int DecodeAudioFrame();
+    // 以 stream_index 流的参数重新打开音频解码器 (仅音频解码线程, 切换音频流后调用)
+    bool ReopenAudioDecoder(int stream_index);
+    // 收到音频重新同步标记: 丢弃旧流的解码器状态和 PCM 缓冲, 从当前播放位置接上新流
+    void ResyncAudio();
     // SDL 音频回调
     static void AudioCallbackWrapper(void* userdata, uint8_t* stream, int len);
     // 音频回调
     void AudioCallback(uint8_t* stream, int len);
+    // 空音频设备线程 (无界面模式): 按采样率 (不按时钟时尽快) 消费 PCM 环形缓冲
+    void NullAudioLoop();
 
     // =============== 视频处理 ===============
     // 解码视频帧 (包含更新视频时钟)
     int DecodeVideoFrame();
-    // 视频刷新定时器回调
-    static uint32_t VideoRefreshTimerWrapper(uint32_t interval, void* opaque);
-    // 调度下一帧视频刷新
-    void ScheduleNextVideoRefresh(int delay_ms);
-    // 视频刷新处理 (包含音视频同步)
-    void VideoRefreshHandler();
-    // 渲染视频帧
-    void RenderVideoFrame();
+    // 渲染线程: 创建并独占渲染器, 按 frame_timer_ 推出的绝对时刻呈现视频帧
+    void RenderLoop(std::promise<void>* renderer_ready);
+    // 取一帧做音视频同步, 睡眠到它的目标时刻后呈现 (仅渲染线程)
+    void RefreshVideo();
+    // 分段睡眠到 target (秒, av_gettime_relative 时间轴), 被停止/暂停/seek 打断时返回 false
+    bool WaitForPresentTime(double target, int serial) const;
+    // 按渲染器输出尺寸更新显示区域, 按窗口所在显示器更新刷新率 (仅渲染线程)
+    void UpdateWindowSize();
+    // 渲染视频帧 (decoded_frame 为 RefreshVideo 已 peek 到的帧)
+    void RenderVideoFrame(DecodedFrame* decoded_frame);
+    // 记录刚呈现的帧, 与音频回调检测到的声音起点比较, 统计音画偏差 (仅渲染线程)
+    void MeasureAvOffset(double pts, double presented);
+    // 按帧尺寸和纹理格式 (重新) 创建纹理, 纹理环模式下创建 kTextureRingSize 个
+    bool CreateTextures(int width, int height, uint32_t format);
+    // 把帧上传到 format 格式的纹理 (按 upload_mode_ 选择方式)
+    bool UploadFrame(SDL_Texture* texture, const AVFrame* frame, uint32_t format);
     // 计算视频显示区域
     void CalculateDisplayRect(SDL_Rect* rect, int window_x, int window_y, int window_width,
                               int window_height, int picture_width, int picture_height,
-                              AVRational picture_sar);
+                              AVRational picture_sar) const;
 
     // =============== 时钟同步 ===============
-    // 获取主时钟
+    // 获取主时钟 (不加锁, 可在任意线程调用)
     double GetMasterClock() const;
     // 获取视频时钟
     double GetVideoClock() const;
+    // 获取此刻正在从音频设备输出的采样的时间戳 (扣除软件和设备缓冲的延迟)
+    double GetAudioClock() const;
     // 更新视频时钟
     double SynchronizeVideo(const AVFrame* frame, double pts);
 
+    // =============== 统计 ===============
+    // 获取 AVPacket 池命中/未命中统计
+    PacketPool::Stats GetPacketPoolStats() const;
+    // 获取视频/音频解码帧缓冲池内存统计
+    FrameBufferPool::Stats GetFrameBufferPoolStats(AVMediaType type) const;
+    // 获取音频欠载统计
+    AudioStats GetAudioStats() const;
+    // 获取 seek 吞吐和延迟统计
+    SeekStats GetSeekStats() const;
+    // 获取 demuxer 读取/丢弃字节统计
+    DemuxStats GetDemuxStats() const;
+    // 获取播放列表切换次数和间隙
+    PlaylistStats GetPlaylistStats() const;
+    // 获取启动各阶段耗时和首个音频采样/首帧显示时刻
+    StartupStats GetStartupStats() const;
+    // 首个音频采样和首帧都已输出时输出启动耗时 (只输出一次, 不能在音频回调中调用)
+    void LogStartupStats();
+    // 获取解码器跳帧统计
+    VideoSkipStats GetVideoSkipStats() const;
+    // 获取纹理上传耗时统计
+    UploadStats GetUploadStats() const;
+    // 获取视频帧呈现抖动统计
+    PresentStats GetPresentStats() const;
+    // 获取音画偏差统计
+    AvSyncStats GetAvSyncStats() const;
+    // 获取垂直同步槽位调度统计 (节奏误差, 错过的垂直同步)
+    VsyncScheduler::Stats GetVsyncStats() const { return vsync_scheduler_.GetStats(); }
+    // 获取流水线吞吐 (fps, MB/s) 和各阶段 CPU 时间
+    ThroughputStats GetThroughputStats() const;
+    // 记录当前线程 (stage 阶段) 已消耗的 CPU 时间, 在线程退出前调用
+    void RecordStageCpuTime(Stage stage, double cpu_seconds);
+    // 记录播放结束时刻 (只记录第一次)
+    void MarkPlaybackEnd();
+
     // =============== 控制 ===============
     // 切换暂停/播放状态
     void TogglePause();
+    // 窗口尺寸或所在显示器变化 (主线程事件循环调用)
+    void OnWindowResized();
     // 停止播放
     void Stop();
-    // Seek
+    // Seek: 只投递请求, 由读取线程执行 (不阻塞调用线程, 连续请求合并为最后一个目标)
     void SeekTo(double time_sec);
+    // 相对当前位置 seek (连续请求时以尚未显示的目标为基准累加)
+    void SeekBy(double offset_sec);
+    // 切换到下一路音频流 (只投递请求, 由读取线程执行, 不重新打开文件)
+    void CycleAudioStream();
 
 private:
-    std::string file_path_;
+    std::vector<std::string> playlist_;
+    PlayerOptions options_;
+
+    // AVPacket 池 (NOTE: 必须先于队列构造、后于队列析构, 队列中的包析构时会归还到池中)
+    PacketPool packet_pool_;
+    // 解码帧缓冲池 (NOTE: 必须比解码器上下文和所有 AVFrame 活得更久)
+    FrameBufferPool video_buffer_pool_;
+    FrameBufferPool audio_buffer_pool_;
+    // 像素格式转换 (仅视频解码线程), 转换后的帧的缓冲来自它内部的池
+    // NOTE: 必须先于帧队列构造、后于帧队列析构, 退出时仍在队列中的帧析构时会归还到池中
+    VideoConverter video_converter_;
 
     // Queues
     PacketQueue video_packet_queue_;
     PacketQueue audio_packet_queue_;
     FrameQueue video_frame_queue_;
+    PcmRingBuffer audio_ring_;  // 音频解码线程 -> SDL 音频回调
 
     // FFmpeg
-    UniqueAVFormatContext format_ctx_;
-    AVStream* video_stream_{nullptr};
-    AVStream* audio_stream_{nullptr};
+    std::shared_ptr<MediaItem> item_;                    // 正在读取的项 (仅读取线程)
+    std::future<std::shared_ptr<MediaItem>> next_item_;  // 后台打开的下一项 (仅读取线程)
+    bool has_video_{false};  // 是否有视频输出 (由第一项决定, 之后各项必须相同)
+    bool has_audio_{false};  // 是否有音频输出
     UniqueAVCodecContext video_codec_ctx_;
     UniqueAVCodecContext audio_codec_ctx_;
-    int video_stream_idx_{-1};
-    int audio_stream_idx_{-1};
 
-    // seek 过程保护
-    mutable std::mutex format_ctx_mtx_;
-    mutable std::mutex video_codec_mtx_;
-    mutable std::mutex audio_codec_mtx_;
-    mutable std::mutex clock_mtx_;
+    // 读取线程缓冲控制
+    std::mutex read_wait_mtx_;
+    std::condition_variable read_wait_cv_;  // 缓冲已满时读取线程在此限时等待
+    bool buffering_paused_{false};          // 是否因缓冲已满暂停读取 (仅读取线程访问)
+    // 切换音频流后的重新读取 (仅读取线程, 时间戳为正在读取的项的视频流时间基)
+    int64_t read_video_ts_{AV_NOPTS_VALUE};        // 已入队视频包的最大 dts (没有时为 pts)
+    int64_t skip_video_until_ts_{AV_NOPTS_VALUE};  // 不超过该时间戳的视频包已入队, 跳过
+    double audio_resync_from_{NAN};                // 新流音频包从该时刻 (秒) 开始入队
 
     // 线程
     std::jthread read_thread_;
     std::jthread video_decode_thread_;
+    std::jthread audio_decode_thread_;
+    std::jthread render_thread_;
+    std::jthread audio_sink_thread_;  // 空音频设备 (仅无界面模式)
+    SeekIndex seek_index_;            // 后台关键帧索引 (自带线程)
+    std::mutex seek_index_mtx_;       // Stop 与读取线程切换项时重新建立索引互斥
 
-    // SDL
+    // SDL (渲染器和纹理只在渲染线程中创建、使用和释放)
     UniqueSDLWindow window_;
     UniqueSDLRenderer renderer_;
-    UniqueSDLTexture texture_;
+    std::vector<uint32_t> renderer_formats_;  // 渲染器原生支持的纹理格式
+    bool renderer_vsync_{false};              // 渲染器是否开启了垂直同步
     int window_x_{0};
     int window_y_{0};
     int window_width_{kDefaultWidth};
     int window_height_{kDefaultHeight};
+    std::atomic_bool window_resized_{false};  // 事件线程通知渲染线程窗口尺寸变化
+    // 唤醒渲染线程和空音频设备 (暂停恢复, 窗口变化, 停止)
+    AtomicSignal render_signal_;
+    // 窗口输出尺寸 (像素), 供视频解码线程选择降分辨率级别
+    std::atomic<int> display_width_{kDefaultWidth};
+    std::atomic<int> display_height_{kDefaultHeight};
+
+    // 视频纹理上传
+    std::array<UniqueSDLTexture, kTextureRingSize> textures_;  // 视频纹理 (非纹理环模式只用第一个)
+    std::size_t texture_index_{0};                             // 下一帧写入的纹理
+    int texture_width_{0};                                     // 纹理宽度
+    int texture_height_{0};                                    // 纹理高度
+    uint32_t texture_format_{SDL_PIXELFORMAT_UNKNOWN};         // 纹理格式
+    UploadMode upload_mode_{UploadMode::kUpdate};              // 实际使用的上传方式 (仅渲染线程)
+    std::atomic<uint64_t> upload_frames_{0};                   // 统计: 上传帧数
+    std::atomic<uint64_t> upload_strided_frames_{0};           // 统计: 逐行拷贝的帧数
+    std::atomic<int64_t> upload_us_{0};                        // 统计: 上传总耗时
+    std::atomic<int64_t> upload_max_us_{0};                    // 统计: 单帧最大上传耗时
+
+    // 视频帧呈现调度 (仅渲染线程) 和抖动统计 (实际呈现时刻 - 目标时刻)
+    VsyncScheduler vsync_scheduler_;
+    std::atomic<uint64_t> present_frames_{0};
+    std::atomic<int64_t> present_jitter_us_{0};
+    std::atomic<int64_t> present_jitter_max_us_{0};
+    std::array<std::atomic<uint64_t>, PresentStats::kBucketUpperUs.size() + 1> present_histogram_{};
+
+    // 音画偏差统计 (仅渲染线程写入)
+    // 最近呈现的帧 (时间戳, 呈现时刻) 和已统计的声音起点的时间戳 (仅渲染线程)
+    std::array<std::pair<double, double>, 32> recent_frames_{};
+    std::size_t recent_frame_count_{0};
+    double matched_onset_pts_{NAN};
+    std::atomic<uint64_t> av_offset_onsets_{0};
+    std::atomic<int64_t> av_offset_us_{0};
+    std::atomic<int64_t> av_offset_abs_us_{0};
+    std::atomic<int64_t> av_offset_max_us_{0};
+
+    // 吞吐统计
+    std::atomic<int64_t> playback_start_us_{0};  // 起播时刻
+    std::atomic<int64_t> playback_end_us_{0};    // 播放结束时刻 (0 表示未结束)
+    std::atomic<uint64_t> read_bytes_{0};        // 读取的压缩数据字节数
+    std::atomic<uint64_t> read_packets_{0};      // 读取的包数
+    std::atomic<uint64_t> dropped_bytes_{0};     // 不属于所选流而丢弃的字节数
+    std::atomic<uint64_t> dropped_packets_{0};   // 不属于所选流而丢弃的包数
+    std::atomic<uint64_t> io_bytes_{0};          // AVIOContext 已读取的字节数 (读取线程更新)
+    uint64_t io_bytes_base_{0};                  // 之前各项已读取的字节数 (仅读取线程)
+    std::atomic<int64_t> read_frame_us_{0};      // av_read_frame 总耗时
+    std::atomic<int64_t> read_frame_max_us_{0};  // av_read_frame 最大耗时
+    int discarded_streams_{0};                   // 在 demuxer 处丢弃的流数 (当前读取的项)
+    std::atomic<uint64_t> shown_frames_{0};      // 呈现的视频帧数
+    std::atomic<uint64_t> shown_bytes_{0};       // 呈现的图像数据字节数
+    std::size_t audio_chunk_bytes_{0};           // 音频设备每次取走的字节数
+    // 各阶段线程退出时记录的 CPU 时间
+    std::array<std::atomic<int64_t>, kStageCount> stage_cpu_us_{};
+
+    // 播放列表切换统计
+    std::atomic<uint64_t> item_transitions_{0};  // 切换次数
+    std::atomic<uint64_t> skipped_items_{0};     // 跳过的项数
+    std::atomic<int64_t> item_gap_us_{0};        // 最近一次切换的间隙
+    std::atomic<int64_t> item_gap_max_us_{0};    // 最大间隙
+
+    // 启动耗时 (av_gettime_relative 时刻, 0 表示尚未发生)
+    int64_t startup_us_{0};                   // 构造开始
+    int64_t sdl_ready_us_{0};                 // SDL 初始化和窗口创建完成
+    int64_t input_opened_us_{0};              // avformat_open_input 完成
+    int64_t probed_us_{0};                    // 流探测完成 (或从缓存写回)
+    int64_t codecs_opened_us_{0};             // 解码器和音频设备打开完成
+    bool probe_cache_hit_{false};             // 是否命中探测缓存
+    std::atomic<int64_t> first_audio_us_{0};  // 首个音频采样交给音频设备
+    std::atomic<int64_t> first_video_us_{0};  // 首帧呈现
+    std::atomic_bool startup_logged_{false};  // 是否已输出启动耗时
+
+    // 视频状态
+    std::shared_ptr<MediaItem> video_item_;          // 解码器当前对应的项 (仅视频解码线程)
+    UniqueAVFrame video_frame_;                      // 视频解码时复用的 AVFrame
+    std::atomic<uint64_t> video_decoded_frames_{0};  // 已解码视频帧数
+    std::atomic<int64_t> video_decode_busy_us_{0};   // 解码线程在解码器调用中花费的墙钟时间
+    int64_t video_decode_start_us_{0};               // 解码线程启动时刻
+    int video_serial_{0};                            // 解码器当前的播放序号 (仅视频解码线程)
+    double video_seek_target_{NAN};                  // 精确 seek 追赶目标 (秒), NAN 表示无
+    uint64_t video_seek_dropped_{0};                 // 追赶时丢弃的帧数 (仅视频解码线程)
+    int video_max_lowres_{0};                        // 解码器支持的最高 lowres (0 表示不使用)
+
+    // 解码跳帧反馈 (显示端统计落后帧数, 视频解码线程按窗口调整级别)
+    std::atomic<uint64_t> video_late_frames_{0};       // 窗口内显示时落后的帧数 (渲染线程累加)
+    std::atomic<uint64_t> video_ontime_frames_{0};     // 窗口内按时显示的帧数 (渲染线程累加)
+    std::atomic<int> video_skip_level_{0};             // 当前跳帧级别
+    int64_t video_skip_window_start_us_{0};            // 当前评估窗口起点
+    uint64_t video_skip_window_packets_{0};            // 当前窗口送入解码器的包数
+    uint64_t video_skip_window_frames_{0};             // 窗口起点时的已解码帧数
+    int video_skip_clean_windows_{0};                  // 连续不落后的窗口数
+    std::atomic<int> video_skip_max_level_{0};         // 统计: 最高级别
+    std::atomic<uint64_t> video_skip_escalations_{0};  // 统计: 升级次数
+    std::atomic<uint64_t> video_skip_recoveries_{0};   // 统计: 降级次数
+    std::atomic<uint64_t> video_skipped_frames_{0};    // 统计: 解码器跳过的帧数
+    std::atomic<uint64_t> video_late_dropped_{0};      // 统计: 显示端丢弃的落后帧数
 
     // 音频状态
-    UniqueSwrContext audio_swr_ctx_;     // 音频重采样上下文
-    UniqueAVFrame audio_frame_;          // 音频重采样时使用的 AVFrame
-    std::vector<uint8_t> audio_buffer_;  // 音频缓冲区
-    uint32_t audio_buffer_size_{0};      // 音频缓冲区大小
-    uint32_t audio_buffer_index_{0};     // 音频缓冲区索引
-
-    // 音视频同步
-    double audio_clock_{0.0};       // 音频时钟 (主时钟)
-    double video_clock_{0.0};       // 视频时钟
-    double frame_timer_{0.0};       // 用于消除累计误差的高精度视频同步校正时钟
-    double last_frame_pts_{0.0};    // 上一帧显示时间戳
-    double last_frame_delay_{0.0};  // 上一帧显示延迟
+    std::shared_ptr<MediaItem> audio_item_;          // 解码器当前对应的项 (仅音频解码线程)
+    UniqueAVFrame audio_frame_;                      // 音频解码时复用的 AVFrame
+    AudioConverter audio_converter_;                 // 输出格式转换 (仅音频解码线程)
+    int audio_bytes_per_sec_{0};                     // 输出 PCM 每秒字节数
+    std::size_t audio_fill_target_bytes_{0};         // PCM 环形缓冲填充目标
+    std::atomic<uint64_t> audio_underruns_{0};       // 欠载次数
+    std::atomic<uint64_t> audio_underrun_bytes_{0};  // 欠载静音填充字节数
+    std::atomic_bool audio_decode_finished_{false};  // 音频解码线程是否已结束
+    int audio_serial_{0};                            // 解码器当前的播放序号 (仅音频解码线程)
+    double audio_seek_target_{NAN};                  // 精确 seek 追赶目标 (秒), NAN 表示无
+    int audio_decoder_stream_idx_{-1};               // 解码器当前对应的流 (仅音频解码线程)
+    AVRational audio_time_base_{0, 1};               // 该流的时间基 (仅音频解码线程)
+    SDL_AudioSpec audio_spec_{};                     // 协商得到的输出格式 (切换流时复用)
+    std::atomic_bool audio_switch_pending_{false};   // 是否有待执行的音频流切换请求
+    std::atomic<uint64_t> audio_switches_{0};        // 统计: 音频流切换次数
+    mutable std::mutex audio_stream_mtx_;            // 保护 audio_stream_spec_ (预打开线程读取)
+    std::string audio_stream_spec_;                  // 当前的音频流选择条件, 见 GetAudioStreamSpec
+    int64_t audio_gap_underrun_bytes_{-1};           // 切换项时的欠载字节数 (-1 表示不在切换中)
+
+    // 音视频同步 (时钟都不加锁, 见 SeqLock)
+    // 音频解码线程写入 PCM 缓冲的进度: 写位置 pos_ 之前的最后一个采样结束于 pts_
+    struct AudioWritten {
+        double pts_{NAN};
+        uint64_t pos_{0};
+        int serial_{-1};
+    };
+    SeqLock<AudioWritten> audio_written_;  // 音频解码线程写入, 音频回调读取
+    SyncClock audio_clock_;                // 音频时钟 (主时钟), 音频回调交出采样时更新
+    double audio_device_latency_{0};       // 音频设备延迟 (秒, 空音频设备为 0)
+    // 音频回调检测到的最近一个声音起点: 时间戳和实际输出的时刻 (见 MeasureAvOffset)
+    struct AudioOnset {
+        double pts_{NAN};
+        double time_{NAN};
+        int serial_{-1};
+    };
+    SeqLock<AudioOnset> audio_onset_;  // 音频回调写入, 渲染线程读取
+    int64_t audio_silent_bytes_{0};    // 连续静音的字节数 (仅音频回调)
+    SyncClock video_clock_;                // 视频时钟: 下一帧的理论 pts (仅视频解码线程写入)
+    double frame_timer_{0.0};              // 当前帧的目标呈现时刻 (秒, av_gettime_relative 时间轴)
+    double last_frame_pts_{0.0};           // 上一帧显示时间戳
+    double last_frame_delay_{0.0};         // 上一帧显示延迟
+
+    // Seek (事件线程投递请求, 读取线程执行)
+    // 播放序号 serial_: 每执行一次 seek 加 1, 包/帧/时钟都带有序号, 各消费者自行丢弃过期数据
+    std::atomic<double> seek_target_{0.0};           // 最新请求的目标 (秒), 连续请求只保留最后一个
+    std::atomic_bool seek_pending_{false};           // 是否有待执行的请求
+    std::atomic<int64_t> seek_request_us_{0};        // 最新请求的时刻
+    std::atomic<int> serial_{0};                     // 当前播放序号
+    std::atomic<double> serial_seek_target_{NAN};    // 当前序号对应的 seek 目标
+    std::atomic_bool serial_exact_{false};           // 当前序号是否需要追赶到目标时刻
+    std::atomic<int64_t> serial_request_us_{0};      // 当前序号对应的请求时刻
+    int shown_serial_{0};                            // 最近显示的帧的序号 (仅渲染线程)
+    std::size_t shown_item_{0};                      // 最近显示的帧所属的项 (仅渲染线程)
+    double shown_end_time_{0};                       // 最近显示的帧的结束时刻 (仅渲染线程)
+    std::atomic<uint64_t> seek_requests_{0};         // 统计: 请求次数
+    std::atomic<uint64_t> seeks_executed_{0};        // 统计: 执行次数
+    std::atomic<uint64_t> seek_failures_{0};         // 统计: 失败次数
+    std::atomic<int64_t> seek_exec_us_{0};           // 统计: demuxer 定位总耗时
+    std::atomic<int64_t> seek_exec_max_us_{0};       // 统计: demuxer 定位最大耗时
+    std::atomic<uint64_t> seeks_shown_{0};           // 统计: 显示出首帧的次数
+    std::atomic<int64_t> seek_latency_us_{0};        // 统计: 请求到首帧显示总耗时
+    std::atomic<int64_t> seek_latency_max_us_{0};    // 统计: 请求到首帧显示最大耗时
+    std::atomic<int64_t> seek_first_request_us_{0};  // 统计: 第一次请求时刻
+    std::atomic<int64_t> seek_last_shown_us_{0};     // 统计: 最近一次首帧显示时刻
     //
-    std::atomic_bool stop_{false};    // 是否停止
-    std::atomic_bool paused_{false};  // 是否暂停
+    std::atomic_bool stop_{false};                   // 是否停止
+    std::atomic_bool paused_{false};                 // 是否暂停
 };
 
 }  // namespace avplayer
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <avplayer/core.hpp>
+#include <avplayer/mmap_io.hpp>
+#include <avplayer/read_ahead.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace avplayer {
+
+// 展开命令行给出的输入: .m3u / .m3u8 文件替换为其中列出的条目 (跳过空行和 # 开头的行,
+// 相对路径相对于列表文件所在目录), 其他参数原样保留; 列表文件无法打开时抛出 std::runtime_error
+std::vector<std::string> ExpandPlaylist(const std::vector<std::string>& inputs);
+
+// ================== MediaItem ==================
+// 播放列表中已打开的一项: 自定义 IO 输入, demuxer, 所选的流和预先打开的解码器
+// - 读取线程持有正在读取的项; 下一项由预打开线程在后台打开, 读完当前项后交给读取线程
+// - 解码线程从项边界标记 (见 Player::PushItemMarkers) 取得新项, 接管其解码器;
+//   各方各持一份引用, 最后一个使用者释放时关闭输入
+struct MediaItem {
+    std::size_t index_{0};  // 在播放列表中的下标
+    std::string path_;      // 文件路径
+
+    // 自定义 IO 输入 (NOTE: 必须先于 format_ctx_ 构造、后于它析构)
+    MmapInput mmap_input_;
+    ReadAheadInput read_ahead_input_;
+    UniqueAVFormatContext format_ctx_;
+    int video_stream_idx_{-1};   // 所选视频流 (打开后不再修改)
+    int audio_stream_idx_{-1};   // 当前读取的音频流 (仅读取线程修改)
+    int decoder_audio_idx_{-1};  // audio_codec_ctx_ 对应的音频流 (打开后不再修改)
+    int discarded_streams_{0};   // 在 demuxer 处丢弃的流数
+    // 预先打开的解码器, 切换到本项时由解码线程接管 (第一项的解码器在构造时直接交给 Player)
+    UniqueAVCodecContext video_codec_ctx_;
+    UniqueAVCodecContext audio_codec_ctx_;
+
+    double start_time_{0};  // 容器起始时间戳 (秒)
+    double duration_{0};    // 容器时长 (秒, 0 表示未知)
+    double end_time_{0};    // 已读取的主时钟流包的最大结束时间戳 (秒, 仅读取线程)
+    double offset_{0};      // 本项时间戳 + offset_ = 播放列表时间轴 (秒, 交给解码线程之前确定)
+
+    int64_t open_start_us_{0};     // 开始打开的时刻 (av_gettime_relative)
+    int64_t opened_us_{0};         // avformat_open_input 完成的时刻
+    int64_t probed_us_{0};         // 流探测 (或从缓存写回) 完成的时刻
+    bool probe_cache_hit_{false};  // 是否命中探测缓存
+
+    AVStream* GetVideoStream() const {
+        return video_stream_idx_ >= 0 ? format_ctx_->streams[video_stream_idx_] : nullptr;
+    }
+};
+
+}  // namespace avplayer
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <avplayer/core.hpp>
+#include <cstdint>
+#include <string>
+
+namespace avplayer {
+
+// ================== ProbeCache Class ==================
+// 流探测结果的磁盘缓存: 保存 avformat_find_stream_info 得到的各流参数 (编码参数, 时间基,
+// 帧率, extradata 等) 和容器时长, 再次打开同一文件时直接写回, 跳过探测 (读取并解码若干帧)
+// - 文件标识: 大小 + 修改时间 + 文件头 kProbeCacheHeaderBytes 字节的哈希, 缓存文件按标识命名,
+//             文件被修改 (或改名后内容不同) 时自然不命中
+// - 校验: 流数、各流类型/编码/时间基必须与 avformat_open_input 读到的一致, 否则退回探测
+//         (例如 MPEG-TS 的流在读取过程中才被发现, 打开时的流数可能不同)
+// - 只缓存信息完整的结果 (视频有宽高, 音频有采样率和声道数), 自定义声道布局不缓存
+class ProbeCache {
+public:
+    // 计算 media_path 的文件标识, 确定缓存文件路径 (cache_dir 为空时使用
+    // $XDG_CACHE_HOME/avplayer/probe 或 ~/.cache/avplayer/probe); 不是本地文件时返回 false
+    bool Open(const std::string& media_path, const std::string& cache_dir);
+
+    // avformat_open_input 之后调用: 缓存命中且与 demuxer 读到的流一致时写回参数, 返回是否命中
+    bool Load(AVFormatContext* fmt_ctx) const;
+
+    // avformat_find_stream_info 之后调用: 保存探测结果 (先写临时文件再重命名)
+    void Save(const AVFormatContext* fmt_ctx) const;
+
+    // 缓存文件路径, 未打开时为空
+    const std::string& GetPath() const { return cache_path_; }
+
+private:
+    uint64_t file_size_{0};
+    int64_t mtime_{0};
+    uint64_t header_hash_{0};
+    std::string cache_path_;
+};
+
+}  // namespace avplayer
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <avplayer/core.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace avplayer {
+
+// ================== ReadAheadInput Class ==================
+// 异步预读输入: 通过自定义 AVIOContext 向 libavformat 提供数据, 同时在 demuxer 读取位置之前
+// 保持若干个大块 (kReadAheadBlockSize) 读请求在途, 慢速存储上 av_read_frame 不再逐次等待 IO
+// - 块缓存: window_blocks + 1 个槽位组成环, 块号 b 固定放在槽位 b % 槽位数; 读取第 b 块时
+//           请求 [b, b + 槽位数) 中尚未请求的块, 已读过的块所在槽位随窗口前移被复用
+// - 后端: io_uring (编译时找到 liburing 且内核支持时) 由读取线程提交和收割, 否则由线程池
+//         pread; 两者只决定数据如何到达槽位. 内核不支持 IORING_OP_READ (5.6 之前) 时
+//         io_uring 后端改用 IORING_OP_READV
+// - seek: 回调中按新位置重新定位窗口, 窗口外的已缓存块被覆盖, 在途的旧请求完成后槽位才复用
+// - 限速 (测试慢速存储): 按 "带宽 + 固定延迟" 的单设备模型为每个请求计算数据可用时刻,
+//   读取方等到该时刻才能使用数据 (同一文件不限速/限速对比, 无需真正的慢速介质)
+// - window_blocks = 0 时不预读: 每次只同步读取当前块, 作为对比的基线
+// NOTE: AVIOContext 由本类释放, 必须比使用它的 AVFormatContext 活得更久
+class ReadAheadInput {
+public:
+    struct Options {
+        int window_blocks{16};    // 预读窗口块数 (块大小 kReadAheadBlockSize)
+        bool io_uring{true};      // 可用时使用 io_uring, 否则线程池
+        double throttle_mbps{0};  // 限速: 模拟设备带宽 (MB/s, 0 表示不限)
+        double latency_ms{0};     // 限速: 模拟每个请求的固定延迟 (毫秒)
+    };
+
+    struct Stats {
+        const char* backend_{""};    // 实际使用的后端
+        uint64_t requests_{0};       // 发出的读请求数
+        uint64_t request_bytes_{0};  // 读请求的总字节数
+        uint64_t reads_{0};          // 读回调次数
+        uint64_t hits_{0};           // 读回调时数据已就绪的次数
+        uint64_t stalls_{0};         // 读回调等待 IO 的次数
+        double stall_ms_{0};         // 等待 IO 的总时长
+        double max_stall_ms_{0};     // 单次等待的最长时长
+        uint64_t seeks_{0};          // seek 回调次数
+        uint64_t retargets_{0};      // 目标落在窗口之外、重新定位窗口的次数
+        int queue_depth_{0};         // 当前在途请求数
+        int max_queue_depth_{0};     // 最大在途请求数
+        double avg_queue_depth_{0};  // 发出请求时的平均在途请求数
+    };
+
+public:
+    ReadAheadInput();
+    ~ReadAheadInput();
+    ReadAheadInput(const ReadAheadInput&) = delete;
+    ReadAheadInput(ReadAheadInput&&) = delete;
+
+public:
+    // 打开 path 并创建 AVIOContext; 不是普通文件或平台不支持时返回 false
+    bool Open(const std::string& path, const Options& options);
+
+    // 等待在途请求完成, 停止后端并释放 AVIOContext (可重复调用)
+    void Close();
+
+    // 设置给 AVFormatContext::pb, 未打开时为空
+    AVIOContext* GetContext() const { return io_ctx_.get(); }
+
+    Stats GetStats() const;
+
+private:
+    enum class BlockState {
+        kIdle,     // 槽位空闲
+        kPending,  // 请求在途
+        kReady,    // 数据已到达
+        kError,    // 读取失败
+    };
+
+    struct Block {
+        int64_t index_{-1};  // 块号 (-1 表示不对应任何块)
+        BlockState state_{BlockState::kIdle};
+        int length_{0};        // 有效字节数 (文件最后一块可能不满)
+        int error_{0};         // 读取失败时的错误码 (AVERROR)
+        int64_t ready_us_{0};  // 限速模型下数据可用的时刻 (0 表示不限速)
+        std::vector<uint8_t> data_;
+    };
+
+    struct Uring;  // io_uring 后端状态 (只在 read_ahead.cpp 中定义)
+
+    // AVIOContext 回调 (读取线程)
+    static int ReadPacket(void* opaque, uint8_t* buf, int buf_size);
+    static int64_t Seek(void* opaque, int64_t offset, int whence);
+
+    // seek 目标落在窗口之外: 取消尚未开始的旧请求, 调用方持有 mtx_
+    void Invalidate();
+    // 请求 [block, block + 槽位数) 中尚未请求的块, 调用方持有 mtx_
+    void Fill(int64_t block);
+    // 为 block 发出读请求 (槽位必须不在途), 调用方持有 mtx_
+    void Submit(int64_t block);
+    // 请求完成 (result 为读到的字节数或 AVERROR)
+    void Complete(std::size_t slot, int result);
+    // 等待任意一个请求完成 (io_uring 后端临时释放锁并收割完成事件)
+    void WaitForCompletion(std::unique_lock<std::mutex>& lk);
+    // 收割 io_uring 已完成的请求 (不持有 mtx_)
+    void ReapCompletions(bool wait);
+    // 线程池后端的工作线程
+    void WorkerLoop();
+
+private:
+    int fd_{-1};
+    int64_t size_{0};            // 文件大小
+    int64_t pos_{0};             // 当前读取位置 (仅读取线程)
+    double bytes_per_us_{0};     // 限速带宽 (字节/微秒, 0 表示不限)
+    int64_t latency_us_{0};      // 限速固定延迟
+    int64_t device_free_us_{0};  // 限速模型: 设备完成已提交请求的时刻
+    UniqueAVIOContext io_ctx_;
+
+    const char* backend_{""};
+    mutable std::mutex mtx_;
+    std::condition_variable request_cv_;  // 线程池后端: 有新请求
+    std::condition_variable done_cv_;     // 线程池后端: 有请求完成
+    std::vector<Block> blocks_;
+    std::deque<std::size_t> requests_;  // 线程池后端待处理的槽位
+    std::vector<std::jthread> workers_;
+    std::unique_ptr<Uring> uring_;
+    bool stop_{false};
+
+    std::atomic<int> in_flight_{0};
+    std::atomic<int> max_in_flight_{0};
+    std::atomic<uint64_t> requests_sent_{0};
+    std::atomic<uint64_t> request_bytes_{0};
+    std::atomic<uint64_t> depth_sum_{0};
+    std::atomic<uint64_t> reads_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<int64_t> stall_us_{0};
+    std::atomic<int64_t> stall_max_us_{0};
+    std::atomic<uint64_t> seeks_{0};
+    std::atomic<uint64_t> retargets_{0};
+};
+
+}  // namespace avplayer
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <avplayer/core.hpp>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace avplayer {
+
+// ================== SeekIndex Class ==================
+// 关键帧索引: 后台线程用独立的 AVFormatContext 扫描文件, 记录某一路流所有关键帧的
+// (pts, 字节位置, 大小), 播放线程 seek 时按目标时间 O(1) 查到之前最近的关键帧
+// - 查找: 按秒分桶, buckets_[s] 为第一个落在第 s 秒 (相对第一个关键帧) 及之后的关键帧下标,
+//         之后只需在同一秒内向后走几步
+// - 索引建立过程中可以查找: 目标超出已扫描范围时返回空, 由调用方退回普通 seek
+// - sidecar 文件: 扫描完成后保存, 下次打开时按文件大小和修改时间校验后直接加载
+class SeekIndex {
+public:
+    struct Entry {
+        int64_t pts_{0};   // 关键帧时间戳 (流时间基)
+        int64_t pos_{-1};  // 关键帧包在文件中的字节位置 (-1 表示未知)
+        int size_{0};      // 关键帧包大小
+    };
+
+public:
+    SeekIndex() = default;
+    ~SeekIndex();
+    SeekIndex(const SeekIndex&) = delete;
+    SeekIndex(SeekIndex&&) = delete;
+
+public:
+    // 在后台线程中建立 stream_index 路流的索引 (sidecar_path 为空表示不使用 sidecar 文件)
+    // 可以再次调用: 停止之前的扫描, 清空后为新的文件重新建立
+    void Start(std::string file_path, int stream_index, std::string sidecar_path);
+
+    // 停止后台线程 (可重复调用)
+    void Stop();
+
+    // 查找 pts 不大于 time_sec 的最近关键帧 (time_sec 为秒), 超出已建立的范围时返回空
+    std::optional<Entry> Lookup(double time_sec) const;
+
+    // 已索引的关键帧数
+    std::size_t GetSize() const;
+
+    // 索引是否已覆盖整个文件
+    bool IsComplete() const { return complete_.load(std::memory_order_acquire); }
+
+private:
+    void BuildLoop();
+
+    // 直接使用 demuxer 自带的完整索引 (例如 MP4 的 sample table), 不完整时返回 false
+    bool SeedFromDemuxer(AVFormatContext* fmt_ctx, AVStream* stream);
+
+    // 顺序扫描所有包, 记录关键帧
+    bool Scan(AVFormatContext* fmt_ctx, AVStream* stream);
+
+    // 追加一个关键帧 (pts 必须递增, 否则丢弃), 调用方持有 mtx_
+    void Append(const Entry& entry);
+
+    // 关键帧相对第一个关键帧所在的秒数, 调用方持有 mtx_
+    std::size_t BucketOf(int64_t pts) const;
+
+    bool LoadSidecar();
+    void SaveSidecar() const;
+
+    // avformat 阻塞 IO 的中断回调 (Stop 时尽快返回)
+    static int InterruptCallback(void* opaque);
+
+private:
+    std::string file_path_;
+    std::string sidecar_path_;
+    int stream_index_{-1};
+
+    mutable std::mutex mtx_;
+    AVRational time_base_{0, 1};
+    std::vector<Entry> entries_;        // 按 pts 递增的关键帧
+    std::vector<std::size_t> buckets_;  // 每秒第一个关键帧下标
+
+    std::atomic_bool complete_{false};
+    std::atomic_bool stop_{false};
+    std::jthread thread_;
+};
+
+}  // namespace avplayer
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace avplayer {
+
+// ================== Thread Statistics ==================
+
+// 单个线程的 CPU 时间
+struct ThreadCpuTime {
+    int tid_{0};             // 线程 id
+    std::string name_;       // 线程名 (FFmpeg 工作线程形如 "av:hevc:df0")
+    double cpu_seconds_{0};  // 用户态 + 内核态 CPU 时间 (秒)
+};
+
+// 设置当前线程名 (便于在统计、top/perf 中区分各阶段线程, 最长 15 字节)
+void SetCurrentThreadName(const char* name);
+
+// 获取当前线程已消耗的 CPU 时间 (秒)
+double GetCurrentThreadCpuTime();
+
+// 获取本进程所有线程的 CPU 时间 (Linux 读取 /proc/self/task, 其他平台返回空)
+std::vector<ThreadCpuTime> GetThreadCpuTimes();
+
+}  // namespace avplayer
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <avplayer/core.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace avplayer {
+
+// ================== High Bit Depth Kernels ==================
+// 10 位 (yuv420p10le, P010) -> 8 位的转换内核, 按 CPU 运行时选择 AVX2 / SSE4.1 / 标量实现
+// shift: 样本右移的位数, 低位对齐的 yuv420p10le 为 2, 高位对齐的 P010 为 8; 就近取整并饱和到 255
+
+enum class SimdLevel {
+    kScalar,
+    kSse41,
+    kAvx2,
+};
+
+// 当前使用的指令集 (默认为 CPU 支持的最高级别)
+SimdLevel GetSimdLevel();
+
+// 限制内核使用的最高指令集 (基准对比用), 返回实际生效的级别
+SimdLevel SetSimdLevel(SimdLevel level);
+
+const char* GetSimdLevelName(SimdLevel level);
+
+// 10 位平面 -> 8 位平面, count 为样本数
+void ConvertP10ToP8(const uint16_t* in, uint8_t* out, std::size_t count, int shift);
+
+// 交织的 10 位 UV (P010) -> 8 位的 U, V 两个平面, count 为 UV 对数
+void DeinterleaveP10ToP8(const uint16_t* in, uint8_t* u, uint8_t* v, std::size_t count, int shift);
+
+// 10 位平面 -> 8 位平面, 按 1024 项的查找表映射 (色调映射)
+// NOTE: 查表无法有效向量化 (gather 不比标量查表快), 只有标量实现
+void ConvertP10ToP8Lut(const uint16_t* in, uint8_t* out, std::size_t count, int shift,
+                       const uint8_t* lut);
+
+// ================== VideoConverter Class ==================
+// 解码帧 -> 可直接上传到 SDL 纹理的帧, 仅视频解码线程使用 (渲染线程只做上传)
+// 按输入像素格式选择转换路径:
+// - kPassthrough: 有对应的 SDL 纹理格式且渲染器原生支持 (YUV420P -> IYUV, NV12, NV21,
+//                 YUYV422 -> YUY2, UYVY422 -> UYVY), 直接移动帧引用, 零拷贝
+// - kKernel:      10 位 yuv420p10le / P010 用 SIMD 内核转换为 8 位 YUV420P (IYUV) 或 NV12;
+//                 PQ / HLG 传输特性的帧同时对亮度做简单的色调映射 (查找表)
+// - kSwscale:     其他格式 (YUV422P/YUV444P/RGB 等) 用 swscale 转换为 YUV420P (IYUV)
+// 降分辨率级别 > 0 时 (窗口远小于视频), 输出宽高为输入的 1 / 2^level: 直通和 swscale 路径
+// 直接由 swscale 缩放 (SWS_AREA), kKernel 路径先转为 8 位再缩放
+// SwsContext 按输入参数 (宽, 高, 像素格式) 和降分辨率级别缓存, 参数变化时才重建, 开启片级多线程;
+// 转换输出的图像缓冲来自独立的 FrameBufferPool, 稳态下不分配内存
+class VideoConverter {
+public:
+    enum class Path {
+        kPassthrough,
+        kKernel,
+        kSwscale,
+    };
+
+public:
+    VideoConverter() = default;
+    ~VideoConverter() = default;
+    VideoConverter(const VideoConverter&) = delete;
+    VideoConverter(VideoConverter&&) = delete;
+
+public:
+    // native_formats: 渲染器原生支持的纹理格式 (SDL_RendererInfo), threads: swscale 线程数,
+    // tonemap: 是否对 PQ / HLG 内容做色调映射 (否则只截断到 8 位, 画面偏灰暗)
+    // NOTE: 需在解码线程启动前调用
+    void Init(std::vector<uint32_t> native_formats, int threads, bool tonemap);
+
+    // 转换一帧: 结果写入 out (空帧), in 的引用被移走或释放; texture_format 返回 SDL 纹理格式
+    // 失败时返回 AVERROR, in 保持不变; 输入无法转换时 (错误只在选择路径时输出一次)
+    // 在输入参数变化之前每帧都返回 AVERROR(ENOSYS)
+    int Convert(AVFrame* in, AVFrame* out, uint32_t* texture_format);
+
+    // 设置降分辨率级别 (0 表示原尺寸), 下一帧生效
+    void SetDownscaleLevel(int level) { downscale_level_ = level; }
+
+    Path GetPath() const { return path_; }
+
+    // 转换输出缓冲池统计
+    FrameBufferPool::Stats GetPoolStats() const { return pool_.GetStats(); }
+
+private:
+    // 按输入参数和降分辨率级别选择转换路径
+    // (kSwscale 时创建转换上下文, kKernel 时按需生成色调映射表), 失败时返回 false
+    bool Configure(const AVFrame* frame, int level);
+
+    // 创建 format (输入尺寸) -> YUV420P (输出尺寸) 的 swscale 上下文
+    bool CreateScaler(AVPixelFormat format);
+
+    // kKernel: 10 位帧 -> 8 位帧 (out 已分配缓冲, 格式为 YUV420P 或 NV12)
+    void ConvertHighBitDepth(const AVFrame* in, AVFrame* out) const;
+
+    // 生成 10 位亮度码值 -> 8 位 SDR 码值的色调映射表
+    void BuildToneMapLut(AVColorTransferCharacteristic trc, bool full_range);
+
+    // 渲染器是否原生支持该纹理格式
+    bool IsNative(uint32_t texture_format) const;
+
+private:
+    std::vector<uint32_t> native_formats_;
+    int threads_{1};
+    bool tonemap_{true};
+
+    // 输入参数
+    int in_width_{0};
+    int in_height_{0};
+    AVPixelFormat in_format_{AV_PIX_FMT_NONE};
+    AVColorTransferCharacteristic in_trc_{AVCOL_TRC_UNSPECIFIED};
+    AVColorRange in_range_{AVCOL_RANGE_UNSPECIFIED};
+    int downscale_level_{0};        // 请求的降分辨率级别
+    bool downscale_failed_{false};  // 曾经创建缩放上下文失败, 之后不再降分辨率
+
+    // 输出参数
+    int out_level_{0};
+    int out_width_{0};
+    int out_height_{0};
+
+    Path path_{Path::kPassthrough};
+    bool configured_{true};  // 当前输入参数是否有可用的转换路径
+    uint32_t texture_format_{SDL_PIXELFORMAT_IYUV};
+    AVPixelFormat out_format_{AV_PIX_FMT_YUV420P};  // 输出像素格式 (kKernel / kSwscale)
+    UniqueSwsContext sws_ctx_;                      // 格式转换/缩放上下文
+    FrameBufferPool pool_;                          // 转换输出缓冲池
+
+    // kKernel
+    int in_shift_{2};                       // 样本右移位数 (yuv420p10le: 2, P010: 8)
+    bool tonemap_active_{false};            // 当前输入是否做色调映射
+    std::array<uint8_t, 1024> luma_lut_{};  // 10 位亮度 -> 8 位的色调映射表
+    UniqueAVFrame stage_frame_;             // 降分辨率时内核输出的原尺寸 8 位中间帧 (复用)
+};
+
+}  // namespace avplayer
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace avplayer {
+
+// ================== VsyncScheduler Class ==================
+// 垂直同步槽位调度: 把每一帧的理想呈现时刻映射到显示器的某一次垂直同步 (槽位), 仅渲染线程使用
+// - 刷新周期: 初值来自 SDL_GetCurrentDisplayMode (整数 Hz, 例如 59.94 Hz 报告为 59 或 60),
+//             之后用相邻两次呈现返回时刻的间隔修正
+// - 相位: 以上一帧实际呈现 (SDL_RenderPresent 返回) 的时刻为锚点, 槽位 = 锚点 + n 个周期
+// - 槽位分配: n = round((理想时刻 - 锚点) / 周期), 至少为 1; 落在两个槽位正中附近时
+//             (例如 24 fps 在 60 Hz 上的 2.5 个周期) 与上一帧的选择交替, 得到确定的 2:3 节奏,
+//             而不是由时间戳的舍入误差随机决定
+// - 内容帧率高于刷新率时 (例如 60 fps 在 59.94 Hz 上), 离理想时刻最近的垂直同步已被上一帧
+//   占用的帧应当丢弃, 否则之后的帧会整体越来越晚
+// - 渲染线程在槽位前半个周期醒来提交, SDL_RenderPresent 只阻塞到该槽位的垂直同步
+// 所有时刻均为秒 (av_gettime_relative 时间轴)
+class VsyncScheduler {
+public:
+    struct Slot {
+        double time_{NAN};  // 槽位时刻 (未启用或尚无锚点时为理想时刻)
+        int vsyncs_{0};     // 距上一帧的周期数 (0 表示未按槽位调度)
+        bool drop_{false};  // 最近的垂直同步已被上一帧占用, 应丢弃该帧
+    };
+
+    struct Stats {
+        bool active_{false};              // 是否按槽位调度
+        double refresh_hz_{0};            // 估计的刷新率
+        uint64_t frames_{0};              // 按槽位呈现的帧数
+        uint64_t missed_{0};              // 错过分配的垂直同步 (晚了至少半个周期) 的帧数
+        uint64_t dropped_{0};             // 没有可用槽位而丢弃的帧数
+        double avg_cadence_error_ms_{0};  // 槽位与理想呈现时刻之差的平均绝对值
+        double max_cadence_error_ms_{0};  // 槽位与理想呈现时刻之差的最大绝对值
+        // 每帧持续的周期数分布: 下标 i 统计持续 i + 1 个周期的帧, 最后一个桶包括更多
+        std::array<uint64_t, 4> vsyncs_{};
+    };
+
+public:
+    VsyncScheduler() = default;
+    ~VsyncScheduler() = default;
+    VsyncScheduler(const VsyncScheduler&) = delete;
+    VsyncScheduler(VsyncScheduler&&) = delete;
+
+public:
+    // 设置显示器标称刷新率 (0 表示关闭槽位调度), 与当前值相同时不重置已学到的周期和相位
+    void Reset(double refresh_hz);
+
+    // 为理想呈现时刻 target 分配槽位 (不改变状态, 呈现后由 OnPresented 提交)
+    Slot Assign(double target) const;
+
+    // 应该提交该槽位的时刻: 槽位前半个周期 (上一次垂直同步之后, 留出上传时间)
+    double GetWakeTime(const Slot& slot) const;
+
+    // 帧已呈现: target 为理想时刻, presented 为 SDL_RenderPresent 返回的时刻
+    void OnPresented(double target, const Slot& slot, double presented);
+
+    // 帧因 Slot::drop_ 被丢弃
+    void OnDropped() { ++dropped_; }
+
+    bool IsActive() const { return nominal_period_ > 0; }
+
+    Stats GetStats() const;
+
+private:
+    double nominal_period_{0};    // 标称刷新周期 (0 表示未启用)
+    double period_{0};            // 修正后的刷新周期
+    double anchor_{NAN};          // 上一帧所在槽位 (垂直同步) 的时刻
+    double last_presented_{NAN};  // 上一帧呈现返回的时刻
+    int last_vsyncs_{0};          // 上一帧分配的周期数
+
+    std::atomic<int64_t> period_ns_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> missed_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<int64_t> cadence_error_us_{0};
+    std::atomic<int64_t> cadence_error_max_us_{0};
+    std::array<std::atomic<uint64_t>, 4> vsyncs_{};
+};
+
+}  // namespace avplayer
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <avplayer/audio_convert.hpp>
+#include <avplayer/logger.hpp>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace avplayer {
+
+// =============================================================================
+// 采样格式转换内核
+// =============================================================================
+
+namespace {
+
+constexpr float kS16Scale = 32768.0f;
+
+inline int16_t FloatToS16(float sample) {
+    // 先限幅再取整, 避免超范围浮点转整数的未定义行为
+    return static_cast<int16_t>(std::lrintf(std::clamp(sample * kS16Scale, -32768.0f, 32767.0f)));
+}
+
+inline int16_t S32ToS16(int32_t sample) { return static_cast<int16_t>(sample >> 16); }
+
+#if defined(__SSE2__)
+// 4 个浮点 -> 4 个 int32 (限幅 + 就近取整, MXCSR 默认舍入模式)
+inline __m128i FloatToS32x4(const float* in) {
+    const __m128 scale = _mm_set1_ps(kS16Scale);
+    const __m128 min = _mm_set1_ps(-32768.0f);
+    const __m128 max = _mm_set1_ps(32767.0f);
+    __m128 v = _mm_mul_ps(_mm_loadu_ps(in), scale);
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, min), max));
+}
+
+inline __m128i S32ToS16HighX4(const int32_t* in) {
+    return _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), 16);
+}
+#elif defined(__aarch64__)
+inline int16x4_t FloatToS16x4(const float* in) {
+    // vcvtnq: 就近取整 (偶数优先); vqmovn: 饱和收窄
+    return vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in), kS16Scale)));
+}
+#endif
+
+}  // namespace
+
+void ConvertFltToS16(const float* in, int16_t* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_packs_epi32(FloatToS32x4(in + i), FloatToS32x4(in + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+#elif defined(__aarch64__)
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(out + i, vcombine_s16(FloatToS16x4(in + i), FloatToS16x4(in + i + 4)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = FloatToS16(in[i]);
+    }
+}
+
+void ConvertS32ToS16(const int32_t* in, int16_t* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_packs_epi32(S32ToS16HighX4(in + i), S32ToS16HighX4(in + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+#elif defined(__aarch64__)
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(out + i, vcombine_s16(vshrn_n_s32(vld1q_s32(in + i), 16),
+                                        vshrn_n_s32(vld1q_s32(in + i + 4), 16)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = S32ToS16(in[i]);
+    }
+}
+
+void InterleaveFltpToS16(const float* const* in, int channels, int16_t* out, std::size_t samples) {
+    if (channels == 1) {
+        ConvertFltToS16(in[0], out, samples);
+        return;
+    }
+    std::size_t i = 0;
+    if (channels == 2) {
+        const float* left = in[0];
+        const float* right = in[1];
+#if defined(__SSE2__)
+        for (; i + 4 <= samples; i += 4) {
+            __m128i l = FloatToS32x4(left + i);
+            __m128i r = FloatToS32x4(right + i);
+            // L0 R0 L1 R1 | L2 R2 L3 R3
+            __m128i v = _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), v);
+        }
+#elif defined(__aarch64__)
+        for (; i + 4 <= samples; i += 4) {
+            vst2_s16(out + i * 2, int16x4x2_t{{FloatToS16x4(left + i), FloatToS16x4(right + i)}});
+        }
+#endif
+    }
+    for (; i < samples; ++i) {
+        for (int ch = 0; ch < channels; ++ch) {
+            out[i * channels + ch] = FloatToS16(in[ch][i]);
+        }
+    }
+}
+
+void InterleaveS16pToS16(const int16_t* const* in, int channels, int16_t* out,
+                         std::size_t samples) {
+    std::size_t i = 0;
+    if (channels == 2) {
+        const int16_t* left = in[0];
+        const int16_t* right = in[1];
+#if defined(__SSE2__)
+        for (; i + 8 <= samples; i += 8) {
+            __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+            __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi16(l, r));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 8),
+                             _mm_unpackhi_epi16(l, r));
+        }
+#elif defined(__aarch64__)
+        for (; i + 8 <= samples; i += 8) {
+            vst2q_s16(out + i * 2, int16x8x2_t{{vld1q_s16(left + i), vld1q_s16(right + i)}});
+        }
+#endif
+    }
+    for (; i < samples; ++i) {
+        for (int ch = 0; ch < channels; ++ch) {
+            out[i * channels + ch] = in[ch][i];
+        }
+    }
+}
+
+void InterleaveS32pToS16(const int32_t* const* in, int channels, int16_t* out,
+                         std::size_t samples) {
+    if (channels == 1) {
+        ConvertS32ToS16(in[0], out, samples);
+        return;
+    }
+    std::size_t i = 0;
+    if (channels == 2) {
+        const int32_t* left = in[0];
+        const int32_t* right = in[1];
+#if defined(__SSE2__)
+        for (; i + 4 <= samples; i += 4) {
+            __m128i l = S32ToS16HighX4(left + i);
+            __m128i r = S32ToS16HighX4(right + i);
+            __m128i v = _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), v);
+        }
+#elif defined(__aarch64__)
+        for (; i + 4 <= samples; i += 4) {
+            vst2_s16(out + i * 2, int16x4x2_t{{vshrn_n_s32(vld1q_s32(left + i), 16),
+                                               vshrn_n_s32(vld1q_s32(right + i), 16)}});
+        }
+#endif
+    }
+    for (; i < samples; ++i) {
+        for (int ch = 0; ch < channels; ++ch) {
+            out[i * channels + ch] = S32ToS16(in[ch][i]);
+        }
+    }
+}
+
+// =============================================================================
+// AudioConverter 实现
+// =============================================================================
+
+AudioConverter::~AudioConverter() {
+    av_channel_layout_uninit(&out_layout_);
+    av_channel_layout_uninit(&in_layout_);
+}
+
+bool AudioConverter::Init(const SDL_AudioSpec& spec, const AVCodecContext* codec_ctx) {
+    if (spec.format != AUDIO_S16SYS) {
+        LOG_ERROR("音频输出转换: SDL 音频设备不支持 S16 输出");
+        return false;
+    }
+    out_sample_rate_ = spec.freq;
+    av_channel_layout_uninit(&out_layout_);
+    av_channel_layout_default(&out_layout_, spec.channels);
+    out_frame_bytes_ = spec.channels * av_get_bytes_per_sample(AV_SAMPLE_FMT_S16);
+    // 输出缓冲容纳 4 个 SDL 缓冲的样本 (至少 4096), 更长的帧分段输出
+    out_capacity_ = std::max(static_cast<int>(spec.samples) * 4, 4096);
+    output_.assign(static_cast<std::size_t>(out_capacity_) * out_frame_bytes_, 0);
+
+    return Configure(codec_ctx->sample_fmt, codec_ctx->ch_layout, codec_ctx->sample_rate);
+}
+
+bool AudioConverter::Configure(AVSampleFormat format, const AVChannelLayout& layout,
+                               int sample_rate) {
+    in_format_ = format;
+    av_channel_layout_uninit(&in_layout_);
+    av_channel_layout_copy(&in_layout_, &layout);
+    in_sample_rate_ = sample_rate;
+    swr_ctx_.reset();
+
+    // 采样率和声道数一致时只需格式转换; 声道顺序不同 (例如 native 与 unspec) 不影响交织结果
+    bool same_shape = sample_rate == out_sample_rate_ &&
+                      layout.nb_channels == out_layout_.nb_channels &&
+                      layout.nb_channels <= AV_NUM_DATA_POINTERS;
+    if (same_shape && format == AV_SAMPLE_FMT_S16) {
+        path_ = Path::kPassthrough;
+    } else if (same_shape &&
+               (format == AV_SAMPLE_FMT_FLT || format == AV_SAMPLE_FMT_FLTP ||
+                format == AV_SAMPLE_FMT_S16P || format == AV_SAMPLE_FMT_S32 ||
+                format == AV_SAMPLE_FMT_S32P)) {
+        path_ = Path::kKernel;
+    } else {
+        path_ = Path::kResample;
+        // C++ 的 RAII 智能指针与 C 风格的“出参”函数正确地协同工作: 临时裸指针作为「中间人」
+        SwrContext* tmp_swr_ctx{nullptr};
+        int ret = swr_alloc_set_opts2(&tmp_swr_ctx, &out_layout_, AV_SAMPLE_FMT_S16,
+                                      out_sample_rate_, &layout, format, sample_rate, 0, nullptr);
+        swr_ctx_.reset(tmp_swr_ctx);  // 立即转移所有权
+        if (ret < 0 || swr_init(swr_ctx_.get()) < 0) {
+            // 音频解码线程中不能抛出异常: 之后这种输入的帧都被丢弃 (输出静音), 直到输入参数变化
+            LOG_ERROR("音频输出转换: 创建 {} {} Hz {} 声道的重采样上下文失败",
+                      av_get_sample_fmt_name(format) ? av_get_sample_fmt_name(format) : "none",
+                      sample_rate, layout.nb_channels);
+            swr_ctx_.reset();
+            return false;
+        }
+    }
+    LOG_INFO("音频输出转换: {} {} Hz {} 声道 -> s16 {} Hz {} 声道, 路径: {}",
+             av_get_sample_fmt_name(format) ? av_get_sample_fmt_name(format) : "none",
+             sample_rate, layout.nb_channels, out_sample_rate_, out_layout_.nb_channels,
+             path_ == Path::kPassthrough ? "直通"
+             : path_ == Path::kKernel    ? "SIMD 格式转换"
+                                         : "swresample 重采样");
+    return true;
+}
+
+void AudioConverter::Begin(const AVFrame* frame) {
+    if (frame->format != in_format_ || frame->sample_rate != in_sample_rate_ ||
+        av_channel_layout_compare(&frame->ch_layout, &in_layout_) != 0) {
+        Configure(static_cast<AVSampleFormat>(frame->format), frame->ch_layout,
+                  frame->sample_rate);
+    }
+    frame_ = frame;
+    offset_ = 0;
+    resample_more_ = false;
+    draining_ = false;
+}
+
+std::size_t AudioConverter::Next(const uint8_t** data) {
+    if (draining_) {
+        uint8_t* out = output_.data();
+        int count = swr_convert(swr_ctx_.get(), &out, out_capacity_, nullptr, 0);
+        if (count <= 0) {
+            draining_ = false;
+            return 0;
+        }
+        *data = output_.data();
+        return static_cast<std::size_t>(count) * out_frame_bytes_;
+    }
+    if (!frame_) {
+        return 0;
+    }
+    if (path_ == Path::kResample && !swr_ctx_) {
+        frame_ = nullptr;  // 没有可用的重采样上下文: 丢弃该帧
+        return 0;
+    }
+    switch (path_) {
+        case Path::kPassthrough: {
+            // 零拷贝: 直接输出帧数据 (写入 PCM 环形缓冲时才有唯一一次拷贝)
+            *data = frame_->data[0];
+            auto size = static_cast<std::size_t>(frame_->nb_samples) * out_frame_bytes_;
+            frame_ = nullptr;
+            return size;
+        }
+        case Path::kKernel: {
+            int count = std::min(frame_->nb_samples - offset_, out_capacity_);
+            if (count <= 0) {
+                frame_ = nullptr;
+                return 0;
+            }
+            ConvertKernel(count);
+            offset_ += count;
+            *data = output_.data();
+            return static_cast<std::size_t>(count) * out_frame_bytes_;
+        }
+        case Path::kResample: {
+            uint8_t* out = output_.data();
+            int count = 0;
+            if (offset_ == 0) {
+                // 第一次: 送入整帧, 输出缓冲不够时剩余样本缓存在重采样器内部
+                count = swr_convert(swr_ctx_.get(), &out, out_capacity_, frame_->extended_data,
+                                    frame_->nb_samples);
+                offset_ = frame_->nb_samples;
+            } else if (resample_more_) {
+                // 取出上次没放下的样本: 输入必须非空 (0 个样本), 空输入会冲刷重采样器,
+                // 在流中间输出滤波器尾部, 产生可闻的杂音
+                count = swr_convert(swr_ctx_.get(), &out, out_capacity_, frame_->extended_data,
+                                    0);
+            }
+            resample_more_ = count == out_capacity_;
+            if (count <= 0) {
+                if (count < 0) {
+                    LOG_ERROR("音频重采样失败: {}", av_err2str(count));
+                }
+                frame_ = nullptr;
+                return 0;
+            }
+            *data = output_.data();
+            return static_cast<std::size_t>(count) * out_frame_bytes_;
+        }
+    }
+    return 0;
+}
+
+void AudioConverter::BeginDrain() {
+    frame_ = nullptr;
+    draining_ = path_ == Path::kResample && swr_ctx_;
+}
+
+void AudioConverter::Reset() {
+    frame_ = nullptr;
+    draining_ = false;
+    if (swr_ctx_) {
+        // 重新初始化会丢弃内部缓存的样本和滤波器历史
+        swr_init(swr_ctx_.get());
+    }
+}
+
+void AudioConverter::ConvertKernel(int count) {
+    const int channels = in_layout_.nb_channels;
+    auto out = reinterpret_cast<int16_t*>(output_.data());
+    auto samples = static_cast<std::size_t>(count);
+    if (!av_sample_fmt_is_planar(in_format_)) {
+        // 交织格式: 按样本总数逐个转换
+        auto total = samples * channels;
+        auto offset = static_cast<std::size_t>(offset_) * channels;
+        if (in_format_ == AV_SAMPLE_FMT_FLT) {
+            ConvertFltToS16(reinterpret_cast<const float*>(frame_->data[0]) + offset, out, total);
+        } else {
+            ConvertS32ToS16(reinterpret_cast<const int32_t*>(frame_->data[0]) + offset, out,
+                            total);
+        }
+        return;
+    }
+    // 平面格式: 各声道指针偏移到 offset_ 后交织
+    std::array<const uint8_t*, AV_NUM_DATA_POINTERS> planes{};
+    const int bytes_per_sample = av_get_bytes_per_sample(in_format_);
+    for (int ch = 0; ch < channels; ++ch) {
+        planes[ch] =
+            frame_->extended_data[ch] + static_cast<std::size_t>(offset_) * bytes_per_sample;
+    }
+    if (in_format_ == AV_SAMPLE_FMT_FLTP) {
+        InterleaveFltpToS16(reinterpret_cast<const float* const*>(planes.data()), channels, out,
+                            samples);
+    } else if (in_format_ == AV_SAMPLE_FMT_S16P) {
+        InterleaveS16pToS16(reinterpret_cast<const int16_t* const*>(planes.data()), channels, out,
+                            samples);
+    } else {
+        InterleaveS32pToS16(reinterpret_cast<const int32_t* const*>(planes.data()), channels, out,
+                            samples);
+    }
+}
+
+}  // namespace avplayer
@@ -0,0 +1,37 @@
+#include <avplayer/clock.hpp>
+
+namespace avplayer {
+
+void SyncClock::Set(double pts, double time, int serial) {
+    sample_.Update([&](Sample& sample) {
+        sample.pts_ = pts;
+        sample.time_ = time;
+        sample.drift_ = pts - time;
+        sample.serial_ = serial;
+    });
+}
+
+void SyncClock::SetPaused(bool paused, double time) {
+    sample_.Update([&](Sample& sample) {
+        if (paused == sample.paused_) {
+            return;
+        }
+        if (paused) {
+            sample.pts_ = sample.drift_ + time;  // 之后 Get 返回暂停时刻的值
+        } else {
+            sample.drift_ = sample.pts_ - time;  // 从暂停时的值继续走
+        }
+        sample.time_ = time;
+        sample.paused_ = paused;
+    });
+}
+
+double SyncClock::Get(double time, int serial) const {
+    Sample sample = sample_.Load();
+    if (sample.serial_ != serial) {
+        return NAN;
+    }
+    return sample.paused_ ? sample.pts_ : sample.drift_ + time;
+}
+
+}  // namespace avplayer
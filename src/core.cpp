@@ -1,73 +1,524 @@
+#include <algorithm>
 #include <avplayer/core.hpp>
 #include <avplayer/logger.hpp>
+#include <bit>
+#include <cstring>
+#include <iterator>
 
 namespace avplayer {
 
 // =============================================================================
-// PacketQueue 实现
+// PacketPool 实现
 // =============================================================================
 
-bool PacketQueue::Push(UniqueAVPacket packet) {
-    std::unique_lock lk{mtx_};
-    cv_can_push_.wait(lk, [this] { return closed_ || curr_data_bytes_ < max_data_bytes_; });
-    if (closed_) {
+PacketPool::~PacketPool() {
+    auto free_list = [](AVPacket* packet) {
+        while (packet) {
+            auto next = static_cast<AVPacket*>(packet->opaque);
+            av_packet_free(&packet);
+            packet = next;
+        }
+    };
+    free_list(local_free_);
+    free_list(shared_free_.exchange(nullptr, std::memory_order_acquire));
+}
+
+UniqueAVPacket PacketPool::Acquire() {
+    if (!local_free_) {
+        // 私有链用完后一次性取走其他线程归还的整条链
+        local_free_ = shared_free_.exchange(nullptr, std::memory_order_acquire);
+    }
+    AVPacket* packet = local_free_;
+    if (packet) {
+        local_free_ = static_cast<AVPacket*>(packet->opaque);
+        packet->opaque = nullptr;
+        idle_.fetch_sub(1, std::memory_order_relaxed);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        packet = av_packet_alloc();
+        misses_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return UniqueAVPacket{packet, AVPacketDeleter{this}};
+}
+
+void PacketPool::Release(AVPacket* packet) {
+    if (idle_.load(std::memory_order_relaxed) >= max_idle_) {
+        av_packet_free(&packet);  // 空闲壳过多 (例如 Seek 后队列被整体丢弃), 直接释放
+        return;
+    }
+    av_packet_unref(packet);
+    idle_.fetch_add(1, std::memory_order_relaxed);
+    auto head = shared_free_.load(std::memory_order_relaxed);
+    do {
+        packet->opaque = head;
+    } while (!shared_free_.compare_exchange_weak(head, packet, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+}
+
+PacketPool::Stats PacketPool::GetStats() const {
+    return Stats{hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed),
+                 idle_.load(std::memory_order_relaxed)};
+}
+
+// =============================================================================
+// FrameBufferPool 实现
+// =============================================================================
+
+namespace {
+
+// 每块缓冲前预留的头部, 用于在释放回调中取回缓冲大小 (保持 64 字节对齐)
+constexpr std::size_t kPoolBufferHeader = 64;
+// 与 libavcodec 默认分配器一致的尾部余量 (部分 SIMD 实现会越界读取)
+constexpr std::size_t kPoolBufferPadding = 16 + 64 - 1;
+// 没有解码器上下文时 (例如格式转换输出) 使用的行宽对齐
+constexpr int kPoolLinesizeAlign = 64;
+
+}  // namespace
+
+FrameBufferPool::~FrameBufferPool() {
+    std::lock_guard lk{mtx_};
+    ResetPools();
+}
+
+bool FrameBufferPool::Install(AVCodecContext* codec_ctx) {
+    // 不支持 DR1 的解码器必须使用默认分配器
+    if (!codec_ctx->codec || !(codec_ctx->codec->capabilities & AV_CODEC_CAP_DR1)) {
         return false;
     }
-    curr_data_bytes_ += packet->size;
-    duration_ += packet->duration;
-    queue_.push(std::move(packet));
-    cv_can_pop_.notify_one();
+    codec_ctx->opaque = this;
+    codec_ctx->get_buffer2 = GetBuffer2Wrapper;
     return true;
 }
 
-std::optional<UniqueAVPacket> PacketQueue::Pop() {
-    std::unique_lock lk{mtx_};
-    cv_can_pop_.wait(lk, [this] { return closed_ || !queue_.empty(); });
-    if (queue_.empty()) {
-        return std::nullopt;
+int FrameBufferPool::GetBuffer2Wrapper(AVCodecContext* codec_ctx, AVFrame* frame, int flags) {
+    auto pool = static_cast<FrameBufferPool*>(codec_ctx->opaque);
+    if (codec_ctx->codec_type == AVMEDIA_TYPE_VIDEO) {
+        return pool->GetVideoBuffer(frame, codec_ctx, flags);
     }
-    auto packet{std::move(queue_.front())};
-    queue_.pop();
-    curr_data_bytes_ -= packet->size;
-    duration_ -= packet->duration;
-    cv_can_push_.notify_one();
-    return packet;
+    return pool->GetAudioBuffer(frame, codec_ctx, flags);
+}
+
+AVBufferRef* FrameBufferPool::AllocWrapper(void* opaque, std::size_t size) {
+    auto self = static_cast<FrameBufferPool*>(opaque);
+    // NOTE: 只有池中没有空闲缓冲时才会调用这里, 达到上限后拒绝扩容, 由调用方退化为默认分配器
+    if (self->max_bytes_ != 0 &&
+        self->resident_bytes_.load(std::memory_order_relaxed) + size > self->max_bytes_) {
+        return nullptr;
+    }
+    auto base = static_cast<uint8_t*>(av_malloc(size + kPoolBufferHeader));
+    if (!base) {
+        return nullptr;
+    }
+    std::memcpy(base, &size, sizeof(size));
+    AVBufferRef* buffer = av_buffer_create(base + kPoolBufferHeader, size, FreeWrapper, self, 0);
+    if (!buffer) {
+        av_free(base);
+        return nullptr;
+    }
+    auto resident = self->resident_bytes_.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak = self->peak_bytes_.load(std::memory_order_relaxed);
+    while (resident > peak &&
+           !self->peak_bytes_.compare_exchange_weak(peak, resident, std::memory_order_relaxed)) {
+    }
+    self->allocs_.fetch_add(1, std::memory_order_relaxed);
+    return buffer;
+}
+
+void FrameBufferPool::FreeWrapper(void* opaque, uint8_t* data) {
+    auto self = static_cast<FrameBufferPool*>(opaque);
+    auto base = data - kPoolBufferHeader;
+    std::size_t size{0};
+    std::memcpy(&size, base, sizeof(size));
+    self->resident_bytes_.fetch_sub(size, std::memory_order_relaxed);
+    av_free(base);
+}
+
+int FrameBufferPool::FallbackGetBuffer(AVFrame* frame, AVCodecContext* codec_ctx, int flags) {
+    fallbacks_.fetch_add(1, std::memory_order_relaxed);
+    if (codec_ctx) {
+        return avcodec_default_get_buffer2(codec_ctx, frame, flags);
+    }
+    return av_frame_get_buffer(frame, 0);
+}
+
+bool FrameBufferPool::TakeBuffers(AVFrame* frame, int plane, int count) {
+    for (int i = 0; i < count; ++i) {
+        frame->buf[plane + i] = av_buffer_pool_get(pools_[plane]);
+        if (!frame->buf[plane + i]) {
+            for (int j = 0; j < plane + i; ++j) {
+                av_buffer_unref(&frame->buf[j]);
+                frame->data[j] = nullptr;
+            }
+            return false;
+        }
+        frame->data[plane + i] = frame->buf[plane + i]->data;
+    }
+    return true;
+}
+
+int FrameBufferPool::GetVideoBuffer(AVFrame* frame, AVCodecContext* codec_ctx, int flags) {
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    // 硬件帧和调色板格式交给默认分配器
+    if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL)) ||
+        frame->width <= 0 || frame->height <= 0) {
+        return FallbackGetBuffer(frame, codec_ctx, flags);
+    }
+
+    std::lock_guard lk{mtx_};
+    if (format != format_ || frame->width != width_ || frame->height != height_) {
+        // 计算对齐后的行宽和各平面大小 (与 libavcodec 默认分配器的算法一致)
+        int width = frame->width;
+        int height = frame->height;
+        int linesize_align[AV_NUM_DATA_POINTERS];
+        if (codec_ctx) {
+            avcodec_align_dimensions2(codec_ctx, &width, &height, linesize_align);
+        } else {
+            std::fill(std::begin(linesize_align), std::end(linesize_align), kPoolLinesizeAlign);
+        }
+        int linesizes[4]{};
+        int unaligned = 0;
+        do {
+            // NOTE: 不能单独对齐每个平面的行宽, 某些解码器假设 linesize[0] == 2 * linesize[1]
+            int ret = av_image_fill_linesizes(linesizes, format, width);
+            if (ret < 0) {
+                return ret;
+            }
+            width += width & ~(width - 1);  // 提高宽度的对齐度后重试
+            unaligned = 0;
+            for (int i = 0; i < 4; ++i) {
+                unaligned |= linesizes[i] % linesize_align[i];
+            }
+        } while (unaligned);
+
+        ptrdiff_t plane_linesizes[4];
+        std::copy(std::begin(linesizes), std::end(linesizes), plane_linesizes);
+        std::size_t plane_sizes[4]{};
+        int ret = av_image_fill_plane_sizes(plane_sizes, format, height, plane_linesizes);
+        if (ret < 0) {
+            return ret;
+        }
+
+        ResetPools();
+        for (int i = 0; i < 4; ++i) {
+            linesizes_[i] = linesizes[i];
+            if (plane_sizes[i] == 0) {
+                continue;
+            }
+            pool_sizes_[i] = plane_sizes[i] + kPoolBufferPadding;
+            pools_[i] = av_buffer_pool_init2(pool_sizes_[i], this, AllocWrapper, nullptr);
+            if (!pools_[i]) {
+                ResetPools();
+                return AVERROR(ENOMEM);
+            }
+        }
+        format_ = format;
+        width_ = frame->width;
+        height_ = frame->height;
+        rebuilds_.fetch_add(1, std::memory_order_relaxed);
+        LOG_DEBUG("视频帧缓冲池重建: {}x{} {}", width_, height_, av_get_pix_fmt_name(format));
+    }
+
+    for (int i = 0; i < 4 && pools_[i]; ++i) {
+        if (!TakeBuffers(frame, i, 1)) {
+            return FallbackGetBuffer(frame, codec_ctx, flags);
+        }
+        frame->linesize[i] = linesizes_[i];
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+int FrameBufferPool::GetAudioBuffer(AVFrame* frame, AVCodecContext* codec_ctx, int flags) {
+    auto format = static_cast<AVSampleFormat>(frame->format);
+    int channels = frame->ch_layout.nb_channels;
+    int planes = av_sample_fmt_is_planar(format) ? channels : 1;
+    // 平面数超过 AV_NUM_DATA_POINTERS 时需要 extended_buf, 交给默认分配器
+    if (channels <= 0 || planes > AV_NUM_DATA_POINTERS || frame->nb_samples <= 0) {
+        return FallbackGetBuffer(frame, codec_ctx, flags);
+    }
+    int linesize = 0;
+    int ret = av_samples_get_buffer_size(&linesize, channels, frame->nb_samples, format, 0);
+    if (ret < 0) {
+        return ret;
+    }
+
+    std::lock_guard lk{mtx_};
+    if (!pools_[0] || format != format_ || static_cast<std::size_t>(linesize) > pool_sizes_[0]) {
+        ResetPools();
+        pool_sizes_[0] = linesize + kPoolBufferPadding;
+        pools_[0] = av_buffer_pool_init2(pool_sizes_[0], this, AllocWrapper, nullptr);
+        if (!pools_[0]) {
+            return AVERROR(ENOMEM);
+        }
+        format_ = format;
+        rebuilds_.fetch_add(1, std::memory_order_relaxed);
+        LOG_DEBUG("音频帧缓冲池重建: {} 字节/平面 {}", linesize, av_get_sample_fmt_name(format));
+    }
+
+    // 所有声道平面大小相同, 共用同一个池
+    if (!TakeBuffers(frame, 0, planes)) {
+        return FallbackGetBuffer(frame, codec_ctx, flags);
+    }
+    frame->linesize[0] = linesize;
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+void FrameBufferPool::ResetPools() {
+    for (auto& pool : pools_) {
+        av_buffer_pool_uninit(&pool);  // NOTE: 池会在其缓冲全部归还后才真正释放
+    }
+    pool_sizes_.fill(0);
+    linesizes_.fill(0);
+    width_ = 0;
+    height_ = 0;
+    format_ = -1;
+}
+
+FrameBufferPool::Stats FrameBufferPool::GetStats() const {
+    return Stats{resident_bytes_.load(std::memory_order_relaxed),
+                 peak_bytes_.load(std::memory_order_relaxed),
+                 allocs_.load(std::memory_order_relaxed),
+                 fallbacks_.load(std::memory_order_relaxed),
+                 rebuilds_.load(std::memory_order_relaxed)};
 }
 
-std::optional<UniqueAVPacket> PacketQueue::TryPop() {
-    std::unique_lock lk{mtx_};
-    if (queue_.empty()) {
+// =============================================================================
+// PacketQueue 实现
+// =============================================================================
+
+PacketQueue::PacketQueue(std::size_t max_data_bytes, std::size_t capacity)
+    : slots_(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+      serials_(slots_.size(), 0),
+      durations_(slots_.size(), 0),
+      mask_(slots_.size() - 1),
+      max_data_bytes_(max_data_bytes) {}
+
+bool PacketQueue::Push(UniqueAVPacket packet, int serial, AVRational time_base) {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    while (true) {
+        auto seq = can_push_.Prepare();
+        if (closed_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        // 槽位和字节预算都有余量才能写入 (与原实现一致: 未超预算时总能再放入一个包)
+        if (tail - head_.load(std::memory_order_acquire) < slots_.size() &&
+            GetTotalDataSize() < max_data_bytes_) {
+            break;
+        }
+        can_push_.Wait(seq);
+    }
+    // 时长按入队时的时间基换算并记在槽位上, 出队时扣除同一个值
+    int64_t duration = 0;
+    if (time_base.num > 0 && time_base.den > 0 && packet->duration > 0) {
+        duration = av_rescale_q(packet->duration, time_base, AV_TIME_BASE_Q);
+    }
+    pushed_bytes_.fetch_add(static_cast<uint64_t>(packet->size), std::memory_order_release);
+    pushed_duration_.fetch_add(duration, std::memory_order_release);
+    slots_[tail & mask_] = std::move(packet);
+    serials_[tail & mask_] = serial;
+    durations_[tail & mask_] = duration;
+    tail_.store(tail + 1, std::memory_order_release);  // 发布槽位
+    can_pop_.NotifyOne();
+    return true;
+}
+
+std::optional<UniqueAVPacket> PacketQueue::Pop(int* serial) {
+    while (true) {
+        DropCleared();
+        auto seq = can_pop_.Prepare();
+        auto head = head_.load(std::memory_order_relaxed);
+        // NOTE: 先读 closed_ 再读 tail_, 保证关闭前入队的包都能被取出
+        bool closed = closed_.load(std::memory_order_acquire);
+        if (head != tail_.load(std::memory_order_acquire)) {
+            return TakeFront(head, serial);
+        }
+        if (closed) {
+            return std::nullopt;
+        }
+        can_pop_.Wait(seq);
+    }
+}
+
+std::optional<UniqueAVPacket> PacketQueue::TryPop(int* serial) {
+    DropCleared();
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
         return std::nullopt;
     }
-    auto packet{std::move(queue_.front())};
-    queue_.pop();
-    curr_data_bytes_ -= packet->size;
-    duration_ -= packet->duration;
-    cv_can_push_.notify_one();
+    return TakeFront(head, serial);
+}
+
+UniqueAVPacket PacketQueue::TakeFront(uint64_t head, int* serial) {
+    auto packet{std::move(slots_[head & mask_])};
+    if (serial) {
+        *serial = serials_[head & mask_];
+    }
+    popped_bytes_.fetch_add(static_cast<uint64_t>(packet->size), std::memory_order_release);
+    popped_duration_.fetch_add(durations_[head & mask_], std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);  // 归还槽位
+    can_push_.NotifyOne();
     return packet;
 }
 
+void PacketQueue::DropCleared() {
+    auto clear_index = clear_index_.load(std::memory_order_acquire);
+    for (auto head = head_.load(std::memory_order_relaxed); head < clear_index; ++head) {
+        TakeFront(head);  // 返回值析构即释放
+    }
+}
+
 void PacketQueue::Clear() {
-    std::unique_lock lk{mtx_};
-    std::queue<UniqueAVPacket>{}.swap(queue_);
-    curr_data_bytes_ = 0;
-    duration_ = 0;
-    cv_can_push_.notify_all();
+    // 记录当前写索引, 之前入队的包全部作废; 由生产者调用, 写索引与入队累计一致
+    // 作废的包立即不再计入字节数和时长, 不必等消费者释放它们
+    cleared_bytes_.store(pushed_bytes_.load(std::memory_order_relaxed), std::memory_order_release);
+    cleared_duration_.store(pushed_duration_.load(std::memory_order_relaxed),
+                            std::memory_order_release);
+    clear_index_.store(tail_.load(std::memory_order_relaxed), std::memory_order_release);
+    can_push_.NotifyAll();  // 字节预算已空出
 }
 
 void PacketQueue::Close() {
-    std::unique_lock lk{mtx_};
-    if (closed_) {
+    if (closed_.exchange(true, std::memory_order_acq_rel)) {
         return;
     }
-    closed_ = true;
-    cv_can_pop_.notify_all();
-    cv_can_push_.notify_all();
+    can_pop_.NotifyAll();
+    can_push_.NotifyAll();
 }
 
 std::size_t PacketQueue::GetTotalDataSize() const {
-    std::lock_guard lk{mtx_};
-    return curr_data_bytes_;
+    // NOTE: 先读出队/清空累计再读入队累计, 三者单调递增, 保证差值不会为负
+    auto released = std::max(popped_bytes_.load(std::memory_order_acquire),
+                             cleared_bytes_.load(std::memory_order_acquire));
+    return static_cast<std::size_t>(pushed_bytes_.load(std::memory_order_acquire) - released);
+}
+
+std::size_t PacketQueue::GetSize() const {
+    // NOTE: 先读 head 再读 tail, 两者单调递增, 保证差值不会为负
+    auto head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+}
+
+double PacketQueue::GetDuration() const {
+    auto released = std::max(popped_duration_.load(std::memory_order_acquire),
+                             cleared_duration_.load(std::memory_order_acquire));
+    auto duration = pushed_duration_.load(std::memory_order_acquire) - released;
+    return static_cast<double>(duration) / AV_TIME_BASE;
+}
+
+// =============================================================================
+// PcmRingBuffer 实现
+// =============================================================================
+
+void PcmRingBuffer::SetCapacity(std::size_t capacity) {
+    buffer_.assign(std::bit_ceil(std::max<std::size_t>(capacity, 2)), 0);
+    mask_ = buffer_.size() - 1;
+}
+
+bool PcmRingBuffer::Write(const uint8_t* data, std::size_t size) {
+    auto write_pos = write_pos_.load(std::memory_order_relaxed);
+    while (size > 0) {
+        std::size_t free_bytes = 0;
+        while (true) {
+            auto seq = can_write_.Prepare();
+            if (closed_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            // NOTE: 按真实读位置计算空闲空间 (而不是清空位置), 消费者可能仍在拷贝作废的数据
+            free_bytes = buffer_.size() - (write_pos - read_pos_.load(std::memory_order_acquire));
+            if (free_bytes > 0) {
+                break;
+            }
+            can_write_.Wait(seq);
+        }
+        // 环形缓冲末尾可能需要拆成两段拷贝
+        auto offset = write_pos & mask_;
+        auto chunk = std::min({size, free_bytes, buffer_.size() - offset});
+        std::memcpy(buffer_.data() + offset, data, chunk);
+        write_pos += chunk;
+        write_pos_.store(write_pos, std::memory_order_release);  // 发布数据
+        can_read_.NotifyOne();
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+bool PcmRingBuffer::WaitUntilBelow(std::size_t bytes) {
+    while (true) {
+        auto seq = can_write_.Prepare();
+        if (closed_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (GetSize() < bytes) {
+            return true;
+        }
+        can_write_.Wait(seq);
+    }
+}
+
+std::size_t PcmRingBuffer::Read(uint8_t* data, std::size_t size) {
+    const auto old_read_pos = read_pos_.load(std::memory_order_relaxed);
+    auto read_pos = std::max(old_read_pos, clear_pos_.load(std::memory_order_acquire));
+    const auto write_pos = write_pos_.load(std::memory_order_acquire);
+    std::size_t copied = 0;
+    while (copied < size && read_pos < write_pos) {
+        auto offset = read_pos & mask_;
+        auto chunk = std::min({size - copied, static_cast<std::size_t>(write_pos - read_pos),
+                               buffer_.size() - offset});
+        std::memcpy(data + copied, buffer_.data() + offset, chunk);
+        read_pos += chunk;
+        copied += chunk;
+    }
+    if (read_pos != old_read_pos) {
+        read_pos_.store(read_pos, std::memory_order_release);  // 归还空间
+        can_write_.NotifyOne();
+    }
+    return copied;
+}
+
+bool PcmRingBuffer::WaitForData() {
+    while (true) {
+        auto seq = can_read_.Prepare();
+        if (GetSize() > 0) {
+            return true;
+        }
+        if (closed_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        can_read_.Wait(seq);
+    }
+}
+
+void PcmRingBuffer::Clear() {
+    // 记录当前写位置, 之前写入的数据全部作废 (单调递增, 并发 Clear 取较大值)
+    auto write_pos = write_pos_.load(std::memory_order_acquire);
+    auto clear_pos = clear_pos_.load(std::memory_order_relaxed);
+    while (clear_pos < write_pos &&
+           !clear_pos_.compare_exchange_weak(clear_pos, write_pos, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+    }
+    can_write_.NotifyAll();  // 有效数据变少, 唤醒等待水位的生产者
+}
+
+void PcmRingBuffer::Close() {
+    if (closed_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    can_write_.NotifyAll();
+    can_read_.NotifyAll();
+}
+
+std::size_t PcmRingBuffer::GetSize() const {
+    // NOTE: 先读 read 再读 write, 两者单调递增, 保证差值不会为负
+    auto read_pos = GetReadPosition();
+    return write_pos_.load(std::memory_order_acquire) - read_pos;
+}
+
+uint64_t PcmRingBuffer::GetReadPosition() const {
+    return std::max(read_pos_.load(std::memory_order_acquire),
+                    clear_pos_.load(std::memory_order_acquire));
 }
 
 // =============================================================================
@@ -75,7 +526,7 @@ std::size_t PacketQueue::GetTotalDataSize() const {
 // =============================================================================
 
 FrameQueue::FrameQueue(int max_size)
-    : max_size_(std::min(16, max_size)),  // NOTE: 与16比较取小的那个
+    : max_size_(static_cast<std::size_t>(std::clamp(max_size, 1, kMaxFrameQueueCapacity))),
       decoded_frames_(max_size_) {
     for (auto& decoded_frame : decoded_frames_) {
         decoded_frame.frame_.reset(av_frame_alloc());
@@ -86,70 +537,74 @@ FrameQueue::FrameQueue(int max_size)
 }
 
 DecodedFrame* FrameQueue::PeekWritable() {
-    std::unique_lock lk{mtx_};
-    cv_can_write_.wait(lk, [this] { return closed_ || size_ < max_size_; });
-    if (closed_) {
-        return nullptr;
+    const auto windex = windex_.load(std::memory_order_relaxed);
+    while (true) {
+        auto seq = can_write_.Prepare();
+        if (closed_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        if (windex - rindex_.load(std::memory_order_acquire) < max_size_) {
+            return &decoded_frames_[windex % max_size_];
+        }
+        can_write_.Wait(seq);
     }
-    return &decoded_frames_[windex_];
 }
 
 void FrameQueue::MoveWriteIndex() {
-    std::unique_lock lk{mtx_};
-    if (++windex_ == max_size_) {
-        windex_ = 0;
-    }
-    ++size_;
-    cv_can_read_.notify_one();
+    windex_.store(windex_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    can_read_.NotifyOne();
 }
 
 DecodedFrame* FrameQueue::PeekReadable() {
-    std::unique_lock lk{mtx_};
-    cv_can_read_.wait(lk, [this] { return closed_ || size_ > 0; });
-    if (closed_ && size_ == 0) {
-        return nullptr;
+    const auto rindex = rindex_.load(std::memory_order_relaxed);
+    while (true) {
+        auto seq = can_read_.Prepare();
+        // NOTE: 先读 closed_ 再读 windex_, 保证关闭前写入的帧都能被读出
+        bool closed = closed_.load(std::memory_order_acquire);
+        if (windex_.load(std::memory_order_acquire) != rindex) {
+            return &decoded_frames_[rindex % max_size_];
+        }
+        if (closed) {
+            return nullptr;
+        }
+        can_read_.Wait(seq);
     }
-    return &decoded_frames_[rindex_];
 }
 
 // 偏移读索引 rindex
 void FrameQueue::MoveReadIndex() {
-    std::unique_lock lk{mtx_};
-    av_frame_unref(decoded_frames_[rindex_].frame_.get());  // NOTE: 这里会减少引用计数
-    if (++rindex_ == max_size_) {
-        rindex_ = 0;
-    }
-    --size_;
-    cv_can_write_.notify_one();
+    const auto rindex = rindex_.load(std::memory_order_relaxed);
+    av_frame_unref(decoded_frames_[rindex % max_size_].frame_.get());  // NOTE: 这里会减少引用计数
+    rindex_.store(rindex + 1, std::memory_order_release);
+    can_write_.NotifyOne();
 }
 
 std::size_t FrameQueue::GetSize() const {
-    std::lock_guard lk{mtx_};
-    return size_;
+    // NOTE: 先读 rindex 再读 windex, 两者单调递增, 保证差值不会为负
+    auto rindex = rindex_.load(std::memory_order_acquire);
+    return windex_.load(std::memory_order_acquire) - rindex;
 }
 
 void FrameQueue::Close() {
-    std::unique_lock lk{mtx_};
-    if (closed_) {
+    if (closed_.exchange(true, std::memory_order_acq_rel)) {
         return;
     }
-    closed_ = true;
     // 唤醒可能在等待写入的线程 (生产者)
-    cv_can_write_.notify_all();
+    can_write_.NotifyAll();
     // 唤醒可能在等待读取的线程 (消费者)
-    cv_can_read_.notify_all();
+    can_read_.NotifyAll();
 }
 
 void FrameQueue::Clear() {
-    std::unique_lock lk{mtx_};
-    // NOTE: 这里不需要清空环形队列, 因为是循环使用的, 只需要释放对应 AVFrame 的内存即可
-    for (auto& decoded_frame : decoded_frames_) {
-        av_frame_unref(decoded_frame.frame_.get());
+    // NOTE: 这里不需要清空环形队列, 因为是循环使用的, 只需要释放已写入帧的引用并追上写索引
+    // 由消费者调用, 生产者此时最多正在填充 windex 处的槽位, 不会被影响
+    auto rindex = rindex_.load(std::memory_order_relaxed);
+    const auto windex = windex_.load(std::memory_order_acquire);
+    for (; rindex < windex; ++rindex) {
+        av_frame_unref(decoded_frames_[rindex % max_size_].frame_.get());
     }
-    size_ = 0;
-    windex_ = 0;
-    rindex_ = 0;
-    cv_can_write_.notify_all();
+    rindex_.store(windex, std::memory_order_release);
+    can_write_.NotifyAll();
 }
 
 }  // namespace avplayer
\ No newline at end of file
@@ -1,24 +1,60 @@
+#include <algorithm>
 #include <avplayer/logger.hpp>
 #include <avplayer/player.hpp>
+#include <charconv>
 #include <cxxopts.hpp>
 #include <filesystem>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 int main(int argc, char* argv[]) {
     // 1. 设置和解析命令行参数
     cxxopts::Options options(argv[0], "一个基于 SDL2 和 FFmpeg 的简易播放器");
     std::string log_level;
     std::string log_dir;
-    std::string media_file;
+    std::vector<std::string> media_files;
+    avplayer::PlayerOptions player_options;
 
     // clang-format off
     options.add_options()
       ("h,help", "打印帮助信息")
-      ("i,inputfile", "要播放的媒体文件路径", cxxopts::value<std::string>(media_file))
+      ("i,inputfile", "要播放的媒体文件路径, 可给出多个文件或 .m3u/.m3u8 播放列表 (无缝连续播放)", cxxopts::value<std::vector<std::string>>(media_files))
       ("e,loglevel", "设置日志级别 (trace, debug, info, warn, error, critical, off)", cxxopts::value<std::string>()->default_value("info"))
-      ("d,logdir", "设置日志目录", cxxopts::value<std::string>()->default_value("logs"));
+      ("d,logdir", "设置日志目录", cxxopts::value<std::string>()->default_value("logs"))
+      ("buffer-low", "包队列低水位 (秒)", cxxopts::value<double>(player_options.buffer_low_sec)->default_value(std::to_string(avplayer::kMinBufferDuration)))
+      ("buffer-high", "包队列高水位 (秒)", cxxopts::value<double>(player_options.buffer_high_sec)->default_value(std::to_string(avplayer::kMaxBufferDuration)))
+      ("buffer-mb", "两路包队列共享的全局缓冲预算 MB", cxxopts::value<int>()->default_value(std::to_string(avplayer::kMaxBufferDataBytes / 1024 / 1024)))
+      ("frame-pool-mb", "每路流解码帧缓冲池内存上限 MB (0 表示不限制)", cxxopts::value<int>()->default_value("0"))
+      ("q,frame-queue", "视频帧队列深度 (高帧率内容可加大)", cxxopts::value<int>(player_options.frame_queue_size)->default_value(std::to_string(avplayer::kMaxFrameQueueSize)))
+      ("vthreads", "视频解码线程数 (auto 按核数和分辨率自动选择)", cxxopts::value<std::string>()->default_value("auto"))
+      ("vthread-type", "视频解码多线程方式 (auto, frame, slice)", cxxopts::value<std::string>()->default_value("auto"))
+      ("audio-buffer-ms", "PCM 环形缓冲填充目标 (毫秒)", cxxopts::value<int>(player_options.audio_buffer_ms)->default_value(std::to_string(avplayer::kAudioBufferMs)))
+      ("no-seek-index", "不在后台建立关键帧索引 (seek 交给 demuxer 搜索)")
+      ("seek-index-file", "把关键帧索引保存到 <文件名>.avpidx, 下次打开时复用")
+      ("exact-seek", "精确 seek: 第一帧显示的就是目标时刻 (而不是之前的关键帧)")
+      ("no-frame-skip", "视频落后时不让解码器跳帧 (只在显示端丢弃已解码的帧)")
+      ("upload-mode", "视频帧上传纹理的方式 (update, lock, ring; lock/ring 仅用于对比, OpenGL 下多一次拷贝)", cxxopts::value<std::string>()->default_value("update"))
+      ("no-tonemap", "10 位 HDR (PQ/HLG) 内容只截断到 8 位, 不做色调映射")
+      ("no-downscale", "窗口远小于视频时也按原分辨率解码和上传")
+      ("no-vsync-pacing", "不按垂直同步槽位安排视频帧 (直接在目标时刻提交)")
+      ("no-audio-latency-comp", "音频时钟不扣除音频设备延迟 (对比音画偏差用)")
+      ("audio-output-latency-ms", "音频后端在设备缓冲之外的输出延迟 (毫秒, 例如 pactl list sinks 的 Latency), 计入设备延迟", cxxopts::value<double>(player_options.audio_output_latency_ms)->default_value("0"))
+      ("mmap", "本地文件用 mmap 读取 (自定义 AVIOContext, 大缓冲 + madvise 预读), 失败时退回普通读取")
+      ("read-ahead", "异步预读窗口 MB (不带值时为默认窗口, 0 表示经过预读层但不预读)", cxxopts::value<int>(player_options.read_ahead_mb)->default_value("-1")->implicit_value(std::to_string(avplayer::kReadAheadWindowMb)))
+      ("no-io-uring", "预读输入不使用 io_uring (使用线程池 pread)")
+      ("io-throttle-mbps", "模拟慢速存储的带宽 MB/s (测试预读, 隐含经过预读层)", cxxopts::value<double>(player_options.io_throttle_mbps)->default_value("0"))
+      ("io-latency-ms", "模拟慢速存储每个读请求的延迟 (毫秒)", cxxopts::value<double>(player_options.io_latency_ms)->default_value("0"))
+      ("vstream", "选择视频流: 流索引或语言标签 (例如 0, eng), 默认第一路", cxxopts::value<std::string>(player_options.video_stream))
+      ("astream", "选择音频流: 流索引或语言标签 (例如 2, jpn), 默认第一路; 播放时按 A 键切换", cxxopts::value<std::string>(player_options.audio_stream))
+      ("probesize", "流探测最多读取的字节数 (0 表示 FFmpeg 默认 5 MB)", cxxopts::value<int64_t>(player_options.probesize)->default_value("0"))
+      ("analyzeduration", "流探测最多分析的时长 (秒, 0 表示 FFmpeg 默认 5 秒)", cxxopts::value<double>(player_options.analyze_duration)->default_value("0"))
+      ("no-probe-cache", "不使用探测缓存 (每次打开都完整探测流信息)")
+      ("probe-cache-dir", "探测缓存目录 (默认 ~/.cache/avplayer/probe)", cxxopts::value<std::string>(player_options.probe_cache_dir))
+      ("preopen-sec", "播放列表: 读到当前项最后几秒时在后台预先打开下一项", cxxopts::value<double>(player_options.preopen_sec)->default_value(std::to_string(avplayer::kPlaylistPreopenSec)))
+      ("headless", "无界面: 不创建窗口和音频设备, 视频帧和 PCM 输出到空设备")
+      ("no-clock", "不按时钟播放, 帧产出即消费, 结束时输出吞吐和各阶段 CPU 时间 (隐含 --headless)");
     // clang-format on
 
     // 我们需要能够解析位置参数（即没有-f标志的文件名）
@@ -32,7 +68,47 @@ int main(int argc, char* argv[]) {
     }
 
     log_level = result["loglevel"].as<std::string>();
+    player_options.max_buffer_bytes =
+        static_cast<std::size_t>(std::max(1, result["buffer-mb"].as<int>())) * 1024 * 1024;
+    player_options.max_frame_pool_bytes =
+        static_cast<std::size_t>(std::max(0, result["frame-pool-mb"].as<int>())) * 1024 * 1024;
     log_dir = result["logdir"].as<std::string>();
+    player_options.seek_index = !result.count("no-seek-index");
+    player_options.seek_index_sidecar = result.count("seek-index-file") > 0;
+    player_options.exact_seek = result.count("exact-seek") > 0;
+    player_options.frame_skip = !result.count("no-frame-skip");
+    player_options.tonemap = !result.count("no-tonemap");
+    player_options.downscale = !result.count("no-downscale");
+    player_options.vsync_pacing = !result.count("no-vsync-pacing");
+    player_options.audio_latency_comp = !result.count("no-audio-latency-comp");
+    player_options.audio_output_latency_ms = std::max(0.0, player_options.audio_output_latency_ms);
+    player_options.headless = result.count("headless") > 0;
+    player_options.no_clock = result.count("no-clock") > 0;
+    player_options.mmap_io = result.count("mmap") > 0;
+    player_options.io_uring = !result.count("no-io-uring");
+    player_options.probe_cache = !result.count("no-probe-cache");
+    if (auto upload_mode = result["upload-mode"].as<std::string>(); upload_mode == "lock") {
+        player_options.upload_mode = avplayer::UploadMode::kLock;
+    } else if (upload_mode == "ring") {
+        player_options.upload_mode = avplayer::UploadMode::kRing;
+    }
+    if (auto vthreads = result["vthreads"].as<std::string>(); vthreads != "auto") {
+        // 日志系统尚未初始化, 错误直接输出到 stderr; 要求整个参数都是整数 (不接受 "4x")
+        int threads = 0;
+        auto [end, ec] =
+            std::from_chars(vthreads.data(), vthreads.data() + vthreads.size(), threads);
+        if (ec != std::errc{} || end != vthreads.data() + vthreads.size()) {
+            std::cerr << "错误: --vthreads 必须是 auto 或整数, 实际为 \"" << vthreads << "\"\n"
+                      << "使用 " << argv[0] << " --help 查看更多选项" << std::endl;
+            return -1;
+        }
+        player_options.video_decode_threads = std::max(0, threads);
+    }
+    if (auto vthread_type = result["vthread-type"].as<std::string>(); vthread_type == "frame") {
+        player_options.video_thread_type = avplayer::VideoThreadType::kFrame;
+    } else if (vthread_type == "slice") {
+        player_options.video_thread_type = avplayer::VideoThreadType::kSlice;
+    }
 
     // 初始化日志系统
     std::filesystem::path log_file = log_dir + "/" + log_level + ".log";
@@ -42,13 +118,13 @@ int main(int argc, char* argv[]) {
     // 检查核心参数并运行播放器
     if (!result.count("inputfile")) {
         LOG_ERROR("错误: 未指定要播放的媒体文件!");
-        LOG_INFO("用法: {} <文件路径> [选项]", argv[0]);
+        LOG_INFO("用法: {} <文件路径或播放列表>... [选项]", argv[0]);
         LOG_INFO("使用 {} --help 查看更多选项", argv[0]);
         return -1;
     }
 
     try {
-        avplayer::Player player{media_file};
+        avplayer::Player player{avplayer::ExpandPlaylist(media_files), player_options};
         // 在 player.Run() 之前，新增一个事件循环来处理暂停/播放
         // 将事件处理逻辑与 player 内部的渲染循环解耦
         SDL_Event event;
@@ -59,10 +135,18 @@ int main(int argc, char* argv[]) {
                 player.Stop();  // 我们需要在 Player 类中增加这个方法
                 break;
             }
-            // 如果是视频刷新事件，交给播放器处理
-            else if (event.type == avplayer::kFFRefreshEvent) {
-                player.VideoRefreshHandler();
+            // 窗口尺寸变化: 更新显示区域 (并让解码端按新尺寸选择分辨率)
+            else if (event.type == SDL_WINDOWEVENT &&
+                     event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                player.OnWindowResized();
+            }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            // 窗口移动到其他显示器: 按新显示器的刷新率调度
+            else if (event.type == SDL_WINDOWEVENT &&
+                     event.window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED) {
+                player.OnWindowResized();
             }
+#endif
             // 如果是键盘按下事件
             else if (event.type == SDL_KEYDOWN) {
                 if (event.key.keysym.sym == SDLK_SPACE) {
@@ -71,10 +155,13 @@ int main(int argc, char* argv[]) {
                     player.TogglePause();
                 } else if (event.key.keysym.sym == SDLK_LEFT) {
                     LOG_INFO("快退 5 秒");
-                    player.SeekTo(player.GetMasterClock() - 5.0);
+                    player.SeekBy(-5.0);
                 } else if (event.key.keysym.sym == SDLK_RIGHT) {
                     LOG_INFO("快进 5 秒");
-                    player.SeekTo(player.GetMasterClock() + 5.0);
+                    player.SeekBy(5.0);
+                } else if (event.key.keysym.sym == SDLK_a) {
+                    LOG_INFO("切换音频流");
+                    player.CycleAudioStream();
                 }
             }
         }
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <avplayer/logger.hpp>
+#include <avplayer/mmap_io.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace avplayer {
+
+MmapInput::~MmapInput() { Close(); }
+
+bool MmapInput::Open(const std::string& path) {
+    Close();
+#ifdef __linux__
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_WARN("mmap 输入: 打开 {} 失败: {}", path, std::strerror(errno));
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        LOG_WARN("mmap 输入: {} 不是非空的普通文件", path);
+        close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // 映射建立后不再需要文件描述符
+    if (data == MAP_FAILED) {
+        LOG_WARN("mmap 输入: 映射 {} 失败: {}", path, std::strerror(errno));
+        return false;
+    }
+    data_ = static_cast<uint8_t*>(data);
+    size_ = st.st_size;
+    pos_ = 0;
+    madvise(data_, static_cast<std::size_t>(size_), MADV_SEQUENTIAL);
+    ++madvise_calls_;
+    Prefetch(0);
+
+    auto buffer = static_cast<uint8_t*>(av_malloc(kMmapIoBufferSize));
+    if (buffer) {
+        io_ctx_.reset(avio_alloc_context(buffer, kMmapIoBufferSize, 0, this, ReadPacket, nullptr,
+                                         Seek));
+    }
+    if (!io_ctx_) {
+        av_free(buffer);
+        LOG_WARN("mmap 输入: 分配 AVIOContext 失败");
+        Close();
+        return false;
+    }
+    LOG_INFO("mmap 输入: 已映射 {} ({:.1f} MB), 缓冲 {} KB, 预读窗口 {} MB", path,
+             size_ / 1048576.0, kMmapIoBufferSize / 1024, kMmapReadAheadBytes / 1048576);
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void MmapInput::Close() {
+    io_ctx_.reset();
+#ifdef __linux__
+    if (data_) {
+        munmap(data_, static_cast<std::size_t>(size_));
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    pos_ = 0;
+    advised_end_ = 0;
+}
+
+MmapInput::Stats MmapInput::GetStats() const {
+    Stats stats;
+    stats.reads_ = reads_.load();
+    stats.read_bytes_ = read_bytes_.load();
+    stats.seeks_ = seeks_.load();
+    stats.madvise_calls_ = madvise_calls_.load();
+    return stats;
+}
+
+int MmapInput::ReadPacket(void* opaque, uint8_t* buf, int buf_size) {
+    auto self = static_cast<MmapInput*>(opaque);
+    int64_t remaining = self->size_ - self->pos_;
+    if (remaining <= 0) {
+        return AVERROR_EOF;
+    }
+    // 读到预读窗口的后半段: 提前请求下一个窗口, 拷贝时尽量不等待缺页
+    if (self->pos_ + kMmapReadAheadBytes / 2 >= self->advised_end_ &&
+        self->advised_end_ < self->size_) {
+        self->Prefetch(std::max(self->pos_, self->advised_end_));
+    }
+    auto bytes = static_cast<int>(std::min<int64_t>(buf_size, remaining));
+    std::memcpy(buf, self->data_ + self->pos_, static_cast<std::size_t>(bytes));
+    self->pos_ += bytes;
+    self->reads_.fetch_add(1, std::memory_order_relaxed);
+    self->read_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    return bytes;
+}
+
+int64_t MmapInput::Seek(void* opaque, int64_t offset, int whence) {
+    auto self = static_cast<MmapInput*>(opaque);
+    if (whence & AVSEEK_SIZE) {
+        return self->size_;
+    }
+    int64_t target = 0;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = self->pos_ + offset;
+            break;
+        case SEEK_END:
+            target = self->size_ + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+    self->pos_ = target;  // 超出文件末尾时之后的读取返回 EOF
+    self->seeks_.fetch_add(1, std::memory_order_relaxed);
+    if (target < self->size_) {
+        self->Prefetch(target);
+    }
+    return target;
+}
+
+void MmapInput::Prefetch(int64_t offset) {
+    int64_t end = std::min(size_, offset + kMmapReadAheadBytes);
+#ifdef __linux__
+    // madvise 的起始地址必须按页对齐
+    static const int64_t page_size = sysconf(_SC_PAGESIZE);
+    int64_t begin = offset / page_size * page_size;
+    if (end > begin) {
+        madvise(data_ + begin, static_cast<std::size_t>(end - begin), MADV_WILLNEED);
+        madvise_calls_.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+    advised_end_ = end;
+}
+
+}  // namespace avplayer
@@ -1,47 +1,319 @@
+#include <algorithm>
+#include <array>
 #include <avplayer/logger.hpp>
 #include <avplayer/player.hpp>
+#include <avplayer/probe_cache.hpp>
+#include <avplayer/stats.hpp>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 
 // NOTE: 一个 AVPacket 可能对应一个或多个 AVFrame (音频)
 // 但也可能多个 AVPacket 才可以解码出一个 AVFrame (比如: 视频帧间依赖)
 
 namespace avplayer {
 
+namespace {
+
+// 各跳帧级别对应的丢弃策略 (同时用于 skip_frame 和 skip_loop_filter)
+constexpr std::array<AVDiscard, 4> kVideoSkipDiscards{AVDISCARD_DEFAULT, AVDISCARD_NONREF,
+                                                      AVDISCARD_BIDIR, AVDISCARD_NONKEY};
+
+// 各阶段线程的名称 (按 Player::Stage 顺序)
+constexpr std::array<const char*, Player::kStageCount> kStageNames{"读取", "视频解码", "音频解码",
+                                                                   "渲染", "音频输出"};
+
+// 睡眠到绝对时刻 deadline_us (av_gettime_relative 时间轴, 即 CLOCK_MONOTONIC)
+// 绝对时刻睡眠不会因为被信号打断后重新计算相对时长而累积误差
+void SleepUntil(int64_t deadline_us) {
+#ifdef __linux__
+    timespec deadline{};
+    deadline.tv_sec = static_cast<time_t>(deadline_us / 1000000);
+    deadline.tv_nsec = static_cast<long>(deadline_us % 1000000 * 1000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+    }
+#else
+    int64_t remaining_us = deadline_us - av_gettime_relative();
+    if (remaining_us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(remaining_us));
+    }
+#endif
+}
+
+// 流的语言标签 (容器没有标注时为 und)
+const char* GetStreamLanguage(const AVStream* stream) {
+    const AVDictionaryEntry* entry = av_dict_get(stream->metadata, "language", nullptr, 0);
+    return entry ? entry->value : "und";
+}
+
+// 流是否满足选择条件 spec: 全数字为流索引, 否则为语言标签 (不区分大小写)
+bool MatchStream(const AVStream* stream, const std::string& spec) {
+    if (std::all_of(spec.begin(), spec.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return stream->index == std::strtol(spec.c_str(), nullptr, 10);
+    }
+    std::string_view language{GetStreamLanguage(stream)};
+    return std::equal(spec.begin(), spec.end(), language.begin(), language.end(),
+                      [](unsigned char a, unsigned char b) {
+                          return std::tolower(a) == std::tolower(b);
+                      });
+}
+
+// 在 type 类型的流中选择满足 spec 的第一路, spec 为空或没有匹配时退回该类型的第一路
+int SelectStream(const AVFormatContext* format_ctx, AVMediaType type, const std::string& spec) {
+    int first = -1;
+    for (unsigned int i = 0; i < format_ctx->nb_streams; ++i) {
+        const AVStream* stream = format_ctx->streams[i];
+        if (stream->codecpar->codec_type != type) {
+            continue;
+        }
+        if (spec.empty() || MatchStream(stream, spec)) {
+            return static_cast<int>(i);
+        }
+        if (first == -1) {
+            first = static_cast<int>(i);
+        }
+    }
+    if (first != -1) {
+        LOG_WARN("没有与 \"{}\" 匹配的{}流, 使用第一路 (#{})", spec,
+                 type == AVMEDIA_TYPE_VIDEO ? "视频" : "音频", first);
+    }
+    return first;
+}
+
+// 项边界标记: 不带数据的包, opaque_ref 持有一份项的引用 (标记被消费或随 seek 丢弃时随包释放)
+constexpr int kItemMarkerStream = -1;
+
+void FreeItemRef(void* /*opaque*/, uint8_t* data) {
+    delete reinterpret_cast<std::shared_ptr<MediaItem>*>(data);
+}
+
+bool IsItemMarker(const AVPacket* packet) { return packet->stream_index == kItemMarkerStream; }
+
+// 音频重新同步标记: 不带数据的包, 运行时切换音频流后写入音频包队列,
+// 音频解码线程收到后丢弃旧流已解码的采样, 从当前播放位置接上新流 (见 ExecuteAudioSwitch)
+constexpr int kAudioResyncMarkerStream = -2;
+
+bool IsAudioResyncMarker(const AVPacket* packet) {
+    return packet->stream_index == kAudioResyncMarkerStream;
+}
+
+std::shared_ptr<MediaItem> GetMarkerItem(const AVPacket* packet) {
+    return *reinterpret_cast<const std::shared_ptr<MediaItem>*>(packet->opaque_ref->data);
+}
+
+// 记录事件第一次发生的时刻, 返回是否为第一次 (音频回调中调用: 不加锁, 不分配内存)
+bool MarkFirstTime(std::atomic<int64_t>* time_us) {
+    if (time_us->load(std::memory_order_relaxed) != 0) {
+        return false;
+    }
+    int64_t expected = 0;
+    return time_us->compare_exchange_strong(expected, av_gettime_relative());
+}
+
+// 音画偏差测量: 声音起点是连续静音至少 kOnsetSilenceMs 之后第一个幅度达到阈值的采样
+constexpr int kOnsetThreshold = 1000;       // S16 幅度 (约 -30 dBFS)
+constexpr int kOnsetSilenceMs = 200;        // 起点之前至少静音的时长
+constexpr double kOnsetMatchSlack = 0.001;  // 帧的时间戳与起点相同时允许的舍入误差 (秒)
+constexpr double kOnsetMatchWindow = 0.1;   // 对应的帧的时间戳最多晚于起点的时长 (秒)
+
+// 在 S16 交织的 PCM 中查找声音起点, 返回它的字节偏移 (没有时为 -1);
+// *silent_bytes 跨调用累计连续静音的字节数 (音频回调中调用: O(size), 不分配内存)
+int64_t FindOnset(const uint8_t* data, std::size_t size, int64_t silence_bytes,
+                  int64_t* silent_bytes) {
+    for (std::size_t i = 0; i + sizeof(int16_t) <= size; i += sizeof(int16_t)) {
+        int16_t sample;
+        std::memcpy(&sample, data + i, sizeof(sample));
+        if (std::abs(sample) < kOnsetThreshold) {
+            *silent_bytes += sizeof(sample);
+            continue;
+        }
+        bool onset = *silent_bytes >= silence_bytes;
+        *silent_bytes = 0;
+        if (onset) {
+            return static_cast<int64_t>(i);
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
 // =============================================================================
 // Player 实现
 // =============================================================================
 
-Player::Player(std::string file_path)
-    : file_path_(std::move(file_path)),
-      video_packet_queue_(kMaxPacketQueueDataBytes),
-      audio_packet_queue_(kMaxPacketQueueDataBytes),
-      video_frame_queue_(kMaxFrameQueueSize),  // 默认不保留上一帧
+Player::Player(std::string file_path, PlayerOptions options)
+    : Player(std::vector<std::string>{std::move(file_path)}, std::move(options)) {}
+
+Player::Player(std::vector<std::string> playlist, PlayerOptions options)
+    : playlist_(std::move(playlist)),
+      options_(std::move(options)),
+      video_buffer_pool_(options_.max_frame_pool_bytes),
+      audio_buffer_pool_(options_.max_frame_pool_bytes),
+      // NOTE: 单个队列的字节上限只是安全阀 (全局预算的 2 倍), 正常情况下由 ReadLoop 按水位停止读取
+      video_packet_queue_(options_.max_buffer_bytes * 2),
+      audio_packet_queue_(options_.max_buffer_bytes * 2),
+      video_frame_queue_(options_.frame_queue_size),  // 默认不保留上一帧
+      upload_mode_(options_.upload_mode),
+      video_frame_(av_frame_alloc()),
       audio_frame_(av_frame_alloc()) {
+    startup_us_ = av_gettime_relative();
+    if (playlist_.empty()) {
+        throw std::runtime_error("没有要播放的文件");
+    }
+    if (options_.no_clock) {
+        options_.headless = true;
+    }
+    if ((options_.io_throttle_mbps > 0 || options_.io_latency_ms > 0) &&
+        options_.read_ahead_mb < 0) {
+        options_.read_ahead_mb = 0;  // 限速在预读输入中模拟: 不预读, 每次同步读取
+    }
+    if (options_.headless) {
+        // 没有窗口: 不按窗口尺寸降分辨率, 也没有垂直同步
+        options_.downscale = false;
+        options_.vsync_pacing = false;
+    }
+    audio_stream_spec_ = options_.audio_stream;  // 运行时切换音频流后由 ExecuteAudioSwitch 更新
+    // 打开第一项 (读盘和探测, 可能上百毫秒; 以及解码器) 与 SDL 初始化、创建窗口并行;
+    // 窗口留在主线程创建 (部分平台要求), 两者访问的成员互不相交
+    // NOTE: InitSDL 抛出异常时 future 析构会等待打开输入结束, 之后才析构成员
+    auto demuxer_ready = std::async(std::launch::async, [this] { return OpenItem(0, true); });
     InitSDL();
-    OpenInputFile();
-    FindStreams();
-    if (video_stream_idx_ != -1) {
-        OpenStreamComponent(video_stream_idx_);
+    sdl_ready_us_ = av_gettime_relative();
+    item_ = demuxer_ready.get();  // 打开输入失败时在这里重新抛出
+    if (!item_) {
+        throw std::runtime_error("播放列表中没有可以播放的文件");
     }
-    if (audio_stream_idx_ != -1) {
-        OpenStreamComponent(audio_stream_idx_);
+    input_opened_us_ = item_->opened_us_;
+    probed_us_ = item_->probed_us_;
+    probe_cache_hit_ = item_->probe_cache_hit_;
+    discarded_streams_ = item_->discarded_streams_;
+    // 输出 (窗口, 音频设备, 各线程) 按第一项建立, 之后各项必须有同样的视频/音频组合
+    has_video_ = item_->video_stream_idx_ != -1;
+    has_audio_ = item_->audio_stream_idx_ != -1;
+    if (has_video_) {
+        OpenStreamComponent(item_->video_stream_idx_);
     }
+    if (has_audio_) {
+        OpenStreamComponent(item_->audio_stream_idx_);
+    }
+    codecs_opened_us_ = av_gettime_relative();
+    LOG_INFO("视频帧队列深度: {}", video_frame_queue_.GetMaxSize());
     StartThreads();
-    // 手动调度第一次视频刷新
-    ScheduleNextVideoRefresh(40);
 }
 
 Player::~Player() {
     Stop();
+    // 渲染线程在退出前释放纹理和渲染器, 必须先于窗口销毁;
+    // 各线程退出前记录本阶段的 CPU 时间, 全部结束后再输出统计
+    for (auto* thread : {&read_thread_, &video_decode_thread_, &audio_decode_thread_,
+                         &render_thread_, &audio_sink_thread_}) {
+        if (thread->joinable()) {
+            thread->join();
+        }
+    }
+    // 预打开线程访问 Player 的成员 (stop_, 统计, 窗口尺寸): 等它结束后才能析构成员
+    if (next_item_.valid()) {
+        next_item_.wait();
+    }
 
-    // 提前释放与 SDL 相关的资源，再调用 SDL_Quit
-    texture_.reset();
-    renderer_.reset();
+    for (auto type : {AVMEDIA_TYPE_VIDEO, AVMEDIA_TYPE_AUDIO}) {
+        auto stats = GetFrameBufferPoolStats(type);
+        LOG_INFO("{}帧缓冲池统计: 峰值 {:.1f} MB, 驻留 {:.1f} MB, 分配 {}, 退化 {}, 重建 {}",
+                 type == AVMEDIA_TYPE_VIDEO ? "视频" : "音频", stats.peak_bytes_ / 1048576.0,
+                 stats.resident_bytes_ / 1048576.0, stats.allocs_, stats.fallbacks_,
+                 stats.rebuilds_);
+    }
+    if (auto stats = GetSeekStats(); stats.requests_ > 0) {
+        LOG_INFO("Seek 统计: 请求 {}, 执行 {} (合并 {}), 失败 {}, 定位平均 {:.2f} / 最大 {:.2f} ms",
+                 stats.requests_, stats.executed_, stats.requests_ - stats.executed_,
+                 stats.failures_, stats.avg_exec_ms_, stats.max_exec_ms_);
+        LOG_INFO("Seek 统计: 首帧显示 {} 次, 平均 {:.1f} ms / 最大 {:.1f} ms, {:.2f} 次/秒",
+                 stats.shown_, stats.avg_latency_ms_, stats.max_latency_ms_,
+                 stats.shown_per_sec_);
+    }
+
+    if (auto stats = GetPlaylistStats(); stats.items_ > 1) {
+        LOG_INFO("播放列表统计: {} 项, 切换 {} 次, 跳过 {} 项, 间隙 {:.1f} ms / 最大 {:.1f} ms",
+                 stats.items_, stats.transitions_, stats.skipped_items_, stats.last_gap_ms_,
+                 stats.max_gap_ms_);
+    }
+
+    if (auto stats = GetUploadStats(); stats.frames_ > 0) {
+        LOG_INFO("纹理上传统计 ({}): {} 帧, 平均 {:.3f} ms, 最大 {:.3f} ms, 逐行拷贝 {} 帧",
+                 stats.mode_ == UploadMode::kRing   ? "纹理环"
+                 : stats.mode_ == UploadMode::kLock ? "锁定纹理"
+                                                    : "UpdateTexture",
+                 stats.frames_, stats.avg_ms_, stats.max_ms_, stats.strided_frames_);
+    }
+    if (auto stats = GetVsyncStats(); stats.frames_ > 0) {
+        LOG_INFO("垂直同步槽位统计: {:.3f} Hz, {} 帧, 错过 {} 次, 丢弃 {} 帧, 节奏误差平均 "
+                 "{:.3f} ms, 最大 {:.3f} ms, 每帧 1/2/3/4+ 个周期: {}/{}/{}/{}",
+                 stats.refresh_hz_, stats.frames_, stats.missed_, stats.dropped_,
+                 stats.avg_cadence_error_ms_, stats.max_cadence_error_ms_, stats.vsyncs_[0],
+                 stats.vsyncs_[1], stats.vsyncs_[2], stats.vsyncs_[3]);
+    }
+    if (auto stats = GetPresentStats(); stats.frames_ > 0) {
+        LOG_INFO("呈现抖动统计: {} 帧, 平均 {:.3f} ms, 最大 {:.3f} ms", stats.frames_,
+                 stats.avg_jitter_ms_, stats.max_jitter_ms_);
+        const auto& bounds = PresentStats::kBucketUpperUs;
+        for (std::size_t i = 0; i < stats.histogram_.size(); ++i) {
+            std::string range =
+                i == 0               ? fmt::format("< {:.1f} ms", bounds[0] / 1000.0)
+                : i == bounds.size() ? fmt::format(">= {:.1f} ms", bounds[i - 1] / 1000.0)
+                                     : fmt::format("{:.1f} ~ {:.1f} ms", bounds[i - 1] / 1000.0,
+                                                   bounds[i] / 1000.0);
+            LOG_INFO("  {:>16}: {:>8} ({:.1f}%)", range, stats.histogram_[i],
+                     100.0 * static_cast<double>(stats.histogram_[i]) / stats.frames_);
+        }
+    }
+
+    if (auto stats = GetAvSyncStats(); stats.onsets_ > 0) {
+        LOG_INFO("音画偏差统计: {} 个声音起点, 平均 {:+.1f} ms, 绝对值平均 {:.1f} ms / "
+                 "最大 {:.1f} ms (设备延迟 {:.1f} ms, 其中后端输出 {:.1f} ms, {})",
+                 stats.onsets_, stats.avg_offset_ms_, stats.avg_abs_offset_ms_,
+                 stats.max_abs_offset_ms_, stats.device_latency_ms_, stats.output_latency_ms_,
+                 stats.latency_compensated_ ? "已补偿" : "未补偿");
+    }
+
+    if (options_.headless) {
+        auto stats = GetThroughputStats();
+        LOG_INFO("吞吐统计 ({}): {:.2f}s, 视频 {} 帧 {:.1f} fps, 输入 {:.2f} MB/s, "
+                 "图像 {:.1f} MB/s, 音频 {:.1f} 倍速",
+                 options_.no_clock ? "不按时钟" : "按时钟", stats.wall_sec_, stats.video_frames_,
+                 stats.fps_, stats.input_mb_per_sec_, stats.video_mb_per_sec_,
+                 stats.audio_speed_);
+        for (std::size_t i = 0; i < kStageCount; ++i) {
+            double cpu = stats.stage_cpu_sec_[i];
+            if (cpu > 0 && stats.wall_sec_ > 0) {
+                LOG_INFO("  {}线程: CPU {:.2f}s, 占用 {:.1f}%", kStageNames[i], cpu,
+                         cpu / stats.wall_sec_ * 100);
+            }
+        }
+    }
+
+    // 提前释放与 SDL 相关的资源，再调用 SDL_Quit (纹理和渲染器已由渲染线程释放)
     window_.reset();
     SDL_Quit();
 }
 
 void Player::InitSDL() {
+    if (options_.headless) {
+        // 无界面: 不需要显示和音频设备, 只用事件子系统通知主线程播放结束 (SDL_QUIT)
+        if (SDL_Init(SDL_INIT_EVENTS) != 0) {
+            throw std::runtime_error("SDL 初始化失败: " + std::string(SDL_GetError()));
+        }
+        LOG_INFO("SDL 初始化成功 (无界面模式, 视频和音频输出到空设备)!");
+        return;
+    }
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER) != 0) {
         throw std::runtime_error("SDL 初始化失败: " + std::string(SDL_GetError()));
     }
@@ -52,49 +324,111 @@ void Player::InitSDL() {
     if (!window_) {
         throw std::runtime_error("创建窗口失败: " + std::string(SDL_GetError()));
     }
-    // 创建渲染器 (unique_ptr 管理)
-    renderer_.reset(SDL_CreateRenderer(window_.get(), -1,
-                                       SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC));
-    if (!renderer_) {
-        throw std::runtime_error("SDL_CreateRenderer Error: " + std::string(SDL_GetError()));
-    }
+    // NOTE: 渲染器由渲染线程创建 (见 RenderLoop), 这里先按窗口尺寸初始化显示区域
+    SDL_GetWindowSize(window_.get(), &window_width_, &window_height_);
+    display_width_.store(window_width_);
+    display_height_.store(window_height_);
     LOG_INFO("SDL 初始化成功!");
 }
 
-void Player::OpenInputFile() {
-    LOG_INFO("尝试打开输入文件...");
-    AVFormatContext* fmt_ctx{nullptr};
-    if (avformat_open_input(&fmt_ctx, file_path_.c_str(), nullptr, nullptr) < 0) {
-        throw std::runtime_error("打开输入文件失败: " + file_path_);
+void Player::OpenInputFile(MediaItem* item) const {
+    LOG_INFO("尝试打开输入文件: {}", item->path_);
+    item->open_start_us_ = av_gettime_relative();
+    AVFormatContext* fmt_ctx{avformat_alloc_context()};
+    if (!fmt_ctx) {
+        throw std::runtime_error("分配 AVFormatContext 失败");
     }
-    format_ctx_.reset(fmt_ctx);
-    if (avformat_find_stream_info(format_ctx_.get(), nullptr) < 0) {
-        throw std::runtime_error("获取流信息失败");
+    // 自定义 IO: 设置了 pb 后 libavformat 不再打开 file 协议 (也不会释放 pb)
+    // 同时指定时优先使用预读输入, 打开失败时退回 file 协议
+    if (options_.read_ahead_mb >= 0) {
+        ReadAheadInput::Options io_options;
+        io_options.window_blocks =
+            static_cast<int>(static_cast<int64_t>(options_.read_ahead_mb) * 1024 * 1024 /
+                             kReadAheadBlockSize);
+        io_options.io_uring = options_.io_uring;
+        io_options.throttle_mbps = options_.io_throttle_mbps;
+        io_options.latency_ms = options_.io_latency_ms;
+        if (item->read_ahead_input_.Open(item->path_, io_options)) {
+            fmt_ctx->pb = item->read_ahead_input_.GetContext();
+        }
+    } else if (options_.mmap_io && item->mmap_input_.Open(item->path_)) {
+        fmt_ctx->pb = item->mmap_input_.GetContext();
     }
-    LOG_INFO("成功获取流信息!");
-}
-
-void Player::FindStreams() {
-    for (unsigned int i = 0; i < format_ctx_->nb_streams; ++i) {
-        auto stream = format_ctx_->streams[i];
-        if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && video_stream_idx_ == -1) {
-            video_stream_idx_ = i;
+    // 探测上限: 探测读取的字节数和分析的时长 (0 表示 FFmpeg 默认), 同时约束容器头部的读取
+    if (options_.probesize > 0) {
+        fmt_ctx->probesize = options_.probesize;
+    }
+    if (options_.analyze_duration > 0) {
+        fmt_ctx->max_analyze_duration =
+            static_cast<int64_t>(options_.analyze_duration * AV_TIME_BASE);
+    }
+    if (avformat_open_input(&fmt_ctx, item->path_.c_str(), nullptr, nullptr) < 0) {
+        throw std::runtime_error("打开输入文件失败: " + item->path_);
+    }
+    item->format_ctx_.reset(fmt_ctx);
+    item->opened_us_ = av_gettime_relative();
+    // 探测缓存命中时直接写回各流参数, 跳过 avformat_find_stream_info (读取并解码若干帧)
+    ProbeCache probe_cache;
+    bool use_cache =
+        options_.probe_cache && probe_cache.Open(item->path_, options_.probe_cache_dir);
+    item->probe_cache_hit_ = use_cache && probe_cache.Load(fmt_ctx);
+    if (!item->probe_cache_hit_) {
+        if (avformat_find_stream_info(fmt_ctx, nullptr) < 0) {
+            throw std::runtime_error("获取流信息失败");
         }
-        if (stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO && audio_stream_idx_ == -1) {
-            audio_stream_idx_ = i;
+        if (use_cache) {
+            probe_cache.Save(fmt_ctx);
         }
     }
-    if (video_stream_idx_ == -1 && audio_stream_idx_ == -1) {
+    item->probed_us_ = av_gettime_relative();
+    // 播放列表时间轴: 项的起始时间戳和时长 (用于衔接下一项和决定何时预先打开下一项)
+    if (fmt_ctx->start_time != AV_NOPTS_VALUE) {
+        item->start_time_ = static_cast<double>(fmt_ctx->start_time) / AV_TIME_BASE;
+    }
+    if (fmt_ctx->duration > 0) {
+        item->duration_ = static_cast<double>(fmt_ctx->duration) / AV_TIME_BASE;
+    }
+    LOG_INFO("成功获取流信息! 打开 {:.1f} ms, {} {:.1f} ms",
+             (item->opened_us_ - item->open_start_us_) / 1000.0,
+             item->probe_cache_hit_ ? "读取探测缓存" : "探测",
+             (item->probed_us_ - item->opened_us_) / 1000.0);
+}
+
+std::string Player::GetAudioStreamSpec() const {
+    std::lock_guard lk{audio_stream_mtx_};
+    return audio_stream_spec_;
+}
+
+void Player::FindStreams(MediaItem* item) const {
+    AVFormatContext* fmt_ctx = item->format_ctx_.get();
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; ++i) {
+        const AVStream* stream = fmt_ctx->streams[i];
+        const char* type = av_get_media_type_string(stream->codecpar->codec_type);
+        LOG_INFO("流 #{}: {} {} ({})", i, type ? type : "unknown",
+                 avcodec_get_name(stream->codecpar->codec_id), GetStreamLanguage(stream));
+    }
+    item->video_stream_idx_ = SelectStream(fmt_ctx, AVMEDIA_TYPE_VIDEO, options_.video_stream);
+    item->audio_stream_idx_ = SelectStream(fmt_ctx, AVMEDIA_TYPE_AUDIO, GetAudioStreamSpec());
+    if (item->video_stream_idx_ == -1 && item->audio_stream_idx_ == -1) {
         throw std::runtime_error("未找到音频或视频流");
     }
-    LOG_INFO("视频流索引: {}, 音频流索引: {}", video_stream_idx_, audio_stream_idx_);
+    // 未选择的流 (其他音轨, 字幕, 数据流等) 在 demuxer 处直接丢弃: demuxer 跳过它们的包,
+    // 不再读出后由 ReadLoop 释放 (运行时切换音频流时重新启用, 见 ExecuteAudioSwitch)
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; ++i) {
+        if (static_cast<int>(i) != item->video_stream_idx_ &&
+            static_cast<int>(i) != item->audio_stream_idx_) {
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+            ++item->discarded_streams_;
+        }
+    }
+    LOG_INFO("视频流索引: {}, 音频流索引: {}, 在 demuxer 处丢弃 {} 路流", item->video_stream_idx_,
+             item->audio_stream_idx_, item->discarded_streams_);
 }
 
-void Player::OpenStreamComponent(int stream_index) {
-    std::string stream_type = stream_index == video_stream_idx_ ? "视频" : "音频";
+UniqueAVCodecContext Player::OpenDecoder(const AVStream* stream) {
+    const AVCodecParameters* codec_params{stream->codecpar};
+    std::string stream_type = codec_params->codec_type == AVMEDIA_TYPE_VIDEO ? "视频" : "音频";
     LOG_INFO("尝试打开{}流组件...", stream_type);
-    AVStream* stream{format_ctx_->streams[stream_index]};
-    AVCodecParameters* codec_params{stream->codecpar};
 
     // 查找解码器
     const AVCodec* codec{avcodec_find_decoder(codec_params->codec_id)};
@@ -113,6 +447,42 @@ void Player::OpenStreamComponent(int stream_index) {
     if (avcodec_parameters_to_context(codec_context.get(), codec_params) < 0) {
         throw std::runtime_error("拷贝解码器参数至解码器上下文失败");
     }
+    // 安装解码帧缓冲池 (按流的宽高/像素格式复用缓冲, 分辨率变化时自动重建)
+    auto& buffer_pool = codec_context->codec_type == AVMEDIA_TYPE_VIDEO ? video_buffer_pool_
+                                                                        : audio_buffer_pool_;
+    if (!buffer_pool.Install(codec_context.get())) {
+        LOG_INFO("解码器不支持自定义缓冲分配 (DR1), 使用默认分配器");
+    }
+    // 视频解码多线程 (NOTE: 必须在 avcodec_open2 之前设置)
+    if (codec_context->codec_type == AVMEDIA_TYPE_VIDEO) {
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+        // 让解码器把包的 opaque (字节位置, 见 ReadLoop) 原样带到输出帧上
+        codec_context->flags |= AV_CODEC_FLAG_COPY_OPAQUE;
+#endif
+        codec_context->thread_count =
+            options_.video_decode_threads > 0
+                ? options_.video_decode_threads
+                : AutoVideoDecodeThreads(codec_context->width, codec_context->height);
+        switch (options_.video_thread_type) {
+            case VideoThreadType::kFrame:
+                codec_context->thread_type = FF_THREAD_FRAME;
+                break;
+            case VideoThreadType::kSlice:
+                codec_context->thread_type = FF_THREAD_SLICE;
+                break;
+            default:
+                codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+                break;
+        }
+        // 解码器支持 lowres 时 (MJPEG, MPEG-1/2/4 等) 直接按窗口尺寸降低解码分辨率,
+        // 窗口变化后在关键帧处重新打开 (见 DecodeVideoFrame)
+        if (options_.downscale && codec->max_lowres > 0) {
+            codec_context->lowres =
+                std::min(GetDownscaleLevel(codec_params->width, codec_params->height,
+                                           codec_params->sample_aspect_ratio),
+                         static_cast<int>(codec->max_lowres));
+        }
+    }
     // 绑定编解码器和编解码器上下文
     if (avcodec_open2(codec_context.get(), codec, nullptr) < 0) {
         throw std::runtime_error("打开解码器失败");
@@ -120,185 +490,671 @@ void Player::OpenStreamComponent(int stream_index) {
 
     if (codec_context->codec_type == AVMEDIA_TYPE_VIDEO) {
         LOG_INFO("视频流组件打开成功! ");
-        video_stream_ = stream;
-        video_codec_ctx_ = std::move(codec_context);
+        // active_thread_type 为解码器实际启用的方式 (例如码流不支持帧级时退化为片级)
+        LOG_INFO("视频解码线程: {} 个, 方式: {}", codec_context->thread_count,
+                 codec_context->active_thread_type & FF_THREAD_FRAME   ? "帧级"
+                 : codec_context->active_thread_type & FF_THREAD_SLICE ? "片级"
+                                                                       : "单线程");
+        if (codec_context->lowres > 0) {
+            LOG_INFO("视频解码器 lowres = {} (输出 1/{} 分辨率)", codec_context->lowres,
+                     1 << codec_context->lowres);
+        }
+    } else {
+        LOG_INFO("音频流组件打开成功!");
+    }
+    return codec_context;
+}
+
+void Player::OpenStreamComponent(int stream_index) {
+    AVStream* stream{item_->format_ctx_->streams[stream_index]};
+    if (stream_index == item_->video_stream_idx_) {
+        video_item_ = item_;
+        video_codec_ctx_ = std::move(item_->video_codec_ctx_);
+        if (options_.downscale) {
+            video_max_lowres_ = video_codec_ctx_->codec->max_lowres;
+        }
         // NOTE: 在视频组件初始化时, 设置 frame_timer_ 为当前系统时间
         // 相当于为视频时钟校准了一个零点时刻
-        frame_timer_ = static_cast<double>(av_gettime()) / 1000000.0;
-    } else if (codec_context->codec_type == AVMEDIA_TYPE_AUDIO) {
-        LOG_INFO("音频流组件打开成功!");
-        audio_stream_ = stream;
-        audio_codec_ctx_ = std::move(codec_context);
+        frame_timer_ = static_cast<double>(av_gettime_relative()) / 1000000.0;
+        return;
+    }
+    audio_item_ = item_;
+    audio_codec_ctx_ = std::move(item_->audio_codec_ctx_);
+    audio_decoder_stream_idx_ = stream_index;
+    audio_time_base_ = stream->time_base;
+
+    // 音频重采样初始化
+    SDL_AudioSpec wanted_spec, actual_spec;
+    SDL_memset(&wanted_spec, 0, sizeof(wanted_spec));
+
+    AVChannelLayout out_ch_layout;
+    av_channel_layout_default(&out_ch_layout, 2);  // 强制统一为立体声(2声道)
+
+    wanted_spec.freq = audio_codec_ctx_->sample_rate;
+    wanted_spec.format = AUDIO_S16SYS;
+    wanted_spec.channels = out_ch_layout.nb_channels;
+    wanted_spec.silence = 0;
+    wanted_spec.samples = kSdlAudioBufferSize;
+    wanted_spec.callback = AudioCallbackWrapper;
+    wanted_spec.userdata = this;
+
+    // 打开音频设备 (无界面模式: 空音频设备直接接受请求的格式)
+    // NOTE: 只打开一次, 播放列表之后的项和切换的音频流都转换到这里协商的格式
+    if (options_.headless) {
+        actual_spec = wanted_spec;
+        actual_spec.size = wanted_spec.samples * wanted_spec.channels * 2;  // S16
+    } else if (SDL_OpenAudio(&wanted_spec, &actual_spec) < 0) {
+        throw std::runtime_error("SDL_OpenAudio 失败: " + std::string(SDL_GetError()));
+    } else {
+        LOG_INFO("SDL 音频设备启动成功!");
+    }
+    audio_chunk_bytes_ = actual_spec.size;
+    // PCM 环形缓冲: 解码线程填充到 audio_buffer_ms 毫秒, 容量再留出余量容纳整帧写入
+    audio_bytes_per_sec_ = actual_spec.freq * actual_spec.channels * 2;  // S16
+    int frame_bytes = actual_spec.channels * 2;
+    audio_fill_target_bytes_ = static_cast<std::size_t>(
+        static_cast<int64_t>(audio_bytes_per_sec_) * options_.audio_buffer_ms / 1000 /
+        frame_bytes * frame_bytes);
+    audio_fill_target_bytes_ = std::max<std::size_t>(audio_fill_target_bytes_, actual_spec.size);
+    audio_ring_.SetCapacity(audio_fill_target_bytes_ * 2 + actual_spec.size);
+    LOG_INFO("PCM 环形缓冲: 填充目标 {} ms ({} 字节), 容量 {} 字节", options_.audio_buffer_ms,
+             audio_fill_target_bytes_, audio_ring_.GetCapacity());
+    // 回调交出的数据要等设备缓冲中已有的一个缓冲播完, 再经过后端自己的队列才输出
+    // (后者 SDL2 无法查询, 由 --audio-output-latency-ms 给出); 空音频设备取走即视为输出
+    double buffer_latency =
+        options_.headless ? 0 : static_cast<double>(actual_spec.size) / audio_bytes_per_sec_;
+    double output_latency = options_.headless ? 0 : options_.audio_output_latency_ms / 1000.0;
+    audio_device_latency_ = buffer_latency + output_latency;
+    LOG_INFO("音频设备延迟: {:.1f} ms (设备缓冲 {:.1f} ms + 后端输出 {:.1f} ms, {})",
+             audio_device_latency_ * 1000.0, buffer_latency * 1000.0, output_latency * 1000.0,
+             options_.audio_latency_comp ? "主时钟扣除" : "主时钟不扣除");
+    // 输出转换: 按协商结果一次分配缓冲, 并选择直通/SIMD 格式转换/重采样路径
+    audio_spec_ = actual_spec;
+    if (!audio_converter_.Init(audio_spec_, audio_codec_ctx_.get())) {
+        throw std::runtime_error("初始化音频输出转换失败");
+    }
+}
 
-        // 音频重采样初始化
-        SDL_AudioSpec wanted_spec, actual_spec;
-        SDL_memset(&wanted_spec, 0, sizeof(wanted_spec));
+std::shared_ptr<MediaItem> Player::OpenItem(std::size_t index, bool first) {
+    for (; index < playlist_.size() && !stop_.load(); ++index) {
+        auto item = std::make_shared<MediaItem>();
+        item->index_ = index;
+        item->path_ = playlist_[index];
+        try {
+            OpenInputFile(item.get());
+            FindStreams(item.get());
+            bool has_video = item->video_stream_idx_ != -1;
+            bool has_audio = item->audio_stream_idx_ != -1;
+            if (!first && (has_video != has_video_ || has_audio != has_audio_)) {
+                throw std::runtime_error("视频/音频组合与第一项不同");
+            }
+            if (has_video) {
+                item->video_codec_ctx_ = OpenDecoder(item->GetVideoStream());
+            }
+            if (has_audio) {
+                item->audio_codec_ctx_ =
+                    OpenDecoder(item->format_ctx_->streams[item->audio_stream_idx_]);
+                item->decoder_audio_idx_ = item->audio_stream_idx_;
+            }
+            return item;
+        } catch (const std::runtime_error& e) {
+            if (playlist_.size() == 1) {
+                throw;  // 单个文件: 直接报告打开失败
+            }
+            LOG_WARN("跳过播放列表第 {} 项 {}: {}", index + 1, item->path_, e.what());
+            ++skipped_items_;
+        }
+    }
+    return nullptr;
+}
 
-        AVChannelLayout out_ch_layout;
-        av_channel_layout_default(&out_ch_layout, 2);  // 强制统一为立体声(2声道)
+void Player::StartPreopen() {
+    std::size_t index = item_->index_ + 1;
+    LOG_INFO("播放列表: 在后台打开第 {}/{} 项", index + 1, playlist_.size());
+    next_item_ = std::async(std::launch::async, [this, index] {
+        SetCurrentThreadName("preopen");
+        return OpenItem(index, false);
+    });
+}
 
-        wanted_spec.freq = audio_codec_ctx_->sample_rate;
-        wanted_spec.format = AUDIO_S16SYS;
-        wanted_spec.channels = out_ch_layout.nb_channels;
-        wanted_spec.silence = 0;
-        wanted_spec.samples = kSdlAudioBufferSize;
-        wanted_spec.callback = AudioCallbackWrapper;
-        wanted_spec.userdata = this;
+bool Player::AdvancePlaylist() {
+    if (!next_item_.valid()) {
+        if (item_->index_ + 1 >= playlist_.size()) {
+            return false;
+        }
+        StartPreopen();  // 时长未知或读取太快: 读完才开始打开, 切换处可能出现间隙
+    }
+    auto next = next_item_.get();  // 预打开尚未完成时在这里等待
+    if (!next) {
+        return false;  // 之后的项都无法播放
+    }
+    // 时间轴衔接: 下一项的起始时间戳接在当前项主时钟流 (有音频时为音频) 的结束时刻之后,
+    // 时钟和帧的显示时间戳因此连续, 音频按采样首尾相接
+    double end_time =
+        item_->end_time_ > 0 ? item_->end_time_ : item_->start_time_ + item_->duration_;
+    next->offset_ = item_->offset_ + end_time - next->start_time_;
+    LogInputStats(*item_);
+    if (item_->format_ctx_->pb) {
+        io_bytes_base_ += static_cast<uint64_t>(item_->format_ctx_->pb->bytes_read);
+    }
+    LOG_INFO("播放列表: 读取切换到第 {}/{} 项 {} (时间轴偏移 {:.3f}s)", next->index_ + 1,
+             playlist_.size(), next->path_, next->offset_);
+    item_ = std::move(next);
+    discarded_streams_ = item_->discarded_streams_;
+    ReselectAudioStream();
+    read_video_ts_ = AV_NOPTS_VALUE;
+    skip_video_until_ts_ = AV_NOPTS_VALUE;
+    audio_resync_from_ = NAN;
+    // 边界标记之后紧跟下一项的包: 两路包队列不清空, 当前项的尾部播放时下一项已在缓冲中
+    // (包时长在入队时按各自流的时间基换算, 两项的包混在队列中时缓冲时长仍然正确)
+    PushItemMarkers();
+    if (options_.seek_index && has_video_) {
+        std::lock_guard lk{seek_index_mtx_};
+        if (!stop_.load()) {
+            seek_index_.Start(item_->path_, item_->video_stream_idx_,
+                              options_.seek_index_sidecar ? item_->path_ + ".avpidx"
+                                                          : std::string{});
+        }
+    }
+    return true;
+}
 
-        // 打开音频设备
-        if (SDL_OpenAudio(&wanted_spec, &actual_spec) < 0) {
-            throw std::runtime_error("SDL_OpenAudio 失败: " + std::string(SDL_GetError()));
+void Player::PushItemMarkers() {
+    int serial = serial_.load(std::memory_order_relaxed);
+    for (auto [enabled, queue] : {std::pair{has_video_, &video_packet_queue_},
+                                  std::pair{has_audio_, &audio_packet_queue_}}) {
+        if (!enabled) {
+            continue;
         }
-        LOG_INFO("SDL 音频设备启动成功!");
-        // 如果音频格式不是 S16, 则需要重采样
-        if (audio_codec_ctx_->sample_fmt != AV_SAMPLE_FMT_S16) {
-            LOG_INFO("音频格式不是 S16, 需要重采样...");
-            // C++ 的 RAII 智能指针与 C 风格的“出参”函数正确地协同工作: 临时裸指针作为「中间人」
-            SwrContext* tmp_swr_ctx{nullptr};
-            // Setup resampler
-            swr_alloc_set_opts2(&tmp_swr_ctx, &out_ch_layout, AV_SAMPLE_FMT_S16, actual_spec.freq,
-                                &audio_codec_ctx_->ch_layout, audio_codec_ctx_->sample_fmt,
-                                audio_codec_ctx_->sample_rate, 0, nullptr);
-            audio_swr_ctx_.reset(tmp_swr_ctx);  // 立即转移所有权
-            swr_init(audio_swr_ctx_.get());
-            LOG_INFO("音频重采样上下文创建成功!");
+        auto marker = packet_pool_.Acquire();
+        if (!marker) {
+            LOG_ERROR("分配 AVPacket 失败!");
+            continue;
+        }
+        auto* ref = new std::shared_ptr<MediaItem>(item_);
+        marker->opaque_ref = av_buffer_create(reinterpret_cast<uint8_t*>(ref), sizeof(*ref),
+                                              FreeItemRef, nullptr, 0);
+        if (!marker->opaque_ref) {
+            delete ref;
+            LOG_ERROR("分配项边界标记失败!");
+            continue;
         }
+        marker->stream_index = kItemMarkerStream;
+        marker->opaque = nullptr;
+        queue->Push(std::move(marker), serial);
+    }
+}
+
+void Player::ReselectAudioStream() {
+    // 预打开时 (可能早于运行时切换) 选择的音频流与当前的选择不同: 改为丢弃原来的流,
+    // 解码线程收到新流的第一个包时重新打开解码器 (见 DecodeAudioFrame)
+    if (!has_audio_) {
+        return;
+    }
+    AVFormatContext* fmt_ctx = item_->format_ctx_.get();
+    int index = SelectStream(fmt_ctx, AVMEDIA_TYPE_AUDIO, GetAudioStreamSpec());
+    if (index == -1 || index == item_->audio_stream_idx_) {
+        return;
+    }
+    LOG_INFO("播放列表: 沿用切换后的音频流选择, #{} -> #{} ({})", item_->audio_stream_idx_,
+             index, GetStreamLanguage(fmt_ctx->streams[index]));
+    fmt_ctx->streams[item_->audio_stream_idx_]->discard = AVDISCARD_ALL;
+    fmt_ctx->streams[index]->discard = AVDISCARD_DEFAULT;
+    item_->audio_stream_idx_ = index;
+}
+
+void Player::SwitchVideoItem(std::shared_ptr<MediaItem> item) {
+    video_item_ = std::move(item);
+    video_codec_ctx_ = std::move(video_item_->video_codec_ctx_);
+    video_max_lowres_ = options_.downscale ? video_codec_ctx_->codec->max_lowres : 0;
+    LOG_INFO("视频解码器切换到播放列表第 {} 项: {} {}x{}", video_item_->index_ + 1,
+             video_codec_ctx_->codec->name, video_codec_ctx_->width, video_codec_ctx_->height);
+}
+
+void Player::SwitchAudioItem(std::shared_ptr<MediaItem> item, bool record_gap) {
+    if (item == audio_item_) {
+        return;
+    }
+    audio_item_ = std::move(item);
+    audio_codec_ctx_ = std::move(audio_item_->audio_codec_ctx_);
+    audio_decoder_stream_idx_ = audio_item_->decoder_audio_idx_;
+    audio_time_base_ = audio_item_->format_ctx_->streams[audio_decoder_stream_idx_]->time_base;
+    // 音频设备不重新打开: 输入格式与设备一致时转换器继续直通, 否则重采样到设备格式
+    // (转换器初始化失败时已输出错误, 这一项的音频被丢弃)
+    audio_converter_.Init(audio_spec_, audio_codec_ctx_.get());
+    LOG_INFO("音频解码器切换到播放列表第 {} 项: {}, {} Hz, {} 声道 ({})", audio_item_->index_ + 1,
+             audio_codec_ctx_->codec->name, audio_codec_ctx_->sample_rate,
+             audio_codec_ctx_->ch_layout.nb_channels,
+             audio_converter_.GetPath() == AudioConverter::Path::kPassthrough ? "直通"
+             : audio_converter_.GetPath() == AudioConverter::Path::kKernel    ? "格式转换"
+                                                                               : "重采样");
+    // 此刻上一项的采样已全部写入 PCM 缓冲: 到下一项第一个采样写入之前的欠载都是切换间隙
+    audio_gap_underrun_bytes_ =
+        record_gap ? static_cast<int64_t>(audio_underrun_bytes_.load()) : int64_t{-1};
+}
+
+void Player::RecordItemGap(double gap_ms) {
+    auto gap_us = static_cast<int64_t>(gap_ms * 1000.0);
+    ++item_transitions_;
+    item_gap_us_.store(gap_us);
+    item_gap_max_us_ = std::max(item_gap_max_us_.load(), gap_us);
+}
+
+void Player::LogInputStats(const MediaItem& item) const {
+    if (item.read_ahead_input_.GetContext()) {
+        auto io_stats = item.read_ahead_input_.GetStats();
+        LOG_INFO("预读输入统计 ({}): 请求 {} 个 ({:.1f} MB), 队列深度 平均 {:.1f} 最大 {}, "
+                 "读回调 {} 次 (命中 {}), 等待 IO {} 次 共 {:.1f} ms 最长 {:.2f} ms, "
+                 "seek {} 次 (重新定位窗口 {} 次)",
+                 io_stats.backend_, io_stats.requests_, io_stats.request_bytes_ / 1048576.0,
+                 io_stats.avg_queue_depth_, io_stats.max_queue_depth_, io_stats.reads_,
+                 io_stats.hits_, io_stats.stalls_, io_stats.stall_ms_, io_stats.max_stall_ms_,
+                 io_stats.seeks_, io_stats.retargets_);
+    }
+    if (item.mmap_input_.GetContext()) {
+        auto mmap_stats = item.mmap_input_.GetStats();
+        LOG_INFO("mmap 输入统计: 读回调 {} 次 ({:.1f} MB), seek {} 次, madvise {} 次",
+                 mmap_stats.reads_, mmap_stats.read_bytes_ / 1048576.0, mmap_stats.seeks_,
+                 mmap_stats.madvise_calls_);
     }
 }
 
 // 往 VideoPacketQueue 和 AudioPacketQueue 中添加数据包
 void Player::ReadLoop() {
     LOG_INFO("读取线程开始");
+    SetCurrentThreadName("read");
     // NOTE: 只分配一次 AVPacket 内存, 后面复用, 因此需要 unref
     // AVPacket 结构体中有一个 AVBufferRef* 指针, 指向数据缓冲区
     UniqueAVPacket packet_template{av_packet_alloc()};  // 用于循环读取的“模板”
     while (!stop_.load()) {
+        // 切换音频流 (同样只有本线程修改流的 discard 和 audio_stream_idx_)
+        if (audio_switch_pending_.exchange(false)) {
+            ExecuteAudioSwitch();
+        }
+        // 执行 seek 请求: 只有本线程操作 item_, 不需要加锁, 也不会与 av_read_frame 互相等待
+        // NOTE: 连续的请求在这里合并, 只执行最新的目标
+        if (seek_pending_.exchange(false)) {
+            ExecuteSeek(seek_target_.load(), options_.exact_seek);
+        }
+        // 缓冲已满: 不再读取, 限时等待消费者消耗 (而不是阻塞在某一路队列的 Push 上)
+        if (!NeedMorePackets()) {
+            std::unique_lock lk{read_wait_mtx_};
+            // 被 Stop / SeekTo / CycleAudioStream 唤醒 (WakeReadLoop) 后立即回到循环开头处理请求
+            read_wait_cv_.wait_for(lk, std::chrono::milliseconds(10), [this] {
+                return stop_.load() || seek_pending_.load() || audio_switch_pending_.load();
+            });
+            continue;
+        }
         // av_read_frame: 分配新的一个数据包的内存, 并使得 packet 中的数据指针指向它
         // NOTE: 大小可变!!!
-        int ret = 0;
-        {
-            std::lock_guard lk{format_ctx_mtx_};
-            ret = av_read_frame(format_ctx_.get(), packet_template.get());
-        }
+        int64_t read_start_us = av_gettime_relative();
+        AVFormatContext* fmt_ctx = item_->format_ctx_.get();
+        int ret = av_read_frame(fmt_ctx, packet_template.get());
+        int64_t read_us = av_gettime_relative() - read_start_us;
+        read_frame_us_.fetch_add(read_us, std::memory_order_relaxed);
+        read_frame_max_us_.store(std::max(read_frame_max_us_.load(), read_us));
         if (ret < 0) {
             if (ret == AVERROR_EOF) {
-                LOG_INFO("文件读取完毕!");
+                LOG_INFO("文件读取完毕: {}", item_->path_);
             } else {
                 LOG_ERROR("读取数据包失败: {}", av_err2str(ret));
             }
             // NOTE: 不需要unref, 因为ret<0时 av_read_frame内部会做清理工作
+            // 播放列表: 在同一组队列中接着读取下一项
+            if (AdvancePlaylist()) {
+                continue;
+            }
             break;
         }
-        if (packet_template->stream_index == video_stream_idx_ ||
-            packet_template->stream_index == audio_stream_idx_) {
-            // 创建一个新的 AVPacket 用于放入队列
-            UniqueAVPacket packet_to_queue{av_packet_alloc()};
+        read_bytes_.fetch_add(packet_template->size, std::memory_order_relaxed);
+        read_packets_.fetch_add(1, std::memory_order_relaxed);
+        if (fmt_ctx->pb) {
+            io_bytes_.store(io_bytes_base_ + static_cast<uint64_t>(fmt_ctx->pb->bytes_read),
+                            std::memory_order_relaxed);
+        }
+        if (packet_template->stream_index == item_->video_stream_idx_ ||
+            packet_template->stream_index == item_->audio_stream_idx_) {
+            // 从包池取一个 AVPacket 壳用于放入队列 (消费后由删除器归还到池中)
+            auto packet_to_queue = packet_pool_.Acquire();
+            if (!packet_to_queue) {
+                LOG_ERROR("分配 AVPacket 失败!");
+                av_packet_unref(packet_template.get());
+                break;
+            }
             av_packet_move_ref(packet_to_queue.get(), packet_template.get());  // 移动
-            if (packet_to_queue->stream_index == video_stream_idx_) {
-                video_packet_queue_.Push(std::move(packet_to_queue));
+            // 包的字节位置经 opaque 传到解码帧 (DecodedFrame::pos_), +1 使 0 表示未知
+            packet_to_queue->opaque = reinterpret_cast<void*>(
+                static_cast<intptr_t>(packet_to_queue->pos >= 0 ? packet_to_queue->pos + 1 : 0));
+            // 主时钟流 (有音频时为音频) 已读到的结束时刻: 衔接下一项的时间轴,
+            // 读到最后 preopen_sec 秒时在后台打开下一项
+            const AVPacket* pkt = packet_to_queue.get();
+            bool is_video = pkt->stream_index == item_->video_stream_idx_;
+            AVRational time_base = fmt_ctx->streams[pkt->stream_index]->time_base;
+            if (SkipReadPacket(pkt, is_video, time_base)) {
+                continue;  // 包壳随 packet_to_queue 析构归还到池中
+            }
+            if ((has_audio_ ? !is_video : is_video) && pkt->pts != AV_NOPTS_VALUE) {
+                double end_time = static_cast<double>(pkt->pts + pkt->duration) * av_q2d(time_base);
+                item_->end_time_ = std::max(item_->end_time_, end_time);
+                if (!next_item_.valid() && item_->index_ + 1 < playlist_.size() &&
+                    item_->duration_ > 0 &&
+                    end_time >= item_->start_time_ + item_->duration_ - options_.preopen_sec) {
+                    StartPreopen();
+                }
+            }
+            int serial = serial_.load(std::memory_order_relaxed);
+            if (is_video) {
+                video_packet_queue_.Push(std::move(packet_to_queue), serial, time_base);
             } else {
-                audio_packet_queue_.Push(std::move(packet_to_queue));
+                audio_packet_queue_.Push(std::move(packet_to_queue), serial, time_base);
             }
         } else {
-            // 无论是不是需要的流, 都要 unref
+            // 未选择的流已在 demuxer 处丢弃, 这里只剩 demuxer 不支持丢弃的少量包
+            dropped_bytes_.fetch_add(packet_template->size, std::memory_order_relaxed);
+            dropped_packets_.fetch_add(1, std::memory_order_relaxed);
             av_packet_unref(packet_template.get());  // packet 上次的内存块引用计数为0就自动释放
         }
     }
     video_packet_queue_.Close();
     audio_packet_queue_.Close();
+    auto pool_stats = packet_pool_.GetStats();
+    LOG_INFO("AVPacket 池统计: 命中 {}, 未命中 {}, 空闲 {}", pool_stats.hits_, pool_stats.misses_,
+             pool_stats.idle_);
+    auto demux_stats = GetDemuxStats();
+    LOG_INFO("demuxer 统计: 输入 {:.1f} MB, 输出 {} 个包 {:.1f} MB, 其中丢弃 {} 个包 {:.1f} MB, "
+             "{} 路流在 demuxer 处丢弃, 切换音频流 {} 次",
+             demux_stats.io_bytes_ / 1048576.0, demux_stats.demuxed_packets_,
+             demux_stats.demuxed_bytes_ / 1048576.0, demux_stats.dropped_packets_,
+             demux_stats.dropped_bytes_ / 1048576.0, demux_stats.discarded_streams_,
+             demux_stats.audio_switches_);
+    LOG_INFO("av_read_frame 耗时: 共 {:.1f} ms, 最长 {:.2f} ms", demux_stats.read_frame_ms_,
+             demux_stats.max_read_frame_ms_);
+    LogInputStats(*item_);
+    RecordStageCpuTime(Stage::kRead, GetCurrentThreadCpuTime());
     LOG_INFO("读取线程结束");
 }
 
-// 返回的是解码音频数据字节数
-int Player::DecodeAudioFrame() {
-    while (!stop_.load()) {
-        // NOTE: 非阻塞, 不能阻塞 SDL 音频回调, 否则用户会听到清晰可闻的音频爆音/卡顿/断续
-        // 任何情况下, 音频回调函数都必须严格避免任何可能导致阻塞或长时间运行的操作
-        auto packet{audio_packet_queue_.TryPop()};
-        if (!packet) {
-            return 0;  // 静音
+void Player::WakeReadLoop() {
+    {
+        // 读取线程可能已检查完等待条件 (标志尚未设置) 但还没进入等待: 先取得一次锁,
+        // 保证通知发生在它进入等待之后, 否则这次通知丢失, 请求要等限时等待超时才执行
+        std::lock_guard lk{read_wait_mtx_};
+    }
+    read_wait_cv_.notify_all();
+}
+
+bool Player::SkipReadPacket(const AVPacket* packet, bool is_video, AVRational time_base) {
+    if (is_video) {
+        int64_t ts = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+        if (skip_video_until_ts_ != AV_NOPTS_VALUE) {
+            // 切换音频流后从播放位置重新读取: 读到上次的读取位置之前的视频包都已入队
+            if (ts == AV_NOPTS_VALUE || ts <= skip_video_until_ts_) {
+                return true;
+            }
+            skip_video_until_ts_ = AV_NOPTS_VALUE;
+        }
+        if (ts != AV_NOPTS_VALUE) {
+            read_video_ts_ = read_video_ts_ == AV_NOPTS_VALUE ? ts : std::max(read_video_ts_, ts);
         }
+        return false;
+    }
+    // 新流早于播放位置的包: 解码后也听不到
+    if (!isnan(audio_resync_from_) && packet->pts != AV_NOPTS_VALUE) {
+        double end_time = static_cast<double>(packet->pts + packet->duration) * av_q2d(time_base);
+        if (end_time + item_->offset_ <= audio_resync_from_) {
+            return true;
+        }
+        audio_resync_from_ = NAN;
+    }
+    return false;
+}
 
-        // avcodec_send_packet: 异步发送一个 AVPacket 到解码器(解码器内部维护一个 AVPacket 队列)
-        int ret = 0;
-        {
-            std::lock_guard lk{audio_codec_mtx_};
-            ret = avcodec_send_packet(audio_codec_ctx_.get(), packet->get());
+bool Player::NeedMorePackets() {
+    // 某一路缓冲是否达到 seconds 秒 (包没有时长信息时按包数估算)
+    auto has_enough = [](const PacketQueue& queue, double seconds) {
+        double duration = queue.GetDuration();
+        if (duration > 0) {
+            return duration >= seconds;
         }
-        if (ret < 0) {
-            // 对于 EAGAIN，我们什么都不做，直接进入下面的 receive_frame 循环尝试取帧。
-            // 对于其他错误，记录日志并返回错误码。packet 会在函数返回时自动释放。
-            if (ret != AVERROR(EAGAIN)) {
-                LOG_ERROR("音频 avcodec_send_packet EOF/发生错误: {}", av_err2str(ret));
-                return ret;
+        return static_cast<double>(queue.GetSize()) >= kMinBufferPackets * seconds;
+    };
+
+    std::size_t total_bytes = 0;
+    bool starving = false;  // 是否有某一路低于低水位
+    bool all_full = true;   // 是否所有路都达到高水位
+    for (auto [enabled, queue] : {std::pair{has_video_, &video_packet_queue_},
+                                  std::pair{has_audio_, &audio_packet_queue_}}) {
+        if (!enabled) {
+            continue;
+        }
+        total_bytes += queue->GetTotalDataSize();
+        starving = starving || !has_enough(*queue, options_.buffer_low_sec);
+        all_full = all_full && has_enough(*queue, options_.buffer_high_sec);
+    }
+
+    // 任一路低于低水位就必须继续读取, 即使超出全局预算,
+    // 否则一路 (例如 4K 视频) 占满预算会饿死另一路 (音频回调只能输出静音)
+    if (starving) {
+        if (buffering_paused_) {
+            LOG_DEBUG("缓冲低于低水位, 恢复读取 (已缓冲 {:.1f} MB)", total_bytes / 1048576.0);
+        }
+        buffering_paused_ = false;
+        return true;
+    }
+    if (all_full || total_bytes >= options_.max_buffer_bytes) {
+        if (!buffering_paused_) {
+            LOG_DEBUG("缓冲已满, 暂停读取 (视频 {:.2f}s, 音频 {:.2f}s, 共 {:.1f} MB)",
+                      video_packet_queue_.GetDuration(), audio_packet_queue_.GetDuration(),
+                      total_bytes / 1048576.0);
+        }
+        buffering_paused_ = true;
+        return false;
+    }
+    // 介于高低水位之间: 滞回, 暂停读取后直到有一路跌破低水位才恢复
+    return !buffering_paused_;
+}
+
+// 音频解码线程: 提前解码/重采样并写入 PCM 环形缓冲, 直到达到填充目标
+int Player::DecodeAudioFrame() {
+    while (!stop_.load()) {
+        // 缓冲已达到填充目标时等待音频回调消耗
+        // NOTE: 不再在实时回调中解码, 解码耗时的波动被缓冲吸收
+        if (!audio_ring_.WaitUntilBelow(audio_fill_target_bytes_)) {
+            return 0;
+        }
+        LogStartupStats();  // 回调取走数据后缓冲才会降到目标之下: 首个音频采样可能已输出
+        int serial = 0;
+        auto packet{audio_packet_queue_.Pop(&serial)};  // 阻塞式
+        std::shared_ptr<MediaItem> next_item;  // 收到项边界标记: 排空解码器后切换到该项
+        bool flushed = false;                  // 本次取出的是 seek 之后的第一个包
+        if (packet) {
+            // seek 之前入队的过期包: 直接丢弃, 不送入解码器
+            if (serial != serial_.load(std::memory_order_acquire)) {
+                continue;
+            }
+            // seek 之后的第一个包: 在本线程内冲刷解码器和转换器 (不与 seek 线程竞争解码器)
+            if (serial != audio_serial_) {
+                flushed = true;
+                audio_serial_ = serial;
+                avcodec_flush_buffers(audio_codec_ctx_.get());
+                audio_converter_.Reset();  // 丢弃重采样器内部缓存的旧样本
+                audio_ring_.Clear();       // 丢弃阻塞期间写入的旧位置 PCM 数据
+                audio_seek_target_ = serial_exact_.load() ? serial_seek_target_.load() : NAN;
+                audio_gap_underrun_bytes_ = -1;  // 切换途中 seek: 不再统计间隙
+            }
+            if (IsAudioResyncMarker(packet->get())) {
+                // 切换了音频流 (seek 之后的第一个包是标记时, 上面已按 seek 目标冲刷)
+                if (!flushed) {
+                    ResyncAudio();
+                }
+                continue;
             }
+            if (IsItemMarker(packet->get())) {
+                next_item = GetMarkerItem(packet->get());
+                if (next_item == audio_item_) {
+                    continue;  // seek 之后重新写入的标记: 仍是当前项
+                }
+            } else if (packet->get()->stream_index != audio_decoder_stream_idx_ &&
+                       !ReopenAudioDecoder(packet->get()->stream_index)) {
+                // 切换音频流后的第一个包: 按新流的参数重新打开解码器 (失败时丢弃该流的包)
+                continue;
+            }
+        }
+        // avcodec_send_packet: 异步发送一个 AVPacket 到解码器(解码器内部维护一个 AVPacket 队列)
+        // 队列已关闭 (EOF) 或当前项结束时发送 null packet 冲刷解码器
+        int ret = avcodec_send_packet(audio_codec_ctx_.get(),
+                                      packet && !next_item ? packet->get() : nullptr);
+        // 对于 EAGAIN，我们什么都不做，直接进入下面的 receive_frame 循环尝试取帧。
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
+            LOG_ERROR("音频 avcodec_send_packet 发生错误: {}", av_err2str(ret));
         }
 
         // 循环调用 avcodec_receive_frame 以获取所有可能产生的帧 (0,1,...)
         while (!stop_.load()) {
-            ret = 0;
-            {
-                std::lock_guard lk{audio_codec_mtx_};
-                ret = avcodec_receive_frame(audio_codec_ctx_.get(), audio_frame_.get());
-            }
+            ret = avcodec_receive_frame(audio_codec_ctx_.get(), audio_frame_.get());
             if (ret < 0) {
                 if (ret == AVERROR(EAGAIN)) {  // 需要更多 packet
                     break;
-                } else {  // 解码结束或致命错误
-                    LOG_ERROR("音频 avcodec_receive_frame EOF/发生错误: {}", av_err2str(ret));
-                    av_frame_unref(audio_frame_.get());  // 清空 frame 的引用计数
+                } else if (ret == AVERROR_EOF) {  // 解码器已完全冲刷
+                    if (next_item) {
+                        break;  // 当前项的帧已全部取出, 切换到下一项 (见下)
+                    }
+                    LOG_INFO("音频解码器冲刷完毕!");
+                    return 0;
+                } else {  // 致命错误
+                    LOG_ERROR("音频 avcodec_receive_frame 发生错误: {}", av_err2str(ret));
                     return -1;
                 }
             }
-            // 正常情况
-            int data_bytes{0};
-            auto in = static_cast<uint8_t* const*>(audio_frame_.get()->extended_data);
-            int in_count = audio_frame_.get()->nb_samples;
-            // 256 是一个安全余量, 因为重采样过程中可能会有轻微的延迟和缓存,
-            // 导致输出样本数略多于输入
-            int out_count = audio_frame_.get()->nb_samples + 256;
-
-            // 重采样后输出缓冲区大小 = 2 * 2 * audio_frame_.nb_samples
-            int out_size =
-                av_samples_get_buffer_size(nullptr, audio_frame_.get()->ch_layout.nb_channels,
-                                           out_count, AV_SAMPLE_FMT_S16, 0);
-            // 重新分配 audio_buffer_ 内存
-            audio_buffer_.resize(out_size);
-            auto out = audio_buffer_.data();
-
-            // 重采样 -> 返回每个通道的样本数
-            int nb_ch_samples = swr_convert(audio_swr_ctx_.get(), &out, out_count, in, in_count);
-
-            // NOTE: 计算解码后的音频数据字节数
-            // 每个通道的样本数 * 通道数 * 每个样本的字节数(S16=2字节)
-            data_bytes = nb_ch_samples * audio_frame_.get()->ch_layout.nb_channels *
-                         av_get_bytes_per_sample(AV_SAMPLE_FMT_S16);
-
-            // NOTE: 更新音频时钟!!!  = pts + 持续时长
+            // 精确 seek: 丢弃完全落在目标之前的音频帧, 让音频时钟从目标处开始
+            if (!isnan(audio_seek_target_)) {
+                const AVFrame* audio_frame = audio_frame_.get();
+                if (audio_frame->pts != AV_NOPTS_VALUE &&
+                    audio_frame->pts * av_q2d(audio_time_base_) + audio_item_->offset_ +
+                            static_cast<double>(audio_frame->nb_samples) /
+                                audio_frame->sample_rate <=
+                        audio_seek_target_) {
+                    av_frame_unref(audio_frame_.get());
+                    continue;
+                }
+                audio_seek_target_ = NAN;
+            }
+
+            // 播放列表切换后的第一帧: 上一项的最后一个采样写入之后,
+            // 音频设备因缓冲取空而输出的静音就是两项之间的间隙
+            if (audio_gap_underrun_bytes_ >= 0) {
+                auto gap_bytes = static_cast<int64_t>(audio_underrun_bytes_.load()) -
+                                 audio_gap_underrun_bytes_;
+                audio_gap_underrun_bytes_ = -1;
+                double gap_ms = gap_bytes * 1000.0 / std::max(audio_bytes_per_sec_, 1);
+                LOG_INFO("播放列表切换: 音频间隙 {:.1f} ms", gap_ms);
+                RecordItemGap(gap_ms);
+            }
+
+            // 正常情况: 转换为 S16 交织并写入 PCM 环形缓冲 (空间不足时阻塞)
+            // NOTE: 输出缓冲在初始化时一次分配, 整个过程不分配内存
+            audio_converter_.Begin(audio_frame_.get());
+            const uint8_t* data{nullptr};
+            while (auto data_bytes = audio_converter_.Next(&data)) {
+                if (!audio_ring_.Write(data, data_bytes)) {
+                    av_frame_unref(audio_frame_.get());
+                    return 0;  // 缓冲已关闭
+                }
+            }
+
+            // NOTE: 记录写入进度 = pts + 持续时长
+            // 对应的是环形缓冲当前写位置, 回调交出数据时再按字节数回推 (见 AudioCallback)
             if (audio_frame_.get()->pts != AV_NOPTS_VALUE) {
                 // 获取音频流的时间基
-                AVRational time_base = audio_stream_->time_base;
+                AVRational time_base = audio_time_base_;
 
                 // 计算当前帧的持续时长 (秒) = 样本数 / 采样率
                 auto duration = static_cast<double>(audio_frame_.get()->nb_samples) /
                                 audio_frame_.get()->sample_rate;
 
-                {
-                    std::lock_guard lk{clock_mtx_};
-                    // 将 pts 转换为秒，然后加上持续时长
-                    audio_clock_ = audio_frame_.get()->pts * av_q2d(time_base) + duration;
-                }
+                // 将 pts 转换为秒，然后加上持续时长 (再换算到播放列表时间轴)
+                audio_written_.Store({audio_frame_.get()->pts * av_q2d(time_base) + duration +
+                                          audio_item_->offset_,
+                                      audio_ring_.GetWritePosition(), audio_serial_});
             } else {
-                std::lock_guard lk{clock_mtx_};
-                audio_clock_ = NAN;
+                audio_written_.Store({NAN, audio_ring_.GetWritePosition(), audio_serial_});
             }
             av_frame_unref(audio_frame_.get());  // 清空 frame 的引用计数
-            return data_bytes;
+        }
+        if (next_item) {
+            // 重采样器内部缓存的最后几毫秒样本也属于当前项, 下一项的第一个采样紧接在它们之后
+            audio_converter_.BeginDrain();
+            const uint8_t* data{nullptr};
+            while (auto data_bytes = audio_converter_.Next(&data)) {
+                if (!audio_ring_.Write(data, data_bytes)) {
+                    return 0;  // 缓冲已关闭
+                }
+            }
+            // seek 之后重新写入的标记 (读取已领先到下一项): 不是连续播放的切换, 不统计间隙
+            SwitchAudioItem(std::move(next_item), !flushed);
+            continue;
+        }
+        if (!packet) {
+            return 0;  // 已冲刷且没有更多帧
         }
     }
     return 0;
 }
 
+void Player::ResyncAudio() {
+    // 下一个写入的采样排在设备缓冲中的数据之后输出: 它的时间戳是当前听到的位置加设备延迟
+    double position = GetAudioClock() + audio_device_latency_;
+    avcodec_flush_buffers(audio_codec_ctx_.get());
+    audio_converter_.Reset();
+    audio_ring_.Clear();  // 丢弃旧流已写入但尚未播放的 PCM 数据
+    audio_written_.Store({position, audio_ring_.GetWritePosition(), audio_serial_});
+    audio_seek_target_ = position;   // 新流从这里开始, 之前的帧解码后丢弃
+    audio_gap_underrun_bytes_ = -1;  // 切换项途中切换音频流: 不再统计间隙
+}
+
+bool Player::ReopenAudioDecoder(int stream_index) {
+    const AVStream* stream = audio_item_->format_ctx_->streams[stream_index];
+    const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    UniqueAVCodecContext codec_context{codec ? avcodec_alloc_context3(codec) : nullptr};
+    if (!codec_context ||
+        avcodec_parameters_to_context(codec_context.get(), stream->codecpar) < 0) {
+        LOG_WARN("切换音频流失败: 创建流 #{} 的解码器上下文失败", stream_index);
+        return false;
+    }
+    audio_buffer_pool_.Install(codec_context.get());
+    if (avcodec_open2(codec_context.get(), codec, nullptr) < 0) {
+        LOG_WARN("切换音频流失败: 打开流 #{} 的解码器失败", stream_index);
+        return false;
+    }
+    // 音频设备保持首次协商的输出格式, 只按新流的输入格式重新选择转换路径
+    if (!audio_converter_.Init(audio_spec_, codec_context.get())) {
+        LOG_WARN("切换音频流失败: 流 #{} 无法转换到输出格式", stream_index);
+        audio_converter_.Init(audio_spec_, audio_codec_ctx_.get());  // 恢复原来的流的转换路径
+        return false;
+    }
+    LOG_INFO("音频解码器切换到流 #{}: {}, {} Hz, {} 声道", stream_index, codec->name,
+             codec_context->sample_rate, codec_context->ch_layout.nb_channels);
+    audio_codec_ctx_ = std::move(codec_context);
+    audio_decoder_stream_idx_ = stream_index;
+    audio_time_base_ = stream->time_base;
+    return true;
+}
+
+void Player::AudioDecodeLoop() {
+    LOG_INFO("音频解码线程开始!");
+    SetCurrentThreadName("adecode");
+    if (DecodeAudioFrame() < 0) {
+        LOG_ERROR("音频帧解码失败!");
+    }
+    // NOTE: 关闭 PCM 缓冲后剩余数据仍可读出, 回调播放完之后输出静音
+    audio_decode_finished_.store(true);
+    audio_ring_.Close();
+    RecordStageCpuTime(Stage::kAudioDecode, GetCurrentThreadCpuTime());
+    auto stats = GetAudioStats();
+    LOG_INFO("音频解码线程结束! 欠载 {} 次, 共缺 {:.1f} ms", stats.underruns_,
+             stats.underrun_bytes_ * 1000.0 / std::max(audio_bytes_per_sec_, 1));
+}
+
 // 音频回调函数(由 SDL 创建线程)
 // userdata: 用户数据
 // stream: 音频数据流(注意: 音频设备从该流中获取数据)
@@ -309,70 +1165,209 @@ void Player::AudioCallbackWrapper(void* userdata, uint8_t* stream, int len) {
 
 // stream: 音频数据流(注意: 音频设备从该流中获取数据)
 // len: 需要填充的数据长度
+// NOTE: 实时线程, 只从 PCM 环形缓冲拷贝数据 (O(len) memcpy), 不解码、不加锁、不分配内存
 void Player::AudioCallback(uint8_t* stream, int len) {
-    std::memset(stream, 0, len);  // 安全措施: 静音填充
-
-    // 还需要 len 字节的数据
-    while (len > 0) {
-        // 已经发送我们所有的数据，需要获取更多数据
-        if (audio_buffer_index_ >= audio_buffer_size_) {
-            int decoded_size = DecodeAudioFrame();
-            if (decoded_size <= 0) {
-                // Error/EOF
-                return;
+    double now = static_cast<double>(av_gettime_relative()) / 1000000.0;
+    auto copied = audio_ring_.Read(stream, static_cast<std::size_t>(len));
+    if (copied > 0) {
+        MarkFirstTime(&first_audio_us_);
+    }
+    // 更新音频时钟: 本次交出的第一个采样 (欠载时为停住的读位置) 的时间戳由写入进度按字节数回推,
+    // 它要等设备缓冲中已有的数据播完才输出, 此刻正在输出的采样还要再早一个设备延迟;
+    // 解码结束且已读完时不再更新, 时钟按系统时间继续走 (剩余的视频帧照常同步)
+    if (copied > 0 || !audio_decode_finished_.load()) {
+        auto written = audio_written_.Load();
+        uint64_t start_pos = audio_ring_.GetReadPosition() - copied;
+        auto pending = static_cast<int64_t>(written.pos_ - start_pos);
+        double pts = written.pts_ - static_cast<double>(pending) / audio_bytes_per_sec_;
+        audio_clock_.Set(pts - audio_device_latency_, now, written.serial_);
+        // 声音起点: 记录它的时间戳和实际输出的时刻 (交出时刻 + 设备延迟 + 在本次数据中的偏移),
+        // 渲染线程与显示同一时间戳的帧比较 (见 MeasureAvOffset)
+        if (has_video_ && copied > 0) {
+            int64_t silence_bytes = int64_t{audio_bytes_per_sec_} * kOnsetSilenceMs / 1000;
+            int64_t onset = FindOnset(stream, copied, silence_bytes, &audio_silent_bytes_);
+            if (onset >= 0 && !isnan(pts)) {
+                double offset = static_cast<double>(onset) / audio_bytes_per_sec_;
+                audio_onset_.Store(
+                    {pts + offset, now + audio_device_latency_ + offset, written.serial_});
             }
-            audio_buffer_size_ = decoded_size;
-            audio_buffer_index_ = 0;
         }
+    }
+    if (copied == static_cast<std::size_t>(len)) {
+        return;
+    }
+    std::memset(stream + copied, 0, len - copied);  // 不足部分静音填充
+    // 起播前 (尚未读到过数据) 和解码结束后的静音不算欠载
+    if (audio_ring_.GetReadPosition() > 0 && !audio_decode_finished_.load()) {
+        audio_underruns_.fetch_add(1, std::memory_order_relaxed);
+        audio_underrun_bytes_.fetch_add(len - copied, std::memory_order_relaxed);
+    }
+}
 
-        int len_to_copy = std::min(len, static_cast<int>(audio_buffer_size_ - audio_buffer_index_));
-        std::memcpy(stream, audio_buffer_.data() + audio_buffer_index_, len_to_copy);
-
-        len -= len_to_copy;
-        stream += len_to_copy;
-        audio_buffer_index_ += len_to_copy;
+void Player::NullAudioLoop() {
+    LOG_INFO("空音频设备线程开始!");
+    SetCurrentThreadName("asink");
+    std::vector<uint8_t> buffer(audio_chunk_bytes_);
+    // 按时钟时每次取走一个设备缓冲, 与 SDL 音频回调的粒度和节奏相同
+    const int64_t chunk_us =
+        static_cast<int64_t>(audio_chunk_bytes_) * 1000000 / std::max(audio_bytes_per_sec_, 1);
+    int64_t deadline_us = av_gettime_relative();
+    while (!stop_.load()) {
+        if (options_.no_clock) {
+            // 不按时钟: 有数据就全部读走, 解码结束且已读完时退出
+            if (!audio_ring_.WaitForData()) {
+                break;
+            }
+            if (audio_ring_.Read(buffer.data(), buffer.size()) > 0) {
+                MarkFirstTime(&first_audio_us_);
+            }
+            continue;
+        }
+        auto seq = render_signal_.Prepare();
+        if (paused_.load()) {
+            render_signal_.Wait(seq);
+            deadline_us = av_gettime_relative();
+            continue;
+        }
+        if (audio_decode_finished_.load() && audio_ring_.GetSize() == 0) {
+            break;
+        }
+        AudioCallback(buffer.data(), static_cast<int>(buffer.size()));
+        // 落后超过一个缓冲 (例如机器过载) 时以当前时刻为新基准, 不连续追赶
+        deadline_us = std::max(deadline_us + chunk_us, av_gettime_relative() - chunk_us);
+        SleepUntil(deadline_us);
+    }
+    // 没有视频时由音频输出结束整个播放
+    if (!has_video_ && !stop_.exchange(true)) {
+        MarkPlaybackEnd();
+        SDL_Event event;
+        event.type = SDL_QUIT;
+        SDL_PushEvent(&event);
     }
+    RecordStageCpuTime(Stage::kAudioOutput, GetCurrentThreadCpuTime());
+    LOG_INFO("空音频设备线程结束!");
 }
 
 void Player::StartThreads() {
-    read_thread_ = std::jthread{[this] { ReadLoop(); }};                 // 启动读取线程
-    video_decode_thread_ = std::jthread{[this] { VideoDecodeLoop(); }};  // 启动视频解码线程
-    SDL_PauseAudio(0);                                                   // 启动音频回调
+    // 渲染线程先创建渲染器: 视频格式转换需要知道渲染器原生支持的纹理格式
+    std::promise<void> renderer_ready;
+    render_thread_ = std::jthread{[this, &renderer_ready] { RenderLoop(&renderer_ready); }};
+    renderer_ready.get_future().get();  // 创建失败时抛出 std::runtime_error
+    if (has_video_) {
+        // 像素格式转换: 优先使用渲染器原生支持的纹理格式, 否则 swscale (与解码同样的线程数)
+        video_converter_.Init(renderer_formats_, video_codec_ctx_->thread_count,
+                              options_.tonemap);
+    }
+    if (options_.seek_index && has_video_) {
+        // 启动后台关键帧索引线程 (读取切换到播放列表的下一项时重新建立)
+        seek_index_.Start(item_->path_, item_->video_stream_idx_,
+                          options_.seek_index_sidecar ? item_->path_ + ".avpidx" : std::string{});
+    }
+    playback_start_us_ = av_gettime_relative();
+    read_thread_ = std::jthread{[this] { ReadLoop(); }};  // 启动读取线程
+    if (has_video_) {
+        video_decode_thread_ = std::jthread{[this] { VideoDecodeLoop(); }};  // 启动视频解码线程
+    }
+    if (has_audio_) {
+        audio_decode_thread_ = std::jthread{[this] { AudioDecodeLoop(); }};  // 启动音频解码线程
+    }
+    if (options_.headless) {
+        if (has_audio_) {
+            audio_sink_thread_ = std::jthread{[this] { NullAudioLoop(); }};  // 启动空音频设备
+        }
+    } else {
+        SDL_PauseAudio(0);  // 启动音频回调
+    }
 }
 
 int Player::DecodeVideoFrame() {
-    UniqueAVFrame frame{av_frame_alloc()};
-    auto frame_rate = video_stream_->avg_frame_rate;  // 帧率
+    auto& frame = video_frame_;  // 复用的 AVFrame, 图像缓冲来自 video_buffer_pool_
     while (!stop_.load()) {
-        auto packet = video_packet_queue_.Pop();  // 阻塞式
-        if (packet) {                             // 成功获取到包
-            int ret = 0;
-            {
-                std::lock_guard lk{video_codec_mtx_};
-                ret = avcodec_send_packet(video_codec_ctx_.get(), packet->get());
+        const AVStream* stream = video_item_->GetVideoStream();  // 解码器当前对应的流
+        auto frame_rate = stream->avg_frame_rate;                // 帧率
+        int serial = 0;
+        auto packet = video_packet_queue_.Pop(&serial);  // 阻塞式
+        std::shared_ptr<MediaItem> next_item;  // 收到项边界标记: 排空解码器后切换到该项
+        if (packet) {  // 成功获取到包
+            // seek 之前入队的过期包: 直接丢弃, 不送入解码器
+            if (serial != serial_.load(std::memory_order_acquire)) {
+                continue;
+            }
+            // seek 之后的第一个包: 在本线程内冲刷解码器 (不与 seek 线程竞争解码器)
+            if (serial != video_serial_) {
+                video_serial_ = serial;
+                avcodec_flush_buffers(video_codec_ctx_.get());
+                video_seek_target_ = serial_exact_.load() ? serial_seek_target_.load() : NAN;
+                video_seek_dropped_ = 0;
+                video_skip_window_start_us_ = 0;  // seek 前的落后统计不再有意义, 重新开始评估
+                // 依赖 seek 后解码出的实际时间戳重建时钟
+                video_clock_.Set(NAN, static_cast<double>(av_gettime_relative()) / 1000000.0,
+                                 serial);
+            }
+            if (IsItemMarker(packet->get())) {
+                next_item = GetMarkerItem(packet->get());
+                if (next_item == video_item_) {
+                    continue;  // seek 之后重新写入的标记: 仍是当前项
+                }
+            }
+        }
+        if (next_item) {
+            // 冲刷解码器, 取出当前项剩余的帧 (帧级多线程时还有若干帧在解码器内部)
+            avcodec_send_packet(video_codec_ctx_.get(), nullptr);
+        } else if (packet) {
+            if (options_.frame_skip) {
+                UpdateVideoSkipLevel();
             }
+            // 窗口尺寸变化后, 在关键帧处以新的 lowres 重新打开解码器 (关键帧不依赖之前的帧)
+            // NOTE: 解码器内部尚未输出的几帧 (帧级多线程的延迟) 随旧的上下文丢弃
+            if (video_max_lowres_ > 0 && (packet->get()->flags & AV_PKT_FLAG_KEY)) {
+                const AVCodecParameters* par = stream->codecpar;
+                int lowres = std::min(
+                    GetDownscaleLevel(par->width, par->height, par->sample_aspect_ratio),
+                    video_max_lowres_);
+                if (lowres != video_codec_ctx_->lowres && !ReopenVideoDecoder(lowres)) {
+                    video_max_lowres_ = 0;  // 重新打开失败: 不再尝试, 之后只用预缩放
+                }
+            }
+            AVDiscard discard = kVideoSkipDiscards[video_skip_level_.load()];
+            video_codec_ctx_->skip_loop_filter = discard;
+            if (!isnan(video_seek_target_)) {
+                // 精确 seek 追赶中: 目标之前的非参考帧既不显示也不被其他帧参考,
+                // 让解码器直接跳过
+                const AVPacket* pkt = packet->get();
+                bool before_target = pkt->pts != AV_NOPTS_VALUE &&
+                                     (pkt->pts + pkt->duration) * av_q2d(stream->time_base) +
+                                             video_item_->offset_ <=
+                                         video_seek_target_;
+                if (before_target) {
+                    discard = std::max(discard, AVDISCARD_NONREF);
+                }
+            }
+            video_codec_ctx_->skip_frame = discard;
+            ++video_skip_window_packets_;
+            int64_t start_us = av_gettime_relative();
+            int ret = avcodec_send_packet(video_codec_ctx_.get(), packet->get());
+            video_decode_busy_us_ += av_gettime_relative() - start_us;
             if (ret < 0) {
                 LOG_ERROR("视频 avcodec_send_packet 发生错误: {}", av_err2str(ret));
                 // 即使发送失败，也尝试继续解码，可能只是需要先 receive
             }
         } else {  // 如果返回空指针, 说明队列已关闭, 这是来自 ReadLoop 的 EOF 信号
             LOG_INFO("视频包队列已关闭, 发送 null packet 以冲刷解码器。");
-            {
-                std::lock_guard lk{video_codec_mtx_};
-                avcodec_send_packet(video_codec_ctx_.get(), nullptr);
-            }
+            avcodec_send_packet(video_codec_ctx_.get(), nullptr);
         }
 
         while (!stop_.load()) {
-            int ret = 0;
-            {
-                std::lock_guard lk{video_codec_mtx_};
-                ret = avcodec_receive_frame(video_codec_ctx_.get(), frame.get());
-            }
+            int64_t start_us = av_gettime_relative();
+            int ret = avcodec_receive_frame(video_codec_ctx_.get(), frame.get());
+            video_decode_busy_us_ += av_gettime_relative() - start_us;
             if (ret < 0) {
                 if (ret == AVERROR(EAGAIN)) {  // 需要更多 packet
                     break;
                 } else if (ret == AVERROR_EOF) {  // 解码器已完全冲刷, 所有帧已取出
+                    if (next_item) {
+                        break;  // 当前项的帧已全部取出, 切换到下一项 (见下)
+                    }
                     LOG_INFO("视频解码器冲刷完毕, 关闭视频帧队列!");
                     video_frame_queue_.Close();  // 关闭帧队列, NOTE: 通知渲染逻辑
                     return 0;                    // 成功退出解码线程
@@ -382,16 +1377,33 @@ int Player::DecodeVideoFrame() {
                     return -1;
                 }
             }
+            ++video_decoded_frames_;
 
-            // ================== 更新视频时钟 ==================
-            // (尝试)获取解码后的帧的 pts
-            double pts =
-                (frame->pts == AV_NOPTS_VALUE) ? 0 : frame->pts * av_q2d(video_stream_->time_base);
-            pts = SynchronizeVideo(frame.get(), pts);
+            // (尝试)获取解码后的帧的 pts (换算到播放列表时间轴)
+            double pts = (frame->pts == AV_NOPTS_VALUE)
+                             ? 0
+                             : frame->pts * av_q2d(stream->time_base) + video_item_->offset_;
             // 计算当前帧的时长
             auto delay = (frame_rate.num && frame_rate.den
                               ? av_q2d(AVRational{frame_rate.den, frame_rate.num})
                               : 0);
+
+            // ================== 精确 seek ==================
+            // 追赶到目标之前的帧直接丢弃, 不入队、不上传纹理; 第一帧显示的就是覆盖目标时刻的帧
+            if (!isnan(video_seek_target_)) {
+                if (frame->pts != AV_NOPTS_VALUE && pts + delay <= video_seek_target_) {
+                    ++video_seek_dropped_;
+                    av_frame_unref(frame.get());
+                    continue;
+                }
+                LOG_DEBUG("精确 seek: 到达目标 {:.3f}s (帧 {:.3f}s), 追赶时丢弃 {} 帧",
+                          video_seek_target_, pts, video_seek_dropped_);
+                video_seek_target_ = NAN;
+                video_seek_dropped_ = 0;
+            }
+
+            // ================== 更新视频时钟 ==================
+            pts = SynchronizeVideo(frame.get(), pts);
             // 写入视频帧环形队列 (阻塞)
             auto decoded_frame = video_frame_queue_.PeekWritable();
             if (!decoded_frame) {
@@ -399,16 +1411,41 @@ int Player::DecodeVideoFrame() {
                 LOG_INFO("视频帧环形队列已关闭, 解码线程退出!");
                 return 0;
             }
+            // 像素格式转换 (以及窗口远小于画面时的预缩放) 在解码线程中完成 (直通时只移动引用),
+            // 渲染线程只负责上传
+            if (options_.downscale) {
+                video_converter_.SetDownscaleLevel(
+                    GetDownscaleLevel(frame->width, frame->height, frame->sample_aspect_ratio));
+            }
+            int convert_ret = video_converter_.Convert(frame.get(), decoded_frame->frame_.get(),
+                                                       &decoded_frame->texture_format_);
+            if (convert_ret < 0) {
+                if (convert_ret != AVERROR(ENOSYS)) {  // ENOSYS: 转换器已经报告过
+                    LOG_ERROR("视频帧格式转换失败: {}", av_err2str(convert_ret));
+                }
+                av_frame_unref(frame.get());
+                continue;  // 丢弃该帧, 槽位留给下一帧
+            }
+            const AVFrame* output = decoded_frame->frame_.get();
             decoded_frame->pts_ = pts;
             decoded_frame->duration_ = delay;
-            decoded_frame->sar_ = frame->sample_aspect_ratio;
-            decoded_frame->width_ = frame->width;
-            decoded_frame->height_ = frame->height;
-            decoded_frame->format_ = frame->format;
-            decoded_frame->pos_ = AV_NOPTS_VALUE;                         // TODO: seek 快进快退
-            av_frame_move_ref(decoded_frame->frame_.get(), frame.get());  // 移动
+            decoded_frame->sar_ = output->sample_aspect_ratio;
+            decoded_frame->width_ = output->width;
+            decoded_frame->height_ = output->height;
+            decoded_frame->format_ = output->format;
+            decoded_frame->serial_ = video_serial_;
+            decoded_frame->item_ = video_item_->index_;
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+            decoded_frame->pos_ = reinterpret_cast<intptr_t>(output->opaque) - 1;
+#else
+            decoded_frame->pos_ = output->pkt_pos;
+#endif
             video_frame_queue_.MoveWriteIndex();
         }
+        if (next_item) {
+            SwitchVideoItem(std::move(next_item));
+            continue;
+        }
         if (!packet) {
             // 如果已经发送了 null packet 并且内部循环因 EAGAIN 退出，
             // 说明解码器已经没有更多帧可以输出了。
@@ -424,25 +1461,159 @@ int Player::DecodeVideoFrame() {
 
 void Player::VideoDecodeLoop() {
     LOG_INFO("视频解码线程开始!");
+    SetCurrentThreadName("vdecode");
+    video_decode_start_us_ = av_gettime_relative();
     if (DecodeVideoFrame() < 0) {
         throw std::runtime_error("视频帧解码失败!");
     }
+    LogVideoDecodeStats();
+    // 视频解码阶段的 CPU 时间包括 FFmpeg 工作线程 (解码器上下文释放前它们仍然存在)
+    double cpu = 0;
+    for (const auto& thread : GetThreadCpuTimes()) {
+        if (thread.name_ == "vdecode" || thread.name_.starts_with("av:")) {
+            cpu += thread.cpu_seconds_;
+        }
+    }
+    RecordStageCpuTime(Stage::kVideoDecode, cpu > 0 ? cpu : GetCurrentThreadCpuTime());
     LOG_INFO("视频解码线程结束!");
 }
 
-double Player::SynchronizeVideo(const AVFrame* frame, double pts) {
-    {
-        std::lock_guard lk{clock_mtx_};
-        if (pts != 0) {
-            // 如果解码出的帧带有有效的 pts, 则更新视频时钟
-            video_clock_ = pts;
-        } else {
-            // 如果解码出的帧没有 pts, 就沿用上一帧的 video_clock_
-            pts = video_clock_;
+int Player::AutoVideoDecodeThreads(int width, int height) {
+    // 每 720x720 (约 0.5 MP) 像素分配一个线程: 1080p 约 4 个, 4K 约 16 个;
+    // 再多的线程在帧级多线程下只会增加输出延迟和内存, 收益很小
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int by_resolution = std::clamp(width * height / (720 * 720), 1, 16);
+    return std::min(cores, by_resolution);
+}
+
+void Player::LogVideoDecodeStats() const {
+    double wall = (av_gettime_relative() - video_decode_start_us_) / 1000000.0;
+    if (wall <= 0) {
+        return;
+    }
+    auto frames = video_decoded_frames_.load();
+    double busy = video_decode_busy_us_.load() / 1000000.0;
+    LOG_INFO("视频解码统计: {} 帧, 耗时 {:.2f}s, {:.1f} fps, 解码器调用占用 {:.1f}%", frames, wall,
+             frames / wall, busy / wall * 100);
+
+    // FFmpeg 工作线程名形如 "av:hevc:df0" (帧级) / "av:hevc:sw0" (片级)
+    double total_cpu = 0;
+    for (const auto& thread : GetThreadCpuTimes()) {
+        if (thread.name_ != "vdecode" && !thread.name_.starts_with("av:")) {
+            continue;
         }
+        total_cpu += thread.cpu_seconds_;
+        LOG_INFO("  线程 {} ({}): CPU {:.2f}s, 占用 {:.1f}%", thread.name_, thread.tid_,
+                 thread.cpu_seconds_, thread.cpu_seconds_ / wall * 100);
+    }
+    // 并行度 = 总 CPU 时间 / 墙钟时间, 远小于线程数说明扩展已到瓶颈 (串行部分或等待输入)
+    if (video_codec_ctx_ && total_cpu > 0) {
+        LOG_INFO("  解码并行度 {:.2f} / {} 线程", total_cpu / wall, video_codec_ctx_->thread_count);
+    }
+    auto skip = GetVideoSkipStats();
+    LOG_INFO("  解码跳帧: 最高级别 {}, 升级 {} 次, 降级 {} 次, 解码器跳过 {} 帧, 显示端丢弃 {} 帧",
+             skip.max_level_, skip.escalations_, skip.recoveries_, skip.skipped_frames_,
+             skip.late_dropped_);
+    if (video_converter_.GetPath() == VideoConverter::Path::kSwscale) {
+        auto pool = video_converter_.GetPoolStats();
+        LOG_INFO("  格式转换 (swscale): 输出缓冲池峰值 {:.1f} MB, 分配 {}, 重建 {}",
+                 pool.peak_bytes_ / 1048576.0, pool.allocs_, pool.rebuilds_);
+    }
+}
+
+int Player::GetDownscaleLevel(int width, int height, AVRational sar) const {
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    SDL_Rect rect;
+    CalculateDisplayRect(&rect, 0, 0, display_width_.load(), display_height_.load(), width, height,
+                         sar);
+    // 缩小一级后仍不小于显示区域才降级: 渲染器最多再缩小不到 2 倍, 画质基本不受影响
+    int level = 0;
+    while (level < kMaxDownscaleLevel && (width >> (level + 1)) >= rect.w &&
+           (height >> (level + 1)) >= rect.h) {
+        ++level;
+    }
+    return level;
+}
+
+bool Player::ReopenVideoDecoder(int lowres) {
+    const AVCodec* codec = video_codec_ctx_->codec;
+    UniqueAVCodecContext codec_context{avcodec_alloc_context3(codec)};
+    if (!codec_context ||
+        avcodec_parameters_to_context(codec_context.get(),
+                                      video_item_->GetVideoStream()->codecpar) < 0) {
+        LOG_WARN("重新打开视频解码器失败: 创建解码器上下文失败");
+        return false;
+    }
+    video_buffer_pool_.Install(codec_context.get());
+    codec_context->flags = video_codec_ctx_->flags;
+    codec_context->thread_count = video_codec_ctx_->thread_count;
+    codec_context->thread_type = video_codec_ctx_->thread_type;
+    codec_context->lowres = lowres;
+    if (avcodec_open2(codec_context.get(), codec, nullptr) < 0) {
+        LOG_WARN("以 lowres = {} 重新打开视频解码器失败", lowres);
+        return false;
+    }
+    LOG_INFO("窗口尺寸变化: 视频解码器以 lowres = {} 重新打开 (输出 1/{} 分辨率)", lowres,
+             1 << lowres);
+    video_codec_ctx_ = std::move(codec_context);
+    return true;
+}
+
+void Player::UpdateVideoSkipLevel() {
+    int64_t now_us = av_gettime_relative();
+    if (video_skip_window_start_us_ == 0 ||
+        now_us - video_skip_window_start_us_ >= kFrameSkipWindowMs * 1000) {
+        uint64_t late = video_late_frames_.exchange(0);
+        uint64_t ontime = video_ontime_frames_.exchange(0);
+        uint64_t decoded = video_decoded_frames_.load() - video_skip_window_frames_;
+        int level = video_skip_level_.load();
+        if (video_skip_window_start_us_ != 0) {
+            // 跳帧期间送入的包比输出的帧多出的部分, 就是被解码器跳过的帧
+            // NOTE: 帧级多线程有几帧的输出延迟, 按窗口累计时误差可以忽略
+            if (level > 0 && video_skip_window_packets_ > decoded) {
+                video_skipped_frames_ += video_skip_window_packets_ - decoded;
+            }
+            if (late > 0 && late * 4 >= late + ontime) {
+                // 窗口内至少 1/4 的帧在显示时已经落后: 解码跟不上, 升一级
+                video_skip_clean_windows_ = 0;
+                if (level + 1 < static_cast<int>(kVideoSkipDiscards.size())) {
+                    ++level;
+                    ++video_skip_escalations_;
+                    video_skip_max_level_ = std::max(video_skip_max_level_.load(), level);
+                    LOG_DEBUG("解码跳帧级别升至 {} (窗口内 {} / {} 帧落后)", level, late,
+                              late + ontime);
+                }
+            } else if (late > 0) {
+                video_skip_clean_windows_ = 0;
+            } else if (ontime > 0 && level > 0 &&
+                       ++video_skip_clean_windows_ >= kFrameSkipRecoverWindows) {
+                // 连续多个窗口都按时显示: 解码已追上, 降一级 (逐级降低避免来回振荡)
+                video_skip_clean_windows_ = 0;
+                --level;
+                ++video_skip_recoveries_;
+                LOG_DEBUG("解码跳帧级别降至 {}", level);
+            }
+            video_skip_level_.store(level);
+        }
+        video_skip_window_start_us_ = now_us;
+        video_skip_window_packets_ = 0;
+        video_skip_window_frames_ = video_decoded_frames_.load();
+    }
+}
+
+double Player::SynchronizeVideo(const AVFrame* frame, double pts) {
+    double clock = video_clock_.GetSample().pts_;  // 只有本线程写入, 读到的就是最新值
+    if (pts != 0) {
+        // 如果解码出的帧带有有效的 pts, 则更新视频时钟
+        clock = pts;
+    } else {
+        // 如果解码出的帧没有 pts, 就沿用上一帧的 video_clock_
+        pts = clock;
     }
     double delay{.0};  // 一帧的理论间隔时间 = 1/帧率
-    auto frame_rate = video_stream_->avg_frame_rate;
+    auto frame_rate = video_item_->GetVideoStream()->avg_frame_rate;
     if (frame_rate.num != 0 && frame_rate.den != 0) {
         delay = 1.0 / av_q2d(frame_rate);
     } else {
@@ -457,46 +1628,143 @@ double Player::SynchronizeVideo(const AVFrame* frame, double pts) {
 
     // 在当前视频时钟的基础上，加上一帧的持续时间，
     // 得到下一帧的理论显示时间戳，并更新视频时钟。
-    {
-        std::lock_guard lk{clock_mtx_};
-        video_clock_ += frame_delay;  // NOTE: 时钟: 下一帧的理论 pts
-    }
+    // NOTE: 时钟: 下一帧的理论 pts
+    video_clock_.Set(clock + frame_delay, static_cast<double>(av_gettime_relative()) / 1000000.0,
+                     video_serial_);
     return pts;  // 当前帧的 pts
 }
 
-void Player::ScheduleNextVideoRefresh(int delay_ms) {
-    SDL_AddTimer(delay_ms, VideoRefreshTimerWrapper, this);
-}
+void Player::RenderLoop(std::promise<void>* renderer_ready) {
+    SetCurrentThreadName("render");
+    if (options_.headless) {
+        // 空视频设备: 没有渲染器, 按常见 GPU 渲染器支持的 YUV 纹理格式选择转换路径
+        renderer_formats_ = {SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_NV12, SDL_PIXELFORMAT_NV21,
+                             SDL_PIXELFORMAT_YUY2, SDL_PIXELFORMAT_UYVY};
+        renderer_ready->set_value();
+    } else {
+        // 渲染器在本线程创建, 之后只在本线程使用 (SDL 渲染 API 不是线程安全的)
+        renderer_.reset(SDL_CreateRenderer(window_.get(), -1,
+                                           SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC));
+        if (!renderer_) {
+            renderer_ready->set_exception(std::make_exception_ptr(
+                std::runtime_error("SDL_CreateRenderer Error: " + std::string(SDL_GetError()))));
+            return;
+        }
+        SDL_RendererInfo renderer_info{};
+        if (SDL_GetRendererInfo(renderer_.get(), &renderer_info) == 0) {
+            auto* formats = renderer_info.texture_formats;
+            renderer_formats_.assign(formats, formats + renderer_info.num_texture_formats);
+            renderer_vsync_ = (renderer_info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+            if (upload_mode_ != UploadMode::kUpdate &&
+                std::string_view{renderer_info.name}.starts_with("opengl")) {
+                LOG_WARN("渲染器 {} 锁定纹理返回的是暂存缓冲, 锁定上传比 update 多一次拷贝",
+                         renderer_info.name);
+            }
+        }
+        if (options_.vsync_pacing && !renderer_vsync_) {
+            LOG_WARN("渲染器未开启垂直同步, 不按垂直同步槽位调度视频帧");
+        }
+        UpdateWindowSize();  // 渲染器输出尺寸可能与窗口尺寸不同 (高 DPI)
+        renderer_ready->set_value();
+    }
+    LOG_INFO("渲染线程开始!");
 
-uint32_t Player::VideoRefreshTimerWrapper(uint32_t /*interval*/, void* opaque) {
-    SDL_Event event;
-    event.type = kFFRefreshEvent;
-    event.user.data1 = opaque;
-    SDL_PushEvent(&event);
-    return 0;
+    while (!stop_.load()) {
+        if (window_resized_.exchange(false)) {
+            UpdateWindowSize();
+        }
+        auto seq = render_signal_.Prepare();
+        if (paused_.load() || !has_video_) {
+            render_signal_.Wait(seq);
+            if (!paused_.load()) {
+                // 暂停期间时间已经流逝: 以恢复时刻为新的基准, 否则会连续追赶暂停的时长
+                frame_timer_ = static_cast<double>(av_gettime_relative()) / 1000000.0;
+            }
+            continue;
+        }
+        RefreshVideo();
+    }
+
+    // 纹理和渲染器在创建它们的线程中释放
+    for (auto& texture : textures_) {
+        texture.reset();
+    }
+    renderer_.reset();
+    RecordStageCpuTime(Stage::kRender, GetCurrentThreadCpuTime());
+    LOG_INFO("渲染线程结束!");
 }
 
-// 核心视频时钟->音频时钟同步逻辑
-void Player::VideoRefreshHandler() {
-    if (stop_.load() || paused_.load()) {
-        return;
+void Player::UpdateWindowSize() {
+    int width = 0;
+    int height = 0;
+    if (SDL_GetRendererOutputSize(renderer_.get(), &width, &height) != 0) {
+        SDL_GetWindowSize(window_.get(), &width, &height);
+    }
+    window_width_ = width;
+    window_height_ = height;
+    display_width_.store(width);
+    display_height_.store(height);
+    LOG_DEBUG("窗口尺寸: {}x{}", width, height);
+
+    // 窗口可能移动到了刷新率不同的显示器上 (刷新率不变时保留已学到的周期和相位)
+    double refresh_hz = 0;
+    if (options_.vsync_pacing && renderer_vsync_) {
+        SDL_DisplayMode mode{};
+        int display = SDL_GetWindowDisplayIndex(window_.get());
+        if (display >= 0 && SDL_GetCurrentDisplayMode(display, &mode) == 0) {
+            refresh_hz = mode.refresh_rate;
+        }
+        if (refresh_hz <= 0) {
+            LOG_WARN("无法获取显示器刷新率, 不按垂直同步槽位调度视频帧");
+        }
     }
+    vsync_scheduler_.Reset(refresh_hz);
+}
 
-    if (!video_stream_) {               // 如果还没有视频流, 考虑等一会
-        ScheduleNextVideoRefresh(100);  // 重新推入事件, 等待视频流
-        return;
+bool Player::WaitForPresentTime(double target, int serial) const {
+    auto deadline_us = static_cast<int64_t>(target * 1000000.0);
+    while (!stop_.load() && !paused_.load() &&
+           serial == serial_.load(std::memory_order_acquire)) {
+        int64_t now_us = av_gettime_relative();
+        if (now_us >= deadline_us) {
+            return true;
+        }
+        // 分段睡眠: 每段最长 kRenderWakeupMs, 期间可以响应停止/暂停/seek
+        SleepUntil(std::min(deadline_us, now_us + kRenderWakeupMs * 1000));
     }
+    return false;
+}
 
-    // 阻塞获取当前可读 DecodedFrame 指针
+// 核心视频时钟->音频时钟同步逻辑
+void Player::RefreshVideo() {
+    // 阻塞获取当前可读 DecodedFrame 指针 (每次刷新只 peek 一次, 渲染直接复用)
     auto decoded_frame = video_frame_queue_.PeekReadable();
     if (!decoded_frame) {
         // 当帧队列关闭且为空时 PeekReadable 会返回 nullptr,
-        // 这意味着所有帧都已渲染完毕，播放正式结束。
-        LOG_DEBUG("[Player::VideoRefreshHandler]: 所有视频帧已渲染完毕, 发送 SDL_QUIT 退出事件!");
-        stop_.store(true);
-        SDL_Event event;
-        event.type = SDL_QUIT;
-        SDL_PushEvent(&event);
+        // 这意味着所有帧都已渲染完毕，播放正式结束 (或播放器已被停止)。
+        if (!stop_.exchange(true)) {
+            MarkPlaybackEnd();
+            LOG_DEBUG("[Player::RefreshVideo]: 所有视频帧已渲染完毕, 发送 SDL_QUIT 退出事件!");
+            SDL_Event event;
+            event.type = SDL_QUIT;
+            SDL_PushEvent(&event);
+        }
+        return;
+    }
+    // seek 之前解码的过期帧: 直接丢弃 (解码线程可能在 seek 时正阻塞在满队列上)
+    if (decoded_frame->serial_ != serial_.load(std::memory_order_acquire)) {
+        video_frame_queue_.MoveReadIndex();
+        return;
+    }
+    // seek 之后的第一帧: 重新校准帧定时器, 为下一次延迟计算提供正确的基准
+    if (decoded_frame->serial_ != shown_serial_) {
+        frame_timer_ = static_cast<double>(av_gettime_relative()) / 1000000.0;
+        last_frame_pts_ = 0.0;
+        last_frame_delay_ = 0.0;
+    }
+    if (options_.no_clock) {
+        // 不按时钟: 不做音视频同步, 取到一帧就交给空设备
+        RenderVideoFrame(decoded_frame);
         return;
     }
     // ======================== 音视频同步逻辑 =======================
@@ -526,11 +1794,14 @@ void Player::VideoRefreshHandler() {
         if (diff <= -sync_threshold) {
             // NOTE: 丢帧逻辑
             // 视频严重落后(diff为一个较大的负数)，需要丢帧来追赶。
-            // 我们简单地移动读指针，相当于丢弃当前帧，然后重新调度以处理下一帧。
+            // 我们简单地移动读指针，相当于丢弃当前帧，然后立即处理下一帧。
+            // 同时反馈给解码线程: 持续落后时由解码器直接跳帧, 而不是解码之后再丢弃
+            ++video_late_frames_;
+            ++video_late_dropped_;
             video_frame_queue_.MoveReadIndex();  // 里面有 frame unref
-            ScheduleNextVideoRefresh(0);         // 立即重新调度，尽快处理下一帧
             return;                              // NOTE: 丢帧后直接返回，不进行本轮的渲染
         }
+        ++video_ontime_frames_;
         if (diff >= sync_threshold) {
             // 视频超前，需要增加延迟等待音频。
             // 将理论延迟加倍是一种简单有效的策略。
@@ -538,73 +1809,429 @@ void Player::VideoRefreshHandler() {
         }
     }
 
-    // 计算并安排下一次刷新
-    // 操作系统调度和其他程序的干扰等因素会导致定时器回调的实际执行时间与我们期望的时间有微小的偏差
-    // 如果只简单的 ScheduleNextVideoRefresh(delay), 会造成累计误差
-    // 作为“理想时刻表”，加上经过同步调整后的 delay，计算出下一帧最理想的显示时刻。
+    // 计算当前帧的目标呈现时刻
+    // 作为“理想时刻表”，frame_timer_ 每帧累加经过同步调整后的 delay (而不是从当前时刻起算),
+    // 调度和睡眠的误差不会累积。
     frame_timer_ += delay;
-    double actual_delay = frame_timer_ - (static_cast<double>(av_gettime()) / 1000000.0);
-    // 设置一个最小延迟（10毫秒），可以防止在视频严重追赶时，定时器过于频繁地触发，
-    // 导致CPU占用率过高（忙等）。
-    if (actual_delay < 0.010) {
-        actual_delay = 0.010;
+    double now = static_cast<double>(av_gettime_relative()) / 1000000.0;
+    // 落后目标时刻太多 (例如渲染或解码卡顿): 以当前时刻为新基准, 不再试图连续追赶
+    if (now - frame_timer_ > kMaxAvSyncThreshold) {
+        frame_timer_ = now;
+    }
+    // 把目标时刻分配到某一次垂直同步 (槽位), 在槽位前半个周期醒来提交,
+    // SDL_RenderPresent 只阻塞到该次垂直同步; 未启用槽位调度时直接睡眠到目标时刻
+    auto slot = vsync_scheduler_.Assign(frame_timer_);
+    if (slot.drop_) {
+        vsync_scheduler_.OnDropped();
+        video_frame_queue_.MoveReadIndex();
+        return;
+    }
+    // 睡眠是绝对时刻, 不受事件队列影响; 被暂停/seek 打断时该帧留在队列中下次再处理
+    if (!WaitForPresentTime(vsync_scheduler_.GetWakeTime(slot), decoded_frame->serial_)) {
+        return;
+    }
+    RenderVideoFrame(decoded_frame);
+    double presented = static_cast<double>(av_gettime_relative()) / 1000000.0;
+    vsync_scheduler_.OnPresented(frame_timer_, slot, presented);
+
+    // 呈现抖动: SDL_RenderPresent 返回时刻 - 槽位时刻 (含上传耗时和垂直同步等待)
+    auto jitter_us = static_cast<int64_t>((presented - slot.time_) * 1000000.0);
+    const auto& bounds = PresentStats::kBucketUpperUs;
+    auto bucket = std::upper_bound(bounds.begin(), bounds.end(), jitter_us) - bounds.begin();
+    ++present_histogram_[bucket];
+    ++present_frames_;
+    present_jitter_us_ += jitter_us;
+    present_jitter_max_us_ = std::max(present_jitter_max_us_.load(), jitter_us);
+
+    if (has_audio_) {
+        MeasureAvOffset(pts, presented);
     }
-    // 安排下一次定时器回调
-    ScheduleNextVideoRefresh(static_cast<int>(actual_delay * 1000 + 0.5));
-    // 直接渲染当前帧
-    RenderVideoFrame();
 }
 
-void Player::RenderVideoFrame() {
-    auto decoded_frame = video_frame_queue_.PeekReadable();
-    if (!decoded_frame) {  // 一般不会没有吧
-        LOG_ERROR("RenderVideoFrame: 没有可读的视频解码帧!");
+void Player::MeasureAvOffset(double pts, double presented) {
+    recent_frames_[recent_frame_count_++ % recent_frames_.size()] = {pts, presented};
+    // 音画偏差: 声音起点实际输出的时刻 - 画面显示同一时间戳的时刻 (不经过音频时钟和同步逻辑)
+    // NOTE: 画面超前时帧可能先于音频回调交出起点呈现, 因此在最近呈现的帧中查找
+    auto onset = audio_onset_.Load();
+    if (isnan(onset.pts_) || onset.pts_ == matched_onset_pts_ ||
+        onset.serial_ != serial_.load(std::memory_order_acquire) ||
+        pts < onset.pts_ - kOnsetMatchSlack) {
+        return;  // 没有新的起点, 或者对应的帧尚未呈现
+    }
+    matched_onset_pts_ = onset.pts_;
+    std::size_t count = std::min(recent_frame_count_, recent_frames_.size());
+    for (std::size_t i = recent_frame_count_ - count; i < recent_frame_count_; ++i) {
+        const auto& [frame_pts, frame_time] = recent_frames_[i % recent_frames_.size()];
+        if (frame_pts < onset.pts_ - kOnsetMatchSlack ||
+            frame_pts > onset.pts_ + kOnsetMatchWindow) {
+            continue;
+        }
+        // 第一个不早于起点的帧: 按时间戳之差回推起点所在时刻的画面的显示时刻
+        double offset = onset.time_ - (frame_time - (frame_pts - onset.pts_));
+        if (std::abs(offset) < kAvNoSyncThreshold) {
+            auto offset_us = static_cast<int64_t>(offset * 1000000.0);
+            ++av_offset_onsets_;
+            av_offset_us_ += offset_us;
+            av_offset_abs_us_ += std::abs(offset_us);
+            av_offset_max_us_ = std::max(av_offset_max_us_.load(), std::abs(offset_us));
+        }
         return;
     }
+}
 
+void Player::RenderVideoFrame(DecodedFrame* decoded_frame) {
+    // NOTE: 帧在函数末尾才释放 (MoveReadIndex), 释放后槽位随时可能被解码线程覆盖
     const AVFrame* frame = decoded_frame->frame_.get();
+    const int serial = decoded_frame->serial_;
+    const double pts = decoded_frame->pts_;
+    const std::size_t item = decoded_frame->item_;
+    const double duration = decoded_frame->duration_;
+    int frame_bytes = av_image_get_buffer_size(static_cast<AVPixelFormat>(frame->format),
+                                               frame->width, frame->height, 1);
+
+    // 空视频设备: 不上传、不呈现
+    if (!options_.headless) {
+        // 首帧或分辨率/纹理格式变化时 (重新) 创建纹理
+        if (frame->width != texture_width_ || frame->height != texture_height_ ||
+            decoded_frame->texture_format_ != texture_format_) {
+            if (!CreateTextures(frame->width, frame->height, decoded_frame->texture_format_)) {
+                return;
+            }
+        }
+        SDL_Texture* texture = textures_[texture_index_].get();
+        if (upload_mode_ == UploadMode::kRing) {
+            texture_index_ = (texture_index_ + 1) % textures_.size();
+        }
+
+        int64_t upload_start_us = av_gettime_relative();
+        if (!UploadFrame(texture, frame, texture_format_)) {
+            LOG_ERROR("RenderVideoFrame: 上传纹理失败: {}", SDL_GetError());
+        }
+        int64_t upload_us = av_gettime_relative() - upload_start_us;
+        ++upload_frames_;
+        upload_us_ += upload_us;
+        upload_max_us_ = std::max(upload_max_us_.load(), upload_us);
+
+        SDL_Rect rect;
+        // 计算显示区域
+        CalculateDisplayRect(&rect, window_x_, window_y_, window_width_, window_height_,
+                             frame->width, frame->height, frame->sample_aspect_ratio);
+
+        // 渲染视频帧
+        SDL_RenderClear(renderer_.get());
+        SDL_RenderCopy(renderer_.get(), texture, nullptr, &rect);
+        SDL_RenderPresent(renderer_.get());
+    }
+    ++shown_frames_;
+    shown_bytes_ += static_cast<uint64_t>(std::max(frame_bytes, 0));
+    if (MarkFirstTime(&first_video_us_)) {
+        LogStartupStats();
+    }
 
-    if (!texture_) {
-        texture_.reset(SDL_CreateTexture(renderer_.get(), SDL_PIXELFORMAT_IYUV,
-                                         SDL_TEXTUREACCESS_STREAMING, frame->width, frame->height));
-        if (!texture_) {
+    // 播放列表切换后的第一帧: 呈现时刻晚于上一帧结束时刻的部分就是画面间隙
+    double now = static_cast<double>(av_gettime_relative()) / 1000000.0;
+    if (item != shown_item_ && serial == shown_serial_) {
+        double gap_ms = std::max(now - shown_end_time_, 0.0) * 1000.0;
+        LOG_INFO("播放列表切换: 画面间隙 {:.1f} ms", gap_ms);
+        if (!has_audio_) {
+            RecordItemGap(gap_ms);  // 有音频时以音频间隙为准
+        }
+    }
+    shown_item_ = item;
+    shown_end_time_ = now + duration;
+
+    // seek 之后第一帧已显示: 统计并输出 seek 请求到首帧的延迟
+    if (serial != shown_serial_) {
+        shown_serial_ = serial;
+        int64_t now_us = av_gettime_relative();
+        int64_t latency_us = now_us - serial_request_us_.load();
+        seek_latency_us_ += latency_us;
+        seek_latency_max_us_ = std::max(seek_latency_max_us_.load(), latency_us);
+        seek_last_shown_us_ = now_us;
+        ++seeks_shown_;
+        LOG_INFO("Seek 到首帧显示耗时 {:.1f} ms (首帧 {:.3f}s)", latency_us / 1000.0, pts);
+    }
+    video_frame_queue_.MoveReadIndex();  // 释放视频帧
+}
+
+bool Player::CreateTextures(int width, int height, uint32_t format) {
+    std::size_t count = upload_mode_ == UploadMode::kRing ? textures_.size() : 1;
+    for (std::size_t i = 0; i < textures_.size(); ++i) {
+        textures_[i].reset();
+        if (i >= count) {
+            continue;
+        }
+        textures_[i].reset(SDL_CreateTexture(renderer_.get(), format, SDL_TEXTUREACCESS_STREAMING,
+                                             width, height));
+        if (!textures_[i]) {
             LOG_ERROR("RenderVideoFrame: 创建 SDL 纹理失败: {}", SDL_GetError());
-            return;
+            texture_width_ = 0;
+            texture_height_ = 0;
+            return false;
         }
     }
+    texture_index_ = 0;
+    texture_width_ = width;
+    texture_height_ = height;
+    texture_format_ = format;
+    LOG_DEBUG("创建视频纹理: {}x{} {} x {}", width, height, SDL_GetPixelFormatName(format), count);
+    return true;
+}
 
-    SDL_UpdateYUVTexture(texture_.get(), nullptr, frame->data[0], frame->linesize[0],
-                         frame->data[1], frame->linesize[1], frame->data[2], frame->linesize[2]);
+bool Player::UploadFrame(SDL_Texture* texture, const AVFrame* frame, uint32_t format) {
+    if (upload_mode_ != UploadMode::kUpdate) {
+        void* pixels{nullptr};
+        int pitch = 0;
+        if (SDL_LockTexture(texture, nullptr, &pixels, &pitch) == 0) {
+            // 锁定的纹理内存中各平面依次紧挨排列, 色度平面的行宽由 pitch 推出
+            // - IYUV:      Y (pitch) + U + V ((pitch + 1) / 2, 半高)
+            // - NV12/NV21: Y (pitch) + 交织 UV (pitch 向上取偶, 半高)
+            // - YUY2/UYVY: 单个打包平面
+            int chroma_width = (frame->width + 1) / 2;
+            int chroma_height = (frame->height + 1) / 2;
+            struct Plane {
+                int bytewidth_;
+                int height_;
+                int pitch_;
+            };
+            std::array<Plane, 3> planes{};
+            int plane_count = 0;
+            if (format == SDL_PIXELFORMAT_IYUV) {
+                planes = {Plane{frame->width, frame->height, pitch},
+                          Plane{chroma_width, chroma_height, (pitch + 1) / 2},
+                          Plane{chroma_width, chroma_height, (pitch + 1) / 2}};
+                plane_count = 3;
+            } else if (format == SDL_PIXELFORMAT_NV12 || format == SDL_PIXELFORMAT_NV21) {
+                planes[0] = Plane{frame->width, frame->height, pitch};
+                planes[1] = Plane{chroma_width * 2, chroma_height, (pitch + 1) / 2 * 2};
+                plane_count = 2;
+            } else {
+                planes[0] = Plane{chroma_width * 4, frame->height, pitch};
+                plane_count = 1;
+            }
+            auto dst = static_cast<uint8_t*>(pixels);
+            bool strided = false;
+            for (int i = 0; i < plane_count; ++i) {
+                const auto& plane = planes[i];
+                if (frame->linesize[i] == plane.pitch_) {
+                    // 帧的行宽恰好与纹理一致 (帧缓冲池并不按纹理的行宽分配): 整个平面一次连续拷贝
+                    std::memcpy(dst, frame->data[i],
+                                static_cast<std::size_t>(plane.pitch_) * plane.height_);
+                } else {
+                    av_image_copy_plane(dst, plane.pitch_, frame->data[i], frame->linesize[i],
+                                        plane.bytewidth_, plane.height_);
+                    strided = true;
+                }
+                dst += static_cast<std::size_t>(plane.pitch_) * plane.height_;
+            }
+            SDL_UnlockTexture(texture);
+            if (strided) {
+                ++upload_strided_frames_;
+            }
+            return true;
+        }
+        // 渲染器不支持锁定该纹理: 之后都退回 SDL_Update*Texture
+        LOG_WARN("SDL_LockTexture 失败 ({}), 退回 SDL_Update*Texture", SDL_GetError());
+        upload_mode_ = UploadMode::kUpdate;
+    }
+    if (format == SDL_PIXELFORMAT_IYUV) {
+        return SDL_UpdateYUVTexture(texture, nullptr, frame->data[0], frame->linesize[0],
+                                    frame->data[1], frame->linesize[1], frame->data[2],
+                                    frame->linesize[2]) == 0;
+    }
+    if (format == SDL_PIXELFORMAT_NV12 || format == SDL_PIXELFORMAT_NV21) {
+        return SDL_UpdateNVTexture(texture, nullptr, frame->data[0], frame->linesize[0],
+                                   frame->data[1], frame->linesize[1]) == 0;
+    }
+    return SDL_UpdateTexture(texture, nullptr, frame->data[0], frame->linesize[0]) == 0;
+}
 
-    SDL_Rect rect;
-    // 计算显示区域
-    CalculateDisplayRect(&rect, window_x_, window_y_, window_width_, window_height_, frame->width,
-                         frame->height, frame->sample_aspect_ratio);
-
-    // 渲染视频帧
-    SDL_RenderClear(renderer_.get());
-    SDL_RenderCopy(renderer_.get(), texture_.get(), nullptr, &rect);
-    SDL_RenderPresent(renderer_.get());
-    video_frame_queue_.MoveReadIndex();  // 释放视频帧
+Player::UploadStats Player::GetUploadStats() const {
+    UploadStats stats;
+    stats.frames_ = upload_frames_.load();
+    stats.strided_frames_ = upload_strided_frames_.load();
+    if (stats.frames_ > 0) {
+        stats.avg_ms_ = upload_us_.load() / 1000.0 / stats.frames_;
+    }
+    stats.max_ms_ = upload_max_us_.load() / 1000.0;
+    stats.mode_ = upload_mode_;
+    return stats;
+}
+
+Player::AvSyncStats Player::GetAvSyncStats() const {
+    AvSyncStats stats;
+    stats.onsets_ = av_offset_onsets_.load();
+    if (stats.onsets_ > 0) {
+        stats.avg_offset_ms_ = av_offset_us_.load() / 1000.0 / stats.onsets_;
+        stats.avg_abs_offset_ms_ = av_offset_abs_us_.load() / 1000.0 / stats.onsets_;
+    }
+    stats.max_abs_offset_ms_ = av_offset_max_us_.load() / 1000.0;
+    stats.device_latency_ms_ = audio_device_latency_ * 1000.0;
+    stats.output_latency_ms_ = options_.headless ? 0 : options_.audio_output_latency_ms;
+    stats.latency_compensated_ = options_.audio_latency_comp;
+    return stats;
+}
+
+Player::PresentStats Player::GetPresentStats() const {
+    PresentStats stats;
+    stats.frames_ = present_frames_.load();
+    if (stats.frames_ > 0) {
+        stats.avg_jitter_ms_ = present_jitter_us_.load() / 1000.0 / stats.frames_;
+    }
+    stats.max_jitter_ms_ = present_jitter_max_us_.load() / 1000.0;
+    for (std::size_t i = 0; i < stats.histogram_.size(); ++i) {
+        stats.histogram_[i] = present_histogram_[i].load();
+    }
+    return stats;
+}
+
+Player::ThroughputStats Player::GetThroughputStats() const {
+    ThroughputStats stats;
+    int64_t start_us = playback_start_us_.load();
+    int64_t end_us = playback_end_us_.load();
+    if (start_us > 0) {
+        stats.wall_sec_ = ((end_us > 0 ? end_us : av_gettime_relative()) - start_us) / 1000000.0;
+    }
+    stats.video_frames_ = shown_frames_.load();
+    if (stats.wall_sec_ > 0) {
+        stats.fps_ = stats.video_frames_ / stats.wall_sec_;
+        stats.input_mb_per_sec_ = read_bytes_.load() / 1048576.0 / stats.wall_sec_;
+        stats.video_mb_per_sec_ = shown_bytes_.load() / 1048576.0 / stats.wall_sec_;
+        if (audio_bytes_per_sec_ > 0) {
+            stats.audio_speed_ = static_cast<double>(audio_ring_.GetReadPosition()) /
+                                 audio_bytes_per_sec_ / stats.wall_sec_;
+        }
+    }
+    for (std::size_t i = 0; i < kStageCount; ++i) {
+        stats.stage_cpu_sec_[i] = stage_cpu_us_[i].load() / 1000000.0;
+    }
+    return stats;
+}
+
+void Player::RecordStageCpuTime(Stage stage, double cpu_seconds) {
+    stage_cpu_us_[static_cast<std::size_t>(stage)] = static_cast<int64_t>(cpu_seconds * 1000000);
+}
+
+Player::PlaylistStats Player::GetPlaylistStats() const {
+    PlaylistStats stats;
+    stats.items_ = playlist_.size();
+    stats.transitions_ = item_transitions_.load();
+    stats.skipped_items_ = skipped_items_.load();
+    stats.last_gap_ms_ = item_gap_us_.load() / 1000.0;
+    stats.max_gap_ms_ = item_gap_max_us_.load() / 1000.0;
+    return stats;
+}
+
+Player::StartupStats Player::GetStartupStats() const {
+    auto ms = [](int64_t from_us, int64_t to_us) {
+        return to_us > 0 ? (to_us - from_us) / 1000.0 : 0.0;
+    };
+    StartupStats stats;
+    stats.sdl_ms_ = ms(startup_us_, sdl_ready_us_);
+    stats.open_input_ms_ = ms(startup_us_, input_opened_us_);
+    stats.probe_ms_ = ms(input_opened_us_, probed_us_);
+    stats.probe_cache_hit_ = probe_cache_hit_;
+    stats.open_codecs_ms_ = ms(std::max(sdl_ready_us_, probed_us_), codecs_opened_us_);
+    stats.start_threads_ms_ = ms(codecs_opened_us_, playback_start_us_.load());
+    int64_t first_audio_us = first_audio_us_.load();
+    int64_t first_video_us = first_video_us_.load();
+    stats.first_audio_ms_ = first_audio_us > 0 ? ms(startup_us_, first_audio_us) : -1;
+    stats.first_video_ms_ = first_video_us > 0 ? ms(startup_us_, first_video_us) : -1;
+    return stats;
+}
+
+void Player::LogStartupStats() {
+    if (startup_logged_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // 两路输出都已开始 (或没有对应的流) 时才输出, 且只输出一次
+    bool audio_started = !has_audio_ || first_audio_us_.load() > 0;
+    bool video_started = !has_video_ || first_video_us_.load() > 0;
+    if (!audio_started || !video_started || startup_logged_.exchange(true)) {
+        return;
+    }
+    auto stats = GetStartupStats();
+    LOG_INFO("启动耗时: SDL 和窗口 {:.1f} ms, 与之并行: 打开输入 {:.1f} ms + {} {:.1f} ms; "
+             "之后打开解码器 {:.1f} ms, 启动线程 {:.1f} ms",
+             stats.sdl_ms_, stats.open_input_ms_, stats.probe_cache_hit_ ? "读取探测缓存" : "探测",
+             stats.probe_ms_, stats.open_codecs_ms_, stats.start_threads_ms_);
+    LOG_INFO("启动耗时: 首个音频采样 {:.1f} ms, 首帧显示 {:.1f} ms (从构造开始, -1 表示没有)",
+             stats.first_audio_ms_, stats.first_video_ms_);
+}
+
+void Player::MarkPlaybackEnd() {
+    int64_t expected = 0;
+    playback_end_us_.compare_exchange_strong(expected, av_gettime_relative());
+}
+
+Player::AudioStats Player::GetAudioStats() const {
+    AudioStats stats;
+    stats.underruns_ = audio_underruns_.load(std::memory_order_relaxed);
+    stats.underrun_bytes_ = audio_underrun_bytes_.load(std::memory_order_relaxed);
+    stats.buffered_bytes_ = audio_ring_.GetSize();
+    return stats;
+}
+
+Player::SeekStats Player::GetSeekStats() const {
+    SeekStats stats;
+    stats.requests_ = seek_requests_.load();
+    stats.executed_ = seeks_executed_.load();
+    stats.failures_ = seek_failures_.load();
+    stats.shown_ = seeks_shown_.load();
+    if (stats.executed_ > 0) {
+        stats.avg_exec_ms_ = seek_exec_us_.load() / 1000.0 / stats.executed_;
+    }
+    stats.max_exec_ms_ = seek_exec_max_us_.load() / 1000.0;
+    if (stats.shown_ > 0) {
+        stats.avg_latency_ms_ = seek_latency_us_.load() / 1000.0 / stats.shown_;
+        int64_t elapsed_us = seek_last_shown_us_.load() - seek_first_request_us_.load();
+        if (elapsed_us > 0) {
+            stats.shown_per_sec_ = stats.shown_ * 1000000.0 / elapsed_us;
+        }
+    }
+    stats.max_latency_ms_ = seek_latency_max_us_.load() / 1000.0;
+    return stats;
+}
+
+Player::VideoSkipStats Player::GetVideoSkipStats() const {
+    VideoSkipStats stats;
+    stats.level_ = video_skip_level_.load();
+    stats.max_level_ = video_skip_max_level_.load();
+    stats.escalations_ = video_skip_escalations_.load();
+    stats.recoveries_ = video_skip_recoveries_.load();
+    stats.skipped_frames_ = video_skipped_frames_.load();
+    stats.late_dropped_ = video_late_dropped_.load();
+    return stats;
+}
+
+PacketPool::Stats Player::GetPacketPoolStats() const { return packet_pool_.GetStats(); }
+
+FrameBufferPool::Stats Player::GetFrameBufferPoolStats(AVMediaType type) const {
+    return type == AVMEDIA_TYPE_VIDEO ? video_buffer_pool_.GetStats()
+                                      : audio_buffer_pool_.GetStats();
 }
 
 double Player::GetMasterClock() const {
-    std::lock_guard lk{clock_mtx_};
-    if (audio_stream_) {
-        return audio_clock_;
-    } else {
-        return video_clock_;
+    if (has_audio_) {
+        // 不扣除设备延迟时 (仅用于对比) 时钟超前一个设备延迟, 画面因此早于声音
+        double clock = GetAudioClock();
+        return options_.audio_latency_comp ? clock : clock + audio_device_latency_;
     }
+    // seek 之后时钟重建之前 (仍属于旧的播放序号) 视为无效
+    auto sample = video_clock_.GetSample();
+    return sample.serial_ == serial_.load(std::memory_order_acquire) ? sample.pts_ : NAN;
 }
 
-double Player::GetVideoClock() const {
-    std::lock_guard lk{clock_mtx_};
-    return video_clock_;
+double Player::GetVideoClock() const { return video_clock_.GetSample().pts_; }
+
+double Player::GetAudioClock() const {
+    double now = static_cast<double>(av_gettime_relative()) / 1000000.0;
+    return audio_clock_.Get(now, serial_.load(std::memory_order_acquire));
 }
 
 void Player::CalculateDisplayRect(SDL_Rect* rect, int window_x, int window_y, int window_width,
                                   int window_height, int picture_width, int picture_height,
-                                  AVRational picture_sar) {
+                                  AVRational picture_sar) const {
     // NOTE: picture_sar: sample aspect ratio 像素宽高比 SAR
     // 不同于 DAR(display aspect ratio) 显示宽高比
     AVRational aspect_ratio = picture_sar;
@@ -644,10 +2271,22 @@ void Player::CalculateDisplayRect(SDL_Rect* rect, int window_x, int window_y, in
 
 void Player::Stop() {
     stop_.store(true);
+    MarkPlaybackEnd();
+    WakeReadLoop();
     // 关闭队列以唤醒任何可能在等待的线程
     video_packet_queue_.Close();
     audio_packet_queue_.Close();
     video_frame_queue_.Close();
+    audio_ring_.Close();
+    render_signal_.NotifyAll();
+    std::lock_guard lk{seek_index_mtx_};
+    seek_index_.Stop();
+}
+
+void Player::OnWindowResized() {
+    // 渲染器属于渲染线程: 只投递通知, 由渲染线程查询新的输出尺寸
+    window_resized_.store(true);
+    render_signal_.NotifyAll();
 }
 
 void Player::TogglePause() {
@@ -655,70 +2294,213 @@ void Player::TogglePause() {
     if (paused_.load()) {
         LOG_INFO("暂停播放!");
         SDL_PauseAudio(1);  // 暂停音频设备，SDL 将不再请求新的音频数据
+        audio_clock_.SetPaused(true, static_cast<double>(av_gettime_relative()) / 1000000.0);
     } else {
         LOG_INFO("继续播放!");
-        // 1. 校准 frame_timer_
-        // 这是至关重要的一步。暂停期间，时间已经流逝。
-        // 我们必须将 frame_timer 更新为当前时间，否则 VideoRefreshHandler
-        // 在计算 actual_delay 时会得到一个巨大的负数，导致视频快进或卡顿。
-        frame_timer_ = static_cast<double>(av_gettime()) / 1000000.0;
-        // 2. 恢复音频设备
+        audio_clock_.SetPaused(false, static_cast<double>(av_gettime_relative()) / 1000000.0);
         SDL_PauseAudio(0);
-        // 3. 重新调度视频刷新
-        ScheduleNextVideoRefresh(0);
+        // 唤醒渲染线程 (由它校准 frame_timer_)
+        render_signal_.NotifyAll();
     }
 }
 
 void Player::SeekTo(double time_seconds) {
-    // 计算目标时间戳 (以视频流的时间基为单位)
-    if (!video_stream_) {
+    if (!has_video_) {
         LOG_ERROR("Seek 失败: 没有视频流!");
         return;
     }
+    if (isnan(time_seconds)) {
+        return;
+    }
+    // 只记录最新的目标并唤醒读取线程, 不等待 demuxer (按住方向键时每次重复只是覆盖目标)
+    int64_t now_us = av_gettime_relative();
+    int64_t first_us = 0;
+    seek_first_request_us_.compare_exchange_strong(first_us, now_us);
+    seek_target_.store(std::max(time_seconds, 0.0));
+    seek_request_us_.store(now_us);
+    ++seek_requests_;
+    seek_pending_.store(true);
+    WakeReadLoop();
+}
+
+void Player::SeekBy(double offset_sec) {
+    // 上一次请求尚未执行, 或已执行但时钟尚未重建 (NAN) 时, 以最新的目标为基准累加,
+    // 否则连续快进会一直从旧的播放位置起跳
+    double base = GetMasterClock();
+    if (seek_pending_.load() || isnan(base)) {
+        base = seek_target_.load();
+    }
+    SeekTo(base + offset_sec);
+}
+
+void Player::CycleAudioStream() {
+    if (!has_audio_) {
+        LOG_WARN("切换音频流失败: 没有音频流!");
+        return;
+    }
+    audio_switch_pending_.store(true);
+    WakeReadLoop();
+}
+
+void Player::ExecuteAudioSwitch() {
+    // 按索引顺序循环到下一路有解码器的音频流 (正在读取的项)
+    AVFormatContext* fmt_ctx = item_->format_ctx_.get();
+    int count = static_cast<int>(fmt_ctx->nb_streams);
+    AVStream* next = nullptr;
+    for (int i = 1; i < count && !next; ++i) {
+        AVStream* stream = fmt_ctx->streams[(item_->audio_stream_idx_ + i) % count];
+        if (stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
+            avcodec_find_decoder(stream->codecpar->codec_id)) {
+            next = stream;
+        }
+    }
+    if (!next) {
+        LOG_INFO("没有其他可切换的音频流");
+        return;
+    }
+    LOG_INFO("切换音频流: #{} -> #{} ({})", item_->audio_stream_idx_, next->index,
+             GetStreamLanguage(next));
+    // 不重新打开文件: 只改变 demuxer 丢弃的流, 之后读出的音频包来自新的流
+    fmt_ctx->streams[item_->audio_stream_idx_]->discard = AVDISCARD_ALL;
+    next->discard = AVDISCARD_DEFAULT;
+    item_->audio_stream_idx_ = next->index;
+    ++audio_switches_;
+
+    // 之后打开的项 (包括已在后台打开的下一项, 见 ReselectAudioStream) 沿用这次的选择:
+    // 新流的语言在本文件的音频流中唯一时按语言, 否则按流索引
+    std::string language = GetStreamLanguage(next);
+    int same_language = 0;
+    for (int i = 0; i < count; ++i) {
+        const AVStream* stream = fmt_ctx->streams[i];
+        if (stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
+            language == GetStreamLanguage(stream)) {
+            ++same_language;
+        }
+    }
+    {
+        std::lock_guard lk{audio_stream_mtx_};
+        audio_stream_spec_ =
+            language != "und" && same_language == 1 ? language : std::to_string(next->index);
+    }
+
+    // 有待执行的 seek 时由它刷新两路队列
+    if (seek_pending_.load()) {
+        return;
+    }
+    // 已缓冲的音频包都属于旧流, 新流只能从当前读取位置 (领先播放位置一个缓冲时长) 开始:
+    // 只对音频重新同步, 从播放位置之前的关键帧重新读取, 视频包跳过已入队的部分 (视频队列、
+    // 解码器和画面都不受影响), 新流早于播放位置的包直接丢弃
+    double position = GetAudioClock();
+    bool fallback = isnan(position) || (has_video_ && read_video_ts_ == AV_NOPTS_VALUE) ||
+                    position < item_->offset_ + item_->start_time_;
+    int ret = -1;
+    if (!fallback) {
+        auto target_ts = static_cast<int64_t>((position - item_->offset_) * AV_TIME_BASE);
+        ret = av_seek_frame(fmt_ctx, -1, target_ts, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            LOG_WARN("切换音频流: 重新定位读取位置失败: {}", av_err2str(ret));
+        }
+    }
+    if (ret < 0) {
+        // 时钟尚未建立, 或者仍在播放上一项的尾部: 从播放位置对两路做一次精确 seek
+        ExecuteSeek(isnan(position) ? seek_target_.load() : position, true);
+        return;
+    }
+    skip_video_until_ts_ = read_video_ts_;
+    audio_resync_from_ = position;
+    // 旧流的包立即从缓冲水位中扣除, 解码线程收到标记时丢弃旧流的解码器状态和 PCM 缓冲
+    audio_packet_queue_.Clear();
+    buffering_paused_ = false;
+    auto marker = packet_pool_.Acquire();
+    if (!marker) {
+        LOG_ERROR("分配 AVPacket 失败!");
+        return;
+    }
+    marker->stream_index = kAudioResyncMarkerStream;
+    marker->opaque = nullptr;
+    audio_packet_queue_.Push(std::move(marker), serial_.load(std::memory_order_relaxed));
+}
+
+Player::DemuxStats Player::GetDemuxStats() const {
+    DemuxStats stats;
+    stats.io_bytes_ = io_bytes_.load();
+    stats.read_frame_ms_ = read_frame_us_.load() / 1000.0;
+    stats.max_read_frame_ms_ = read_frame_max_us_.load() / 1000.0;
+    stats.demuxed_bytes_ = read_bytes_.load();
+    stats.demuxed_packets_ = read_packets_.load();
+    stats.dropped_bytes_ = dropped_bytes_.load();
+    stats.dropped_packets_ = dropped_packets_.load();
+    stats.discarded_streams_ = discarded_streams_;
+    stats.audio_switches_ = audio_switches_.load();
+    return stats;
+}
+
+bool Player::ExecuteSeek(double time_seconds, bool exact) {
+    // 播放列表: 只在正在读取的项内定位, 目标早于该项开头时定位到开头
+    // (读取领先播放一个缓冲时长, 刚切换到下一项时仍在播放上一项的尾部)
+    time_seconds = std::max(time_seconds, item_->offset_ + item_->start_time_);
+    double item_time = time_seconds - item_->offset_;
+    AVFormatContext* fmt_ctx = item_->format_ctx_.get();
     // 当 av_seek_frame 的 stream_index 为 -1 时, 时间戳单位必须是 AV_TIME_BASE
-    int64_t target_ts = static_cast<int64_t>(time_seconds * AV_TIME_BASE);
+    int64_t target_ts = static_cast<int64_t>(item_time * AV_TIME_BASE);
+    int64_t start_us = av_gettime_relative();
 
-    // 调用 av_seek_frame 进行跳转
-    // AVSEEK_FLAG_BACKWARD 确保我们 seek 到目标时间戳之前的最近一个关键帧
+    // 优先用关键帧索引直接定位目标之前最近的关键帧, 避免 demuxer 在稀疏索引上扫描
+    auto keyframe = options_.seek_index ? seek_index_.Lookup(item_time) : std::nullopt;
     int ret = 0;
-    {
-        std::lock_guard lk{format_ctx_mtx_};
+    const char* method = "";
+    int video_idx = item_->video_stream_idx_;
+    if (keyframe && keyframe->pos_ >= 0 && !(fmt_ctx->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+        // 按字节位置跳转: demuxer 直接从关键帧所在位置继续读取
+        method = "字节位置";
+        ret = av_seek_frame(fmt_ctx, video_idx, keyframe->pos_, AVSEEK_FLAG_BYTE);
+    } else if (keyframe) {
+        // 不支持字节跳转 (例如 MP4): 以关键帧的精确时间戳为上界, demuxer 不需要再搜索
+        method = "关键帧时间戳";
+        ret = avformat_seek_file(fmt_ctx, video_idx, INT64_MIN, keyframe->pts_, keyframe->pts_, 0);
+    } else {
+        // 调用 av_seek_frame 进行跳转
+        // AVSEEK_FLAG_BACKWARD 确保我们 seek 到目标时间戳之前的最近一个关键帧
         // 当 stream_index >= 0 时：timestamp 参数必须是该特定流的时间基单位。
         // 当 stream_index == -1 时：FFmpeg 会选择一个默认流（通常是视频流）进行跳转，
         // 但此时 timestamp 参数必须是 AV_TIME_BASE 单位(1000000)
-        ret = av_seek_frame(format_ctx_.get(), -1, target_ts, AVSEEK_FLAG_BACKWARD);
+        method = "demuxer 搜索";
+        ret = av_seek_frame(fmt_ctx, -1, target_ts, AVSEEK_FLAG_BACKWARD);
     }
+    int64_t exec_us = av_gettime_relative() - start_us;
+    LOG_DEBUG("Seek 到 {:.3f}s ({}), 耗时 {:.2f} ms", time_seconds, method, exec_us / 1000.0);
+    ++seeks_executed_;
+    seek_exec_us_ += exec_us;
+    seek_exec_max_us_ = std::max(seek_exec_max_us_.load(), exec_us);
     if (ret < 0) {
         LOG_ERROR("Seek 失败: {}", av_err2str(ret));
-        return;
+        ++seek_failures_;
+        return false;
     }
 
-    // 清空缓冲区
+    // 进入新的播放序号: 之后读取的包都带新序号, 解码线程和渲染据此丢弃过期的包/帧,
+    // 并在各自线程内冲刷解码器、重建时钟 (不再由调用线程清空队列和解码器)
+    // NOTE: 先发布目标和请求时刻, 再递增序号
+    serial_seek_target_.store(time_seconds);
+    serial_exact_.store(exact);
+    serial_request_us_.store(seek_request_us_.load());
+    serial_.fetch_add(1, std::memory_order_release);
+
+    // 过期包的字节数和时长在 Clear 返回时即不再计入 (包本身由解码线程稍后释放),
+    // 水位立即反映 seek 后的状态; 同时解除缓冲已满的暂停, 读取线程不必等解码线程
+    // 消耗完过期包才恢复读取 (本线程是唯一的生产者, 此时队列中的包都属于旧序号)
     video_packet_queue_.Clear();
     audio_packet_queue_.Clear();
-    video_frame_queue_.Clear();
-
-    // 刷新解码器内部缓冲区
-    if (video_codec_ctx_) {
-        std::lock_guard lk{video_codec_mtx_};
-        avcodec_flush_buffers(video_codec_ctx_.get());
-    }
-    if (audio_codec_ctx_) {
-        std::lock_guard lk{audio_codec_mtx_};
-        avcodec_flush_buffers(audio_codec_ctx_.get());
-    }
-
-    // 重置时钟和同步状态
-    {
-        std::lock_guard lk{clock_mtx_};
-        audio_clock_ = NAN;  // 设为无效, 依赖解码后的实际时间戳来重建时钟
-        video_clock_ = NAN;
-
-        // 重置帧定时器, 将其校准为当前的系统时间，为下一次延迟计算提供正确的基准
-        frame_timer_ = static_cast<double>(av_gettime()) / 1000000.0;
-        last_frame_pts_ = 0.0;
-        last_frame_delay_ = 0.0;
+    buffering_paused_ = false;
+    audio_ring_.Clear();  // 立即停止播放旧位置的音频
+    read_video_ts_ = AV_NOPTS_VALUE;
+    skip_video_until_ts_ = AV_NOPTS_VALUE;
+    audio_resync_from_ = NAN;
+    // 被清除的包中可能有项边界标记: 重新写入, 解码线程据此切换到正在读取的项
+    if (playlist_.size() > 1) {
+        PushItemMarkers();
     }
+    return true;
 }
 
-}  // namespace avplayer
\ No newline at end of file
+}  // namespace avplayer
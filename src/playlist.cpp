@@ -0,0 +1,61 @@
+#include <avplayer/logger.hpp>
+#include <avplayer/playlist.hpp>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace avplayer {
+
+namespace {
+
+bool IsM3u(const std::filesystem::path& path) {
+    auto extension = path.extension().string();
+    for (auto& c : extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == ".m3u" || extension == ".m3u8";
+}
+
+}  // namespace
+
+std::vector<std::string> ExpandPlaylist(const std::vector<std::string>& inputs) {
+    std::vector<std::string> items;
+    for (const auto& input : inputs) {
+        std::filesystem::path list_path{input};
+        if (!IsM3u(list_path)) {
+            items.push_back(input);
+            continue;
+        }
+        std::ifstream in{list_path};
+        if (!in) {
+            throw std::runtime_error("打开播放列表失败: " + input);
+        }
+        std::size_t count = 0;
+        bool first_line = true;
+        std::string line;
+        while (std::getline(in, line)) {
+            // 去掉 UTF-8 BOM 和首尾空白 (含 Windows 换行的 \r)
+            if (first_line && line.starts_with("\xEF\xBB\xBF")) {
+                line.erase(0, 3);
+            }
+            first_line = false;
+            auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') {
+                continue;  // 空行, 注释和 #EXTINF 等扩展标签
+            }
+            auto last = line.find_last_not_of(" \t\r");
+            std::filesystem::path entry{line.substr(first, last - first + 1)};
+            // 相对路径相对于列表文件所在目录; URL (含 ://) 原样保留
+            if (entry.is_relative() && line.find("://") == std::string::npos) {
+                entry = list_path.parent_path() / entry;
+            }
+            items.push_back(entry.string());
+            ++count;
+        }
+        LOG_INFO("播放列表 {}: {} 项", input, count);
+    }
+    return items;
+}
+
+}  // namespace avplayer
@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <avplayer/logger.hpp>
+#include <avplayer/probe_cache.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace avplayer {
+
+namespace {
+
+constexpr char kCacheMagic[8] = {'A', 'V', 'P', 'P', 'R', 'B', '0', '1'};
+constexpr int kMaxExtradataSize = 16 * 1024 * 1024;  // 超过时视为缓存文件损坏
+
+// 一路流需要缓存的字段 (AVStream + AVCodecParameters), 整体按字节读写
+// NOTE: 缓存只在本机使用, 文件头记录了结构体大小, 布局变化后旧缓存自动作废
+struct StreamRecord {
+    // AVStream
+    AVRational time_base{0, 1};
+    int64_t start_time{0};
+    int64_t duration{0};
+    int64_t nb_frames{0};
+    int32_t disposition{0};
+    AVRational stream_sar{0, 1};
+    AVRational avg_frame_rate{0, 1};
+    AVRational r_frame_rate{0, 1};
+    // AVCodecParameters
+    int32_t codec_type{0};
+    int32_t codec_id{0};
+    uint32_t codec_tag{0};
+    int32_t format{-1};
+    int64_t bit_rate{0};
+    int32_t bits_per_coded_sample{0};
+    int32_t bits_per_raw_sample{0};
+    int32_t profile{0};
+    int32_t level{0};
+    int32_t width{0};
+    int32_t height{0};
+    AVRational sample_aspect_ratio{0, 1};
+    int32_t field_order{0};
+    int32_t color_range{0};
+    int32_t color_primaries{0};
+    int32_t color_trc{0};
+    int32_t color_space{0};
+    int32_t chroma_location{0};
+    int32_t video_delay{0};
+    int32_t ch_order{0};
+    int32_t nb_channels{0};
+    uint64_t ch_mask{0};
+    int32_t sample_rate{0};
+    int32_t block_align{0};
+    int32_t frame_size{0};
+    int32_t initial_padding{0};
+    int32_t trailing_padding{0};
+    int32_t seek_preroll{0};
+    int32_t extradata_size{0};
+};
+
+// FNV-1a 64 位哈希 (hash 为上一段数据的结果, 可以分段累加)
+uint64_t HashBytes(const void* data, std::size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// 默认缓存目录, 无法确定时返回空
+std::string GetDefaultCacheDir() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return std::string{xdg} + "/avplayer/probe";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::string{home} + "/.cache/avplayer/probe";
+    }
+    return {};
+}
+
+// 探测结果是否完整 (不完整的结果缓存后会让解码器以错误参数打开)
+bool IsComplete(const AVStream* stream) {
+    const AVCodecParameters* par = stream->codecpar;
+    if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+        return par->width > 0 && par->height > 0;
+    }
+    if (par->codec_type == AVMEDIA_TYPE_AUDIO) {
+        return par->sample_rate > 0 && par->ch_layout.nb_channels > 0 &&
+               (par->ch_layout.order == AV_CHANNEL_ORDER_NATIVE ||
+                par->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC);
+    }
+    return true;
+}
+
+StreamRecord ToRecord(const AVStream* stream) {
+    const AVCodecParameters* par = stream->codecpar;
+    StreamRecord record;
+    record.time_base = stream->time_base;
+    record.start_time = stream->start_time;
+    record.duration = stream->duration;
+    record.nb_frames = stream->nb_frames;
+    record.disposition = stream->disposition;
+    record.stream_sar = stream->sample_aspect_ratio;
+    record.avg_frame_rate = stream->avg_frame_rate;
+    record.r_frame_rate = stream->r_frame_rate;
+    record.codec_type = par->codec_type;
+    record.codec_id = par->codec_id;
+    record.codec_tag = par->codec_tag;
+    record.format = par->format;
+    record.bit_rate = par->bit_rate;
+    record.bits_per_coded_sample = par->bits_per_coded_sample;
+    record.bits_per_raw_sample = par->bits_per_raw_sample;
+    record.profile = par->profile;
+    record.level = par->level;
+    record.width = par->width;
+    record.height = par->height;
+    record.sample_aspect_ratio = par->sample_aspect_ratio;
+    record.field_order = par->field_order;
+    record.color_range = par->color_range;
+    record.color_primaries = par->color_primaries;
+    record.color_trc = par->color_trc;
+    record.color_space = par->color_space;
+    record.chroma_location = par->chroma_location;
+    record.video_delay = par->video_delay;
+    record.ch_order = par->ch_layout.order;
+    record.nb_channels = par->ch_layout.nb_channels;
+    record.ch_mask = par->ch_layout.order == AV_CHANNEL_ORDER_NATIVE ? par->ch_layout.u.mask : 0;
+    record.sample_rate = par->sample_rate;
+    record.block_align = par->block_align;
+    record.frame_size = par->frame_size;
+    record.initial_padding = par->initial_padding;
+    record.trailing_padding = par->trailing_padding;
+    record.seek_preroll = par->seek_preroll;
+    record.extradata_size = par->extradata ? par->extradata_size : 0;
+    return record;
+}
+
+// 把 record 和 extradata 写回 stream, 分配失败时返回 false
+bool FromRecord(const StreamRecord& record, const std::vector<uint8_t>& extradata,
+                AVStream* stream) {
+    AVCodecParameters* par = stream->codecpar;
+    av_freep(&par->extradata);
+    par->extradata_size = 0;
+    if (!extradata.empty()) {
+        // NOTE: extradata 末尾必须有 AV_INPUT_BUFFER_PADDING_SIZE 字节的 0 填充
+        par->extradata =
+            static_cast<uint8_t*>(av_mallocz(extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (!par->extradata) {
+            return false;
+        }
+        std::memcpy(par->extradata, extradata.data(), extradata.size());
+        par->extradata_size = static_cast<int>(extradata.size());
+    }
+    stream->start_time = record.start_time;
+    stream->duration = record.duration;
+    stream->nb_frames = record.nb_frames;
+    stream->disposition = record.disposition;
+    stream->sample_aspect_ratio = record.stream_sar;
+    stream->avg_frame_rate = record.avg_frame_rate;
+    stream->r_frame_rate = record.r_frame_rate;
+    par->codec_type = static_cast<AVMediaType>(record.codec_type);
+    par->codec_id = static_cast<AVCodecID>(record.codec_id);
+    par->codec_tag = record.codec_tag;
+    par->format = record.format;
+    par->bit_rate = record.bit_rate;
+    par->bits_per_coded_sample = record.bits_per_coded_sample;
+    par->bits_per_raw_sample = record.bits_per_raw_sample;
+    par->profile = record.profile;
+    par->level = record.level;
+    par->width = record.width;
+    par->height = record.height;
+    par->sample_aspect_ratio = record.sample_aspect_ratio;
+    par->field_order = static_cast<AVFieldOrder>(record.field_order);
+    par->color_range = static_cast<AVColorRange>(record.color_range);
+    par->color_primaries = static_cast<AVColorPrimaries>(record.color_primaries);
+    par->color_trc = static_cast<AVColorTransferCharacteristic>(record.color_trc);
+    par->color_space = static_cast<AVColorSpace>(record.color_space);
+    par->chroma_location = static_cast<AVChromaLocation>(record.chroma_location);
+    par->video_delay = record.video_delay;
+    av_channel_layout_uninit(&par->ch_layout);
+    if (record.ch_order == AV_CHANNEL_ORDER_NATIVE) {
+        av_channel_layout_from_mask(&par->ch_layout, record.ch_mask);
+    } else {
+        par->ch_layout.order = AV_CHANNEL_ORDER_UNSPEC;
+        par->ch_layout.nb_channels = record.nb_channels;
+    }
+    par->sample_rate = record.sample_rate;
+    par->block_align = record.block_align;
+    par->frame_size = record.frame_size;
+    par->initial_padding = record.initial_padding;
+    par->trailing_padding = record.trailing_padding;
+    par->seek_preroll = record.seek_preroll;
+    return true;
+}
+
+template <typename T>
+void WriteValue(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool ReadValue(std::ifstream& in, T* value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(value), sizeof(*value)));
+}
+
+}  // namespace
+
+// =============================================================================
+// ProbeCache 实现
+// =============================================================================
+
+bool ProbeCache::Open(const std::string& media_path, const std::string& cache_dir) {
+    cache_path_.clear();
+    std::error_code ec;
+    auto size = std::filesystem::file_size(media_path, ec);
+    if (ec) {
+        return false;
+    }
+    auto mtime = std::filesystem::last_write_time(media_path, ec);
+    if (ec) {
+        return false;
+    }
+    std::string dir = cache_dir.empty() ? GetDefaultCacheDir() : cache_dir;
+    if (dir.empty()) {
+        return false;
+    }
+    std::vector<char> header(static_cast<std::size_t>(
+        std::min<uintmax_t>(size, static_cast<uintmax_t>(kProbeCacheHeaderBytes))));
+    std::ifstream in{media_path, std::ios::binary};
+    if (!in || !in.read(header.data(), static_cast<std::streamsize>(header.size()))) {
+        return false;
+    }
+    file_size_ = static_cast<uint64_t>(size);
+    mtime_ = static_cast<int64_t>(mtime.time_since_epoch().count());
+    header_hash_ = HashBytes(header.data(), header.size());
+    // 缓存文件按完整标识命名: 同一文件的不同版本互不覆盖
+    uint64_t key = HashBytes(&file_size_, sizeof(file_size_));
+    key = HashBytes(&mtime_, sizeof(mtime_), key);
+    key = HashBytes(&header_hash_, sizeof(header_hash_), key);
+    cache_path_ = fmt::format("{}/{:016x}.avpprobe", dir, key);
+    return true;
+}
+
+bool ProbeCache::Load(AVFormatContext* fmt_ctx) const {
+    std::ifstream in{cache_path_, std::ios::binary};
+    if (cache_path_.empty() || !in) {
+        return false;
+    }
+    char magic[sizeof(kCacheMagic)]{};
+    uint32_t record_size = 0;
+    uint64_t file_size = 0;
+    int64_t mtime = 0;
+    uint64_t header_hash = 0;
+    uint32_t nb_streams = 0;
+    int64_t start_time = 0;
+    int64_t duration = 0;
+    int64_t bit_rate = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+        !std::equal(magic, magic + sizeof(magic), kCacheMagic) || !ReadValue(in, &record_size) ||
+        !ReadValue(in, &file_size) || !ReadValue(in, &mtime) || !ReadValue(in, &header_hash) ||
+        !ReadValue(in, &nb_streams) || !ReadValue(in, &start_time) || !ReadValue(in, &duration) ||
+        !ReadValue(in, &bit_rate)) {
+        return false;
+    }
+    if (record_size != sizeof(StreamRecord) || file_size != file_size_ || mtime != mtime_ ||
+        header_hash != header_hash_) {
+        return false;
+    }
+    if (nb_streams != fmt_ctx->nb_streams) {
+        LOG_INFO("探测缓存: 流数不一致 (缓存 {}, demuxer {}), 重新探测", nb_streams,
+                 fmt_ctx->nb_streams);
+        return false;
+    }
+    // 先读出并校验全部流, 都一致后才写回 (不留下只写回了一部分的状态)
+    std::vector<StreamRecord> records(nb_streams);
+    std::vector<std::vector<uint8_t>> extradata(nb_streams);
+    for (uint32_t i = 0; i < nb_streams; ++i) {
+        auto& record = records[i];
+        if (!ReadValue(in, &record) || record.extradata_size < 0 ||
+            record.extradata_size > kMaxExtradataSize) {
+            return false;
+        }
+        extradata[i].resize(static_cast<std::size_t>(record.extradata_size));
+        if (!in.read(reinterpret_cast<char*>(extradata[i].data()), record.extradata_size)) {
+            return false;
+        }
+        // demuxer 已从容器头部读到的信息必须与缓存一致, 时间基决定包时间戳的含义, 必须相同
+        const AVStream* stream = fmt_ctx->streams[i];
+        const AVCodecParameters* par = stream->codecpar;
+        if ((par->codec_type != AVMEDIA_TYPE_UNKNOWN && par->codec_type != record.codec_type) ||
+            (par->codec_id != AV_CODEC_ID_NONE && par->codec_id != record.codec_id) ||
+            av_cmp_q(stream->time_base, record.time_base) != 0) {
+            LOG_INFO("探测缓存: 流 #{} 与 demuxer 读到的参数不一致, 重新探测", i);
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < nb_streams; ++i) {
+        if (!FromRecord(records[i], extradata[i], fmt_ctx->streams[i])) {
+            return false;
+        }
+    }
+    fmt_ctx->start_time = start_time;
+    fmt_ctx->duration = duration;
+    fmt_ctx->bit_rate = bit_rate;
+    return true;
+}
+
+void ProbeCache::Save(const AVFormatContext* fmt_ctx) const {
+    if (cache_path_.empty()) {
+        return;
+    }
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; ++i) {
+        if (!IsComplete(fmt_ctx->streams[i])) {
+            LOG_DEBUG("探测缓存: 流 #{} 的参数不完整, 不缓存", i);
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{cache_path_}.parent_path(), ec);
+    if (ec) {
+        LOG_WARN("探测缓存: 无法创建目录: {}", ec.message());
+        return;
+    }
+    // 先写临时文件再重命名, 避免中途退出 (或两个进程同时写入) 留下不完整的缓存
+    std::string tmp_path = cache_path_ + ".tmp";
+    {
+        std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+        if (!out) {
+            LOG_WARN("探测缓存: 无法写入 {}", tmp_path);
+            return;
+        }
+        out.write(kCacheMagic, sizeof(kCacheMagic));
+        WriteValue(out, static_cast<uint32_t>(sizeof(StreamRecord)));
+        WriteValue(out, file_size_);
+        WriteValue(out, mtime_);
+        WriteValue(out, header_hash_);
+        WriteValue(out, static_cast<uint32_t>(fmt_ctx->nb_streams));
+        WriteValue(out, fmt_ctx->start_time);
+        WriteValue(out, fmt_ctx->duration);
+        WriteValue(out, fmt_ctx->bit_rate);
+        for (unsigned int i = 0; i < fmt_ctx->nb_streams; ++i) {
+            const AVStream* stream = fmt_ctx->streams[i];
+            StreamRecord record = ToRecord(stream);
+            WriteValue(out, record);
+            out.write(reinterpret_cast<const char*>(stream->codecpar->extradata),
+                      record.extradata_size);
+        }
+        if (!out) {
+            LOG_WARN("探测缓存: 写入 {} 失败", tmp_path);
+            return;
+        }
+    }
+    std::filesystem::rename(tmp_path, cache_path_, ec);
+    if (ec) {
+        LOG_WARN("探测缓存: 保存 {} 失败: {}", cache_path_, ec.message());
+        return;
+    }
+    LOG_INFO("探测缓存: 已保存到 {}", cache_path_);
+}
+
+}  // namespace avplayer
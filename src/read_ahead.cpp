@@ -0,0 +1,431 @@
+#include <algorithm>
+#include <avplayer/logger.hpp>
+#include <avplayer/read_ahead.hpp>
+#include <avplayer/stats.hpp>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// AVPLAYER_HAVE_LIBURING 由构建脚本在找到可选的 liburing 包时定义
+#ifdef AVPLAYER_HAVE_LIBURING
+#include <liburing.h>
+#include <sys/uio.h>
+#define AVPLAYER_HAVE_IO_URING 1
+#endif
+#endif
+
+namespace avplayer {
+
+#ifdef AVPLAYER_HAVE_IO_URING
+struct ReadAheadInput::Uring {
+    io_uring ring_{};
+    bool readv_{false};          // 内核不支持 IORING_OP_READ, 改用 IORING_OP_READV
+    std::vector<iovec> iovecs_;  // readv 的 iovec, 每个槽位一个 (请求在途期间必须保持有效)
+};
+#else
+struct ReadAheadInput::Uring {};
+#endif
+
+ReadAheadInput::ReadAheadInput() = default;
+
+ReadAheadInput::~ReadAheadInput() { Close(); }
+
+bool ReadAheadInput::Open(const std::string& path, const Options& options) {
+    Close();
+#ifdef __linux__
+    fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        LOG_WARN("预读输入: 打开 {} 失败: {}", path, std::strerror(errno));
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd_, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        LOG_WARN("预读输入: {} 不是非空的普通文件", path);
+        Close();
+        return false;
+    }
+    size_ = st.st_size;
+    pos_ = 0;
+    bytes_per_us_ = options.throttle_mbps * 1048576.0 / 1e6;
+    latency_us_ = static_cast<int64_t>(options.latency_ms * 1000);
+    device_free_us_ = 0;
+    stop_ = false;
+    blocks_ = std::vector<Block>(static_cast<std::size_t>(std::max(options.window_blocks, 0)) + 1);
+    for (auto& block : blocks_) {
+        block.data_.resize(kReadAheadBlockSize);
+    }
+
+    backend_ = "线程池 pread";
+#ifdef AVPLAYER_HAVE_IO_URING
+    if (options.io_uring) {
+        // 在途请求不超过槽位数, 提交队列与槽位数相同即可
+        auto uring = std::make_unique<Uring>();
+        int ret = io_uring_queue_init(static_cast<unsigned>(blocks_.size()), &uring->ring_, 0);
+        if (ret == 0) {
+            // IORING_OP_READ 从 5.6 开始支持, 5.1 ~ 5.5 的内核提交时才返回 -EINVAL;
+            // 探测接口同样从 5.6 开始, 探测失败即视为不支持, 退回 5.1 就有的 IORING_OP_READV
+            io_uring_probe* probe = io_uring_get_probe_ring(&uring->ring_);
+            uring->readv_ = !probe || !io_uring_opcode_supported(probe, IORING_OP_READ);
+            if (probe) {
+                io_uring_free_probe(probe);
+            }
+            if (uring->readv_) {
+                uring->iovecs_.resize(blocks_.size());
+                LOG_INFO("预读输入: 内核不支持 IORING_OP_READ, 使用 IORING_OP_READV");
+            }
+            backend_ = uring->readv_ ? "io_uring (readv)" : "io_uring";
+            uring_ = std::move(uring);
+        } else {
+            LOG_INFO("预读输入: io_uring 不可用 ({}), 使用线程池", av_err2str(ret));
+        }
+    }
+#endif
+    if (!uring_) {
+        auto workers = std::min<std::size_t>(blocks_.size(), kReadAheadMaxWorkers);
+        for (std::size_t i = 0; i < workers; ++i) {
+            workers_.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    auto buffer = static_cast<uint8_t*>(av_malloc(kReadAheadBlockSize));
+    if (buffer) {
+        io_ctx_.reset(avio_alloc_context(buffer, kReadAheadBlockSize, 0, this, ReadPacket, nullptr,
+                                         Seek));
+    }
+    if (!io_ctx_) {
+        av_free(buffer);
+        LOG_WARN("预读输入: 分配 AVIOContext 失败");
+        Close();
+        return false;
+    }
+    LOG_INFO("预读输入: {} ({:.1f} MB), 后端 {}, 窗口 {} 块 x {} KB", path, size_ / 1048576.0,
+             backend_, blocks_.size() - 1, kReadAheadBlockSize / 1024);
+    if (bytes_per_us_ > 0 || latency_us_ > 0) {
+        LOG_INFO("预读输入: 模拟慢速存储, 带宽 {} MB/s, 每个请求延迟 {} ms", options.throttle_mbps,
+                 options.latency_ms);
+    }
+    return true;
+#else
+    (void)path;
+    (void)options;
+    return false;
+#endif
+}
+
+void ReadAheadInput::Close() {
+    io_ctx_.reset();
+    {
+        // 在途请求仍在写入槽位缓冲, 等它们全部完成后才能释放
+        std::unique_lock lk{mtx_};
+        while (in_flight_.load() > 0) {
+            WaitForCompletion(lk);
+        }
+        stop_ = true;
+    }
+    request_cv_.notify_all();
+    workers_.clear();  // std::jthread 析构时 join
+#ifdef AVPLAYER_HAVE_IO_URING
+    if (uring_) {
+        io_uring_queue_exit(&uring_->ring_);
+    }
+#endif
+    uring_.reset();
+#ifdef __linux__
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+#endif
+    fd_ = -1;
+    size_ = 0;
+    pos_ = 0;
+    blocks_.clear();
+    requests_.clear();
+}
+
+ReadAheadInput::Stats ReadAheadInput::GetStats() const {
+    Stats stats;
+    stats.backend_ = backend_;
+    stats.requests_ = requests_sent_.load();
+    stats.request_bytes_ = request_bytes_.load();
+    stats.reads_ = reads_.load();
+    stats.hits_ = hits_.load();
+    stats.stalls_ = stalls_.load();
+    stats.stall_ms_ = stall_us_.load() / 1000.0;
+    stats.max_stall_ms_ = stall_max_us_.load() / 1000.0;
+    stats.seeks_ = seeks_.load();
+    stats.retargets_ = retargets_.load();
+    stats.queue_depth_ = in_flight_.load();
+    stats.max_queue_depth_ = max_in_flight_.load();
+    if (stats.requests_ > 0) {
+        stats.avg_queue_depth_ = static_cast<double>(depth_sum_.load()) / stats.requests_;
+    }
+    return stats;
+}
+
+int ReadAheadInput::ReadPacket(void* opaque, uint8_t* buf, int buf_size) {
+    auto self = static_cast<ReadAheadInput*>(opaque);
+    if (self->pos_ >= self->size_) {
+        return AVERROR_EOF;
+    }
+    self->reads_.fetch_add(1, std::memory_order_relaxed);
+    if (self->uring_) {
+        self->ReapCompletions(false);
+    }
+    int64_t block = self->pos_ / kReadAheadBlockSize;
+    int64_t wait_start_us = 0;  // 开始等待 IO 的时刻 (0 表示没有等待)
+
+    std::unique_lock lk{self->mtx_};
+    self->Fill(block);
+    Block& current = self->blocks_[static_cast<std::size_t>(block) % self->blocks_.size()];
+    while (current.index_ != block || current.state_ == BlockState::kPending) {
+        if (wait_start_us == 0) {
+            wait_start_us = av_gettime_relative();
+        }
+        if (current.state_ != BlockState::kPending) {
+            self->Submit(block);  // 槽位上 seek 之前的旧请求已完成, 现在可以复用
+        } else {
+            self->WaitForCompletion(lk);
+        }
+    }
+    if (current.state_ == BlockState::kError) {
+        // 下次读取时重新请求
+        int error = current.error_;
+        current.index_ = -1;
+        current.state_ = BlockState::kIdle;
+        return error;
+    }
+    lk.unlock();  // 已就绪的槽位只有读取线程会修改
+
+    // 限速: 等到模型中数据到达的时刻
+    int64_t now_us = av_gettime_relative();
+    if (current.ready_us_ > now_us) {
+        if (wait_start_us == 0) {
+            wait_start_us = now_us;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(current.ready_us_ - now_us));
+    }
+    if (wait_start_us != 0) {
+        int64_t stall_us = av_gettime_relative() - wait_start_us;
+        self->stalls_.fetch_add(1, std::memory_order_relaxed);
+        self->stall_us_.fetch_add(stall_us, std::memory_order_relaxed);
+        self->stall_max_us_.store(std::max(self->stall_max_us_.load(), stall_us));
+    } else {
+        self->hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int64_t offset = self->pos_ - block * kReadAheadBlockSize;
+    if (offset >= current.length_) {
+        return AVERROR(EIO);  // 文件中间的短读 (例如文件被截断)
+    }
+    auto bytes = static_cast<int>(std::min<int64_t>(buf_size, current.length_ - offset));
+    std::memcpy(buf, current.data_.data() + offset, static_cast<std::size_t>(bytes));
+    self->pos_ += bytes;
+    return bytes;
+}
+
+int64_t ReadAheadInput::Seek(void* opaque, int64_t offset, int whence) {
+    auto self = static_cast<ReadAheadInput*>(opaque);
+    if (whence & AVSEEK_SIZE) {
+        return self->size_;
+    }
+    int64_t target = 0;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = self->pos_ + offset;
+            break;
+        case SEEK_END:
+            target = self->size_ + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+    self->seeks_.fetch_add(1, std::memory_order_relaxed);
+    if (self->uring_) {
+        self->ReapCompletions(false);
+    }
+    std::lock_guard lk{self->mtx_};
+    int64_t old_block = self->pos_ / kReadAheadBlockSize;
+    int64_t new_block = target / kReadAheadBlockSize;
+    if (new_block < old_block ||
+        new_block >= old_block + static_cast<int64_t>(self->blocks_.size())) {
+        self->Invalidate();
+    }
+    self->pos_ = target;  // 超出文件末尾时之后的读取返回 EOF
+    if (target < self->size_) {
+        // 立即按新位置请求整个窗口, 窗口外的旧块随槽位复用被丢弃
+        self->Fill(new_block);
+    }
+    return target;
+}
+
+void ReadAheadInput::Invalidate() {
+    retargets_.fetch_add(1, std::memory_order_relaxed);
+    // 线程池中尚未开始的请求直接取消 (已开始的和 io_uring 的请求完成后槽位才复用)
+    for (std::size_t slot : requests_) {
+        blocks_[slot].index_ = -1;
+        blocks_[slot].state_ = BlockState::kIdle;
+        in_flight_.fetch_sub(1);
+    }
+    requests_.clear();
+    // 限速模型: 设备放弃排队中的旧传输, 新位置的请求不必排在它们后面
+    device_free_us_ = std::min(device_free_us_, av_gettime_relative());
+}
+
+void ReadAheadInput::Fill(int64_t block) {
+    auto slots = static_cast<int64_t>(blocks_.size());
+    int64_t last = std::min(block + slots, (size_ + kReadAheadBlockSize - 1) / kReadAheadBlockSize);
+    for (int64_t index = block; index < last; ++index) {
+        const Block& slot = blocks_[static_cast<std::size_t>(index % slots)];
+        // 已经请求过, 或槽位上的旧请求仍在途 (完成后由读取时重新请求)
+        if (slot.index_ == index || slot.state_ == BlockState::kPending) {
+            continue;
+        }
+        Submit(index);
+    }
+}
+
+void ReadAheadInput::Submit(int64_t block) {
+    auto slot = static_cast<std::size_t>(block) % blocks_.size();
+    Block& current = blocks_[slot];
+    int64_t offset = block * kReadAheadBlockSize;
+    current.index_ = block;
+    current.state_ = BlockState::kPending;
+    current.length_ = static_cast<int>(std::min<int64_t>(kReadAheadBlockSize, size_ - offset));
+    current.error_ = 0;
+    current.ready_us_ = 0;
+    if (bytes_per_us_ > 0 || latency_us_ > 0) {
+        // 单设备模型: 每个请求先经过固定延迟 (多个在途请求的延迟互相重叠),
+        // 再按带宽依次传输 (带宽由所有请求共享)
+        auto transfer_us =
+            bytes_per_us_ > 0 ? static_cast<int64_t>(current.length_ / bytes_per_us_) : 0;
+        int64_t start_us = std::max(av_gettime_relative() + latency_us_, device_free_us_);
+        device_free_us_ = start_us + transfer_us;
+        current.ready_us_ = device_free_us_;
+    }
+
+    int depth = in_flight_.fetch_add(1) + 1;
+    max_in_flight_.store(std::max(max_in_flight_.load(), depth));
+    depth_sum_.fetch_add(depth, std::memory_order_relaxed);
+    requests_sent_.fetch_add(1, std::memory_order_relaxed);
+    request_bytes_.fetch_add(current.length_, std::memory_order_relaxed);
+
+#ifdef AVPLAYER_HAVE_IO_URING
+    if (uring_) {
+        // 在途请求不超过槽位数 (= 提交队列长度), 总能取到 SQE
+        io_uring_sqe* sqe = io_uring_get_sqe(&uring_->ring_);
+        if (uring_->readv_) {
+            iovec& iov = uring_->iovecs_[slot];
+            iov.iov_base = current.data_.data();
+            iov.iov_len = static_cast<std::size_t>(current.length_);
+            io_uring_prep_readv(sqe, fd_, &iov, 1, static_cast<uint64_t>(offset));
+        } else {
+            io_uring_prep_read(sqe, fd_, current.data_.data(),
+                               static_cast<unsigned>(current.length_),
+                               static_cast<uint64_t>(offset));
+        }
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(slot));
+        io_uring_submit(&uring_->ring_);
+        return;
+    }
+#endif
+    requests_.push_back(slot);
+    request_cv_.notify_one();
+}
+
+void ReadAheadInput::Complete(std::size_t slot, int result) {
+    std::lock_guard lk{mtx_};
+    Block& current = blocks_[slot];
+    if (result < 0) {
+        current.state_ = BlockState::kError;
+        current.error_ = result;
+    } else {
+        current.state_ = BlockState::kReady;
+        current.length_ = result;
+    }
+    in_flight_.fetch_sub(1);
+    done_cv_.notify_all();
+}
+
+void ReadAheadInput::WaitForCompletion(std::unique_lock<std::mutex>& lk) {
+    if (uring_) {
+        lk.unlock();
+        ReapCompletions(true);
+        lk.lock();
+        return;
+    }
+    done_cv_.wait(lk);
+}
+
+void ReadAheadInput::ReapCompletions(bool wait) {
+#ifdef AVPLAYER_HAVE_IO_URING
+    io_uring_cqe* cqe = nullptr;
+    int ret = wait ? io_uring_wait_cqe(&uring_->ring_, &cqe)
+                   : io_uring_peek_cqe(&uring_->ring_, &cqe);
+    while (ret == 0 && cqe) {
+        auto slot = reinterpret_cast<std::size_t>(io_uring_cqe_get_data(cqe));
+        int result = cqe->res;  // 读到的字节数或 -errno (即 AVERROR(errno))
+        io_uring_cqe_seen(&uring_->ring_, cqe);
+        Complete(slot, result);
+        ret = io_uring_peek_cqe(&uring_->ring_, &cqe);
+    }
+#else
+    (void)wait;
+#endif
+}
+
+void ReadAheadInput::WorkerLoop() {
+    SetCurrentThreadName("readahead");
+    while (true) {
+        std::size_t slot = 0;
+        uint8_t* data = nullptr;
+        int length = 0;
+        int64_t offset = 0;
+        {
+            std::unique_lock lk{mtx_};
+            request_cv_.wait(lk, [this] { return stop_ || !requests_.empty(); });
+            if (requests_.empty()) {
+                return;  // 已停止 (Close 会先等待所有请求完成)
+            }
+            slot = requests_.front();
+            requests_.pop_front();
+            // 槽位在请求完成前不会被复用, 可以在锁外写入它的缓冲
+            Block& current = blocks_[slot];
+            data = current.data_.data();
+            length = current.length_;
+            offset = current.index_ * kReadAheadBlockSize;
+        }
+        int result = 0;
+#ifdef __linux__
+        // pread 可能短读, 读满请求的长度或到文件末尾为止
+        while (result < length) {
+            ssize_t bytes = pread(fd_, data + result, static_cast<std::size_t>(length - result),
+                                  offset + result);
+            if (bytes < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytes < 0) {
+                result = AVERROR(errno);
+                break;
+            }
+            if (bytes == 0) {
+                break;
+            }
+            result += static_cast<int>(bytes);
+        }
+#endif
+        Complete(slot, result);
+    }
+}
+
+}  // namespace avplayer
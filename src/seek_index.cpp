@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <avplayer/logger.hpp>
+#include <avplayer/seek_index.hpp>
+#include <avplayer/stats.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace avplayer {
+
+namespace {
+
+constexpr char kSidecarMagic[8] = {'A', 'V', 'P', 'I', 'D', 'X', '0', '1'};
+constexpr double kMaxTimestampGap = 3600.0;  // 相邻关键帧间隔超过 1 小时视为时间戳跳变, 不索引
+
+// sidecar 文件对应的媒体文件标识 (大小 + 修改时间), 非本地文件时返回空
+std::optional<std::pair<uint64_t, int64_t>> GetFileIdentity(const std::string& file_path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(file_path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    auto mtime = std::filesystem::last_write_time(file_path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return std::pair{static_cast<uint64_t>(size),
+                     static_cast<int64_t>(mtime.time_since_epoch().count())};
+}
+
+template <typename T>
+void WriteValue(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool ReadValue(std::ifstream& in, T* value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(value), sizeof(*value)));
+}
+
+}  // namespace
+
+// =============================================================================
+// SeekIndex 实现
+// =============================================================================
+
+SeekIndex::~SeekIndex() { Stop(); }
+
+void SeekIndex::Start(std::string file_path, int stream_index, std::string sidecar_path) {
+    // 重新开始 (播放列表切换到下一项): 停止上一次的扫描并清空索引
+    Stop();
+    {
+        std::lock_guard lk{mtx_};
+        time_base_ = AVRational{0, 1};
+        entries_.clear();
+        buckets_.clear();
+    }
+    complete_.store(false, std::memory_order_release);
+    stop_.store(false);
+    file_path_ = std::move(file_path);
+    stream_index_ = stream_index;
+    sidecar_path_ = std::move(sidecar_path);
+    thread_ = std::jthread{[this] { BuildLoop(); }};
+}
+
+void SeekIndex::Stop() {
+    stop_.store(true);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SeekIndex::BuildLoop() {
+    SetCurrentThreadName("seek-index");
+    int64_t start_us = av_gettime_relative();
+    if (!sidecar_path_.empty() && LoadSidecar()) {
+        complete_.store(true, std::memory_order_release);
+        LOG_INFO("关键帧索引: 从 {} 加载 {} 个关键帧, 耗时 {:.1f} ms", sidecar_path_, GetSize(),
+                 (av_gettime_relative() - start_us) / 1000.0);
+        return;
+    }
+
+    // NOTE: 使用独立的 AVFormatContext, 不干扰读取线程的读取位置
+    AVFormatContext* fmt_ctx{avformat_alloc_context()};
+    if (!fmt_ctx) {
+        return;
+    }
+    fmt_ctx->interrupt_callback.callback = InterruptCallback;
+    fmt_ctx->interrupt_callback.opaque = this;
+    if (avformat_open_input(&fmt_ctx, file_path_.c_str(), nullptr, nullptr) < 0) {
+        LOG_WARN("关键帧索引: 打开输入文件失败, 不建立索引");
+        return;  // 失败时 avformat_open_input 会释放 fmt_ctx
+    }
+    UniqueAVFormatContext format_ctx{fmt_ctx};
+    // 与播放器一致地探测流信息, 保证流下标相同 (例如 MPEG-TS 的流在读取过程中才被发现)
+    if (avformat_find_stream_info(format_ctx.get(), nullptr) < 0 ||
+        stream_index_ < 0 || stream_index_ >= static_cast<int>(format_ctx->nb_streams)) {
+        LOG_WARN("关键帧索引: 获取流信息失败, 不建立索引");
+        return;
+    }
+    AVStream* stream = format_ctx->streams[stream_index_];
+    {
+        std::lock_guard lk{mtx_};
+        time_base_ = stream->time_base;
+    }
+    // 只需要这一路的包: 其他流直接丢弃, 部分 demuxer (例如 MP4) 会跳过读取其数据
+    for (unsigned int i = 0; i < format_ctx->nb_streams; ++i) {
+        if (static_cast<int>(i) != stream_index_) {
+            format_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    bool seeded = SeedFromDemuxer(format_ctx.get(), stream);
+    if (!seeded && !Scan(format_ctx.get(), stream)) {
+        return;  // 被 Stop 中断
+    }
+    complete_.store(true, std::memory_order_release);
+    LOG_INFO("关键帧索引: {} 个关键帧 ({}), 耗时 {:.1f} ms", GetSize(),
+             seeded ? "来自 demuxer 索引" : "扫描文件",
+             (av_gettime_relative() - start_us) / 1000.0);
+    if (!sidecar_path_.empty()) {
+        SaveSidecar();
+    }
+}
+
+bool SeekIndex::SeedFromDemuxer(AVFormatContext* fmt_ctx, AVStream* stream) {
+    int count = avformat_index_get_entries_count(stream);
+    if (count < 2) {
+        return false;
+    }
+    // 只有包含非关键帧条目的索引才是完整的 sample table (例如 MP4), 否则 (例如 MKV 的 Cues)
+    // 通常只覆盖部分关键帧, 仍需扫描
+    bool has_non_key = false;
+    for (int i = 0; i < count && !has_non_key; ++i) {
+        has_non_key = !(avformat_index_get_entry(stream, i)->flags & AVINDEX_KEYFRAME);
+    }
+    if (!has_non_key) {
+        return false;
+    }
+    LOG_DEBUG("关键帧索引: 使用 {} 的 demuxer 索引 ({} 个条目)", fmt_ctx->iformat->name, count);
+    // NOTE: demuxer 索引的时间戳是 dts, 与 pts 只差解码延迟的几帧, 用于定位关键帧足够
+    std::lock_guard lk{mtx_};
+    for (int i = 0; i < count; ++i) {
+        const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+        if (entry->flags & AVINDEX_KEYFRAME) {
+            Append({entry->timestamp, entry->pos, entry->size});
+        }
+    }
+    return !entries_.empty();
+}
+
+bool SeekIndex::Scan(AVFormatContext* fmt_ctx, AVStream* stream) {
+    UniqueAVPacket packet{av_packet_alloc()};
+    if (!packet) {
+        return false;
+    }
+    while (!stop_.load()) {
+        int ret = av_read_frame(fmt_ctx, packet.get());
+        if (ret < 0) {
+            return ret == AVERROR_EOF;  // 读取出错时索引不完整, 不保存
+        }
+        if (packet->stream_index == stream->index && (packet->flags & AV_PKT_FLAG_KEY)) {
+            int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            if (pts != AV_NOPTS_VALUE) {
+                std::lock_guard lk{mtx_};
+                Append({pts, packet->pos, packet->size});
+            }
+        }
+        av_packet_unref(packet.get());
+    }
+    return false;
+}
+
+void SeekIndex::Append(const Entry& entry) {
+    if (!entries_.empty()) {
+        if (entry.pts_ <= entries_.back().pts_ ||
+            (entry.pts_ - entries_.back().pts_) * av_q2d(time_base_) > kMaxTimestampGap) {
+            return;
+        }
+    }
+    entries_.push_back(entry);
+    auto bucket = BucketOf(entry.pts_);
+    while (buckets_.size() <= bucket) {
+        buckets_.push_back(entries_.size() - 1);
+    }
+}
+
+std::size_t SeekIndex::BucketOf(int64_t pts) const {
+    return static_cast<std::size_t>(
+        std::floor(static_cast<double>(pts - entries_.front().pts_) * av_q2d(time_base_)));
+}
+
+std::optional<SeekIndex::Entry> SeekIndex::Lookup(double time_sec) const {
+    std::lock_guard lk{mtx_};
+    if (entries_.empty() || time_base_.num == 0 || std::isnan(time_sec)) {
+        return std::nullopt;
+    }
+    auto target = static_cast<int64_t>(std::floor(time_sec / av_q2d(time_base_)));
+    if (target <= entries_.front().pts_) {
+        return entries_.front();
+    }
+    auto bucket = BucketOf(target);
+    if (bucket >= buckets_.size()) {
+        // 超出已索引范围: 扫描完成时最后一个关键帧就是答案, 否则后面可能还有未索引的关键帧
+        if (IsComplete()) {
+            return entries_.back();
+        }
+        return std::nullopt;
+    }
+    // buckets_[bucket] 之前的关键帧都早于该秒的起点 (<= target)
+    auto i = buckets_[bucket];
+    if (entries_[i].pts_ > target) {
+        return entries_[i - 1];
+    }
+    while (i + 1 < entries_.size() && entries_[i + 1].pts_ <= target) {
+        ++i;
+    }
+    if (i + 1 == entries_.size() && !IsComplete()) {
+        return std::nullopt;
+    }
+    return entries_[i];
+}
+
+std::size_t SeekIndex::GetSize() const {
+    std::lock_guard lk{mtx_};
+    return entries_.size();
+}
+
+bool SeekIndex::LoadSidecar() {
+    auto identity = GetFileIdentity(file_path_);
+    std::ifstream in{sidecar_path_, std::ios::binary};
+    if (!identity || !in) {
+        return false;
+    }
+    char magic[sizeof(kSidecarMagic)]{};
+    uint64_t file_size = 0;
+    int64_t mtime = 0;
+    int32_t stream_index = 0;
+    AVRational time_base{0, 1};
+    uint64_t count = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+        !std::equal(magic, magic + sizeof(magic), kSidecarMagic) ||
+        !ReadValue(in, &file_size) || !ReadValue(in, &mtime) || !ReadValue(in, &stream_index) ||
+        !ReadValue(in, &time_base.num) || !ReadValue(in, &time_base.den) ||
+        !ReadValue(in, &count)) {
+        return false;
+    }
+    // 媒体文件被修改过 (或不是同一路流) 时索引作废, 重新扫描
+    if (file_size != identity->first || mtime != identity->second ||
+        stream_index != stream_index_ || time_base.num <= 0 || time_base.den <= 0 ||
+        count > file_size) {
+        LOG_INFO("关键帧索引: {} 与媒体文件不匹配, 重新建立", sidecar_path_);
+        return false;
+    }
+    std::vector<Entry> entries(count);
+    for (auto& entry : entries) {
+        if (!ReadValue(in, &entry.pts_) || !ReadValue(in, &entry.pos_) ||
+            !ReadValue(in, &entry.size_)) {
+            return false;
+        }
+    }
+    std::lock_guard lk{mtx_};
+    time_base_ = time_base;
+    for (const auto& entry : entries) {
+        Append(entry);
+    }
+    return !entries_.empty();
+}
+
+void SeekIndex::SaveSidecar() const {
+    auto identity = GetFileIdentity(file_path_);
+    if (!identity) {
+        return;
+    }
+    // 先写临时文件再重命名, 避免中途退出留下不完整的索引
+    std::string tmp_path = sidecar_path_ + ".tmp";
+    {
+        std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+        if (!out) {
+            LOG_WARN("关键帧索引: 无法写入 {}", tmp_path);
+            return;
+        }
+        std::lock_guard lk{mtx_};
+        out.write(kSidecarMagic, sizeof(kSidecarMagic));
+        WriteValue(out, identity->first);
+        WriteValue(out, identity->second);
+        WriteValue(out, static_cast<int32_t>(stream_index_));
+        WriteValue(out, time_base_.num);
+        WriteValue(out, time_base_.den);
+        WriteValue(out, static_cast<uint64_t>(entries_.size()));
+        for (const auto& entry : entries_) {
+            WriteValue(out, entry.pts_);
+            WriteValue(out, entry.pos_);
+            WriteValue(out, entry.size_);
+        }
+        if (!out) {
+            LOG_WARN("关键帧索引: 写入 {} 失败", tmp_path);
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, sidecar_path_, ec);
+    if (ec) {
+        LOG_WARN("关键帧索引: 保存 {} 失败: {}", sidecar_path_, ec.message());
+        return;
+    }
+    LOG_INFO("关键帧索引: 已保存到 {}", sidecar_path_);
+}
+
+int SeekIndex::InterruptCallback(void* opaque) {
+    return static_cast<SeekIndex*>(opaque)->stop_.load() ? 1 : 0;
+}
+
+}  // namespace avplayer
@@ -0,0 +1,70 @@
+#include <avplayer/stats.hpp>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace avplayer {
+
+void SetCurrentThreadName(const char* name) {
+#ifdef __linux__
+    pthread_setname_np(pthread_self(), name);
+#else
+    (void)name;
+#endif
+}
+
+double GetCurrentThreadCpuTime() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec ts{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+    }
+#endif
+    return 0.0;
+}
+
+std::vector<ThreadCpuTime> GetThreadCpuTimes() {
+    std::vector<ThreadCpuTime> threads;
+#ifdef __linux__
+    const double ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task", ec)) {
+        ThreadCpuTime thread;
+        thread.tid_ = std::stoi(entry.path().filename().string());
+        std::ifstream comm_file{entry.path() / "comm"};
+        std::getline(comm_file, thread.name_);
+
+        // /proc/<tid>/stat: 第 2 个字段 (comm) 可能含空格, 从最后一个 ')' 之后开始解析
+        std::ifstream stat_file{entry.path() / "stat"};
+        std::string stat{std::istreambuf_iterator<char>(stat_file), {}};
+        auto pos = stat.rfind(')');
+        if (pos == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields{stat.substr(pos + 2)};
+        std::string field;
+        unsigned long long utime = 0;
+        unsigned long long stime = 0;
+        // 剩余字段从第 3 个 (state) 开始, utime/stime 分别是第 14/15 个
+        for (int index = 3; index <= 15 && fields >> field; ++index) {
+            if (index == 14) {
+                utime = std::stoull(field);
+            } else if (index == 15) {
+                stime = std::stoull(field);
+            }
+        }
+        thread.cpu_seconds_ = static_cast<double>(utime + stime) / ticks_per_second;
+        threads.push_back(std::move(thread));
+    }
+#endif
+    return threads;
+}
+
+}  // namespace avplayer
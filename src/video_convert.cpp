@@ -0,0 +1,460 @@
+#include <algorithm>
+#include <atomic>
+#include <avplayer/logger.hpp>
+#include <avplayer/video_convert.hpp>
+#include <cmath>
+#include <utility>
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AVPLAYER_X86_SIMD 1
+#endif
+
+namespace avplayer {
+
+// =============================================================================
+// 10 位 -> 8 位转换内核
+// =============================================================================
+
+namespace {
+
+inline uint8_t P10ToP8(uint16_t sample, int shift) {
+    return static_cast<uint8_t>(std::min((sample + (1u << (shift - 1))) >> shift, 255u));
+}
+
+void ConvertP10ToP8Scalar(const uint16_t* in, uint8_t* out, std::size_t count, int shift) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = P10ToP8(in[i], shift);
+    }
+}
+
+void DeinterleaveP10ToP8Scalar(const uint16_t* in, uint8_t* u, uint8_t* v, std::size_t count,
+                               int shift) {
+    for (std::size_t i = 0; i < count; ++i) {
+        u[i] = P10ToP8(in[i * 2], shift);
+        v[i] = P10ToP8(in[i * 2 + 1], shift);
+    }
+}
+
+#if defined(AVPLAYER_X86_SIMD)
+// NOTE: 构建不要求 -msse4.1 / -mavx2, 用 target 属性单独编译这些函数, 运行时按 CPU 选择
+// 取整: 饱和加上 1 << (shift - 1) 再右移 (P010 的 0xFFxx 不会溢出), packus 饱和到 255
+
+__attribute__((target("sse4.1"))) void ConvertP10ToP8Sse41(const uint16_t* in, uint8_t* out,
+                                                           std::size_t count, int shift) {
+    const __m128i round = _mm_set1_epi16(static_cast<int16_t>(1 << (shift - 1)));
+    const __m128i bits = _mm_cvtsi32_si128(shift);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+        a = _mm_srl_epi16(_mm_adds_epu16(a, round), bits);
+        b = _mm_srl_epi16(_mm_adds_epu16(b, round), bits);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(a, b));
+    }
+    ConvertP10ToP8Scalar(in + i, out + i, count - i, shift);
+}
+
+__attribute__((target("sse4.1"))) void DeinterleaveP10ToP8Sse41(const uint16_t* in, uint8_t* u,
+                                                                uint8_t* v, std::size_t count,
+                                                                int shift) {
+    const __m128i round = _mm_set1_epi16(static_cast<int16_t>(1 << (shift - 1)));
+    const __m128i bits = _mm_cvtsi32_si128(shift);
+    const __m128i low = _mm_set1_epi32(0xFFFF);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // U0 V0 U1 V1 ... (每个 32 位为一对 UV)
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2 + 8));
+        a = _mm_srl_epi16(_mm_adds_epu16(a, round), bits);
+        b = _mm_srl_epi16(_mm_adds_epu16(b, round), bits);
+        __m128i u16 = _mm_packus_epi32(_mm_and_si128(a, low), _mm_and_si128(b, low));
+        __m128i v16 = _mm_packus_epi32(_mm_srli_epi32(a, 16), _mm_srli_epi32(b, 16));
+        __m128i uv = _mm_packus_epi16(u16, v16);  // U0..U7 V0..V7
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(u + i), uv);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(v + i), _mm_unpackhi_epi64(uv, uv));
+    }
+    DeinterleaveP10ToP8Scalar(in + i * 2, u + i, v + i, count - i, shift);
+}
+
+__attribute__((target("avx2"))) void ConvertP10ToP8Avx2(const uint16_t* in, uint8_t* out,
+                                                        std::size_t count, int shift) {
+    const __m256i round = _mm256_set1_epi16(static_cast<int16_t>(1 << (shift - 1)));
+    const __m128i bits = _mm_cvtsi32_si128(shift);
+    std::size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+        a = _mm256_srl_epi16(_mm256_adds_epu16(a, round), bits);
+        b = _mm256_srl_epi16(_mm256_adds_epu16(b, round), bits);
+        // packus 按 128 位通道交错: a0-7 b0-7 | a8-15 b8-15, 再按 64 位重排
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    ConvertP10ToP8Sse41(in + i, out + i, count - i, shift);
+}
+
+__attribute__((target("avx2"))) void DeinterleaveP10ToP8Avx2(const uint16_t* in, uint8_t* u,
+                                                             uint8_t* v, std::size_t count,
+                                                             int shift) {
+    const __m256i round = _mm256_set1_epi16(static_cast<int16_t>(1 << (shift - 1)));
+    const __m128i bits = _mm_cvtsi32_si128(shift);
+    const __m256i low = _mm256_set1_epi32(0xFFFF);
+    // packus 之后各 32 位依次为 U0-3 U8-11 V0-3 V8-11 | U4-7 U12-15 V4-7 V12-15
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 2));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 2 + 16));
+        a = _mm256_srl_epi16(_mm256_adds_epu16(a, round), bits);
+        b = _mm256_srl_epi16(_mm256_adds_epu16(b, round), bits);
+        __m256i u16 = _mm256_packus_epi32(_mm256_and_si256(a, low), _mm256_and_si256(b, low));
+        __m256i v16 = _mm256_packus_epi32(_mm256_srli_epi32(a, 16), _mm256_srli_epi32(b, 16));
+        __m256i uv = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(u16, v16), order);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(u + i), _mm256_castsi256_si128(uv));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), _mm256_extracti128_si256(uv, 1));
+    }
+    DeinterleaveP10ToP8Sse41(in + i * 2, u + i, v + i, count - i, shift);
+}
+#endif
+
+SimdLevel DetectSimdLevel() {
+#if defined(AVPLAYER_X86_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::kAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return SimdLevel::kSse41;
+    }
+#endif
+    return SimdLevel::kScalar;
+}
+
+const SimdLevel kMaxSimdLevel = DetectSimdLevel();
+std::atomic<SimdLevel> simd_level{kMaxSimdLevel};
+
+}  // namespace
+
+SimdLevel GetSimdLevel() { return simd_level.load(std::memory_order_relaxed); }
+
+SimdLevel SetSimdLevel(SimdLevel level) {
+    level = std::min(level, kMaxSimdLevel);
+    simd_level.store(level, std::memory_order_relaxed);
+    return level;
+}
+
+const char* GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::kAvx2:
+            return "avx2";
+        case SimdLevel::kSse41:
+            return "sse4.1";
+        default:
+            return "scalar";
+    }
+}
+
+void ConvertP10ToP8(const uint16_t* in, uint8_t* out, std::size_t count, int shift) {
+#if defined(AVPLAYER_X86_SIMD)
+    switch (GetSimdLevel()) {
+        case SimdLevel::kAvx2:
+            return ConvertP10ToP8Avx2(in, out, count, shift);
+        case SimdLevel::kSse41:
+            return ConvertP10ToP8Sse41(in, out, count, shift);
+        default:
+            break;
+    }
+#endif
+    ConvertP10ToP8Scalar(in, out, count, shift);
+}
+
+void DeinterleaveP10ToP8(const uint16_t* in, uint8_t* u, uint8_t* v, std::size_t count,
+                         int shift) {
+#if defined(AVPLAYER_X86_SIMD)
+    switch (GetSimdLevel()) {
+        case SimdLevel::kAvx2:
+            return DeinterleaveP10ToP8Avx2(in, u, v, count, shift);
+        case SimdLevel::kSse41:
+            return DeinterleaveP10ToP8Sse41(in, u, v, count, shift);
+        default:
+            break;
+    }
+#endif
+    DeinterleaveP10ToP8Scalar(in, u, v, count, shift);
+}
+
+void ConvertP10ToP8Lut(const uint16_t* in, uint8_t* out, std::size_t count, int shift,
+                       const uint8_t* lut) {
+    // 高位对齐的 P010 先移到低 10 位作为表下标
+    int index_shift = shift - 2;
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = lut[(in[i] >> index_shift) & 0x3FF];
+    }
+}
+
+namespace {
+
+// 可以直接作为 SDL 纹理上传的像素格式
+struct TextureFormatEntry {
+    AVPixelFormat pixel_format_;
+    uint32_t texture_format_;
+};
+
+constexpr TextureFormatEntry kTextureFormats[] = {
+    {AV_PIX_FMT_YUV420P, SDL_PIXELFORMAT_IYUV}, {AV_PIX_FMT_YUVJ420P, SDL_PIXELFORMAT_IYUV},
+    {AV_PIX_FMT_NV12, SDL_PIXELFORMAT_NV12},    {AV_PIX_FMT_NV21, SDL_PIXELFORMAT_NV21},
+    {AV_PIX_FMT_YUYV422, SDL_PIXELFORMAT_YUY2}, {AV_PIX_FMT_UYVY422, SDL_PIXELFORMAT_UYVY},
+};
+
+// 色调映射参数
+constexpr double kSdrWhiteNits = 203.0;  // HDR 参考白 (BT.2408), 映射到 SDR 的 100% 白
+constexpr double kHdrPeakNits = 1000.0;  // 假定的内容峰值亮度 (HLG 的标称峰值, 多数 PQ 母版)
+
+// PQ (SMPTE ST 2084) EOTF: 非线性信号 [0, 1] -> 绝对亮度 (nits)
+double PqToNits(double e) {
+    constexpr double kM1 = 2610.0 / 16384.0;
+    constexpr double kM2 = 2523.0 / 4096.0 * 128.0;
+    constexpr double kC1 = 3424.0 / 4096.0;
+    constexpr double kC2 = 2413.0 / 4096.0 * 32.0;
+    constexpr double kC3 = 2392.0 / 4096.0 * 32.0;
+    double p = std::pow(e, 1.0 / kM2);
+    return std::pow(std::max(p - kC1, 0.0) / (kC2 - kC3 * p), 1.0 / kM1) * 10000.0;
+}
+
+// HLG (ARIB STD-B67) 反 OETF + 标称 1000 nits 显示的 OOTF (gamma 1.2, 只作用于亮度的近似)
+double HlgToNits(double e) {
+    constexpr double kA = 0.17883277;
+    constexpr double kB = 0.28466892;
+    constexpr double kC = 0.55991073;
+    double scene = e <= 0.5 ? e * e / 3.0 : (std::exp((e - kC) / kA) + kB) / 12.0;
+    return kHdrPeakNits * std::pow(scene, 1.2);
+}
+
+}  // namespace
+
+// =============================================================================
+// VideoConverter 实现
+// =============================================================================
+
+void VideoConverter::Init(std::vector<uint32_t> native_formats, int threads, bool tonemap) {
+    native_formats_ = std::move(native_formats);
+    threads_ = std::max(threads, 1);
+    tonemap_ = tonemap;
+}
+
+bool VideoConverter::IsNative(uint32_t texture_format) const {
+    // IYUV 总是可用: 渲染器不原生支持时 SDL 内部转换 (与转换前的行为一致)
+    return texture_format == SDL_PIXELFORMAT_IYUV ||
+           std::find(native_formats_.begin(), native_formats_.end(), texture_format) !=
+               native_formats_.end();
+}
+
+bool VideoConverter::Configure(const AVFrame* frame, int level) {
+    int width = frame->width;
+    int height = frame->height;
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    in_width_ = width;
+    in_height_ = height;
+    in_format_ = format;
+    in_trc_ = frame->color_trc;
+    in_range_ = frame->color_range;
+    out_level_ = level;
+    out_width_ = (width + (1 << out_level_) - 1) >> out_level_;
+    out_height_ = (height + (1 << out_level_) - 1) >> out_level_;
+    sws_ctx_.reset();
+    stage_frame_.reset();
+
+    path_ = Path::kSwscale;
+    texture_format_ = SDL_PIXELFORMAT_IYUV;
+    out_format_ = AV_PIX_FMT_YUV420P;
+    for (const auto& entry : kTextureFormats) {
+        if (out_level_ == 0 && entry.pixel_format_ == format && IsNative(entry.texture_format_)) {
+            path_ = Path::kPassthrough;
+            texture_format_ = entry.texture_format_;
+            break;
+        }
+    }
+    const char* format_name = av_get_pix_fmt_name(format) ? av_get_pix_fmt_name(format) : "none";
+    if (path_ == Path::kPassthrough) {
+        LOG_INFO("视频格式转换: {} {}x{} -> {} 纹理, 路径: 直通", format_name, width, height,
+                 SDL_GetPixelFormatName(texture_format_));
+        return true;
+    }
+
+    if (format == AV_PIX_FMT_YUV420P10LE || format == AV_PIX_FMT_P010LE) {
+        path_ = Path::kKernel;
+        in_shift_ = format == AV_PIX_FMT_P010LE ? 8 : 2;
+        // P010 的色度本来就是交织的: 渲染器支持 NV12 时保持交织, 省去拆分
+        if (out_level_ == 0 && format == AV_PIX_FMT_P010LE && IsNative(SDL_PIXELFORMAT_NV12)) {
+            texture_format_ = SDL_PIXELFORMAT_NV12;
+            out_format_ = AV_PIX_FMT_NV12;
+        }
+        tonemap_active_ = tonemap_ && (frame->color_trc == AVCOL_TRC_SMPTE2084 ||
+                                       frame->color_trc == AVCOL_TRC_ARIB_STD_B67);
+        if (tonemap_active_) {
+            BuildToneMapLut(frame->color_trc, frame->color_range == AVCOL_RANGE_JPEG);
+        }
+        if (out_level_ > 0) {
+            // 内核先输出原尺寸的 YUV420P 中间帧, 再由 swscale 缩小
+            stage_frame_.reset(av_frame_alloc());
+            if (!stage_frame_) {
+                return false;
+            }
+            stage_frame_->width = width;
+            stage_frame_->height = height;
+            stage_frame_->format = AV_PIX_FMT_YUV420P;
+            if (av_frame_get_buffer(stage_frame_.get(), 0) < 0 ||
+                !CreateScaler(AV_PIX_FMT_YUV420P)) {
+                stage_frame_.reset();
+                return false;
+            }
+        }
+        const char* tonemap_name = "";
+        if (tonemap_active_) {
+            tonemap_name =
+                frame->color_trc == AVCOL_TRC_SMPTE2084 ? " + PQ 色调映射" : " + HLG 色调映射";
+        }
+        LOG_INFO("视频格式转换: {} {}x{} -> {} 纹理 {}x{}, 路径: {} 内核{}", format_name, width,
+                 height, SDL_GetPixelFormatName(texture_format_), out_width_, out_height_,
+                 GetSimdLevelName(GetSimdLevel()), tonemap_name);
+        return true;
+    }
+
+    if (!CreateScaler(format)) {
+        return false;
+    }
+    LOG_INFO("视频格式转换: {} {}x{} -> yuv420p {}x{} (IYUV 纹理), 路径: swscale ({} 线程)",
+             format_name, width, height, out_width_, out_height_, threads_);
+    return true;
+}
+
+bool VideoConverter::CreateScaler(AVPixelFormat format) {
+    // NOTE: sws_getCachedContext 无法设置线程数, 这里用 AVOption 配置后再初始化
+    // 缩小时用区域平均 (SWS_AREA), 按 2 的幂缩小时既快又没有双线性的混叠
+    int flags = out_level_ > 0 ? SWS_AREA : SWS_BILINEAR;
+    sws_ctx_.reset(sws_alloc_context());
+    SwsContext* ctx = sws_ctx_.get();
+    if (!ctx || av_opt_set_int(ctx, "srcw", in_width_, 0) < 0 ||
+        av_opt_set_int(ctx, "srch", in_height_, 0) < 0 ||
+        av_opt_set_int(ctx, "src_format", format, 0) < 0 ||
+        av_opt_set_int(ctx, "dstw", out_width_, 0) < 0 ||
+        av_opt_set_int(ctx, "dsth", out_height_, 0) < 0 ||
+        av_opt_set_int(ctx, "dst_format", AV_PIX_FMT_YUV420P, 0) < 0 ||
+        av_opt_set_int(ctx, "sws_flags", flags, 0) < 0 ||
+        av_opt_set_int(ctx, "threads", threads_, 0) < 0 ||
+        sws_init_context(ctx, nullptr, nullptr) < 0) {
+        const char* format_name = av_get_pix_fmt_name(format);
+        LOG_ERROR("视频格式转换: 创建 {} {}x{} -> {}x{} 的 swscale 上下文失败",
+                  format_name ? format_name : "none", in_width_, in_height_, out_width_,
+                  out_height_);
+        sws_ctx_.reset();
+        return false;
+    }
+    return true;
+}
+
+void VideoConverter::BuildToneMapLut(AVColorTransferCharacteristic trc, bool full_range) {
+    // 亮度码值 -> 绝对亮度 -> 以参考白归一化 -> 扩展 Reinhard 压缩高光 (峰值映射到 1.0)
+    // -> BT.1886 (gamma 2.4) 编码为 SDR 码值, 码值范围 (有限/完整) 与输入一致
+    // NOTE: 只映射亮度, 色度只降到 8 位; 不做 BT.2020 -> BT.709 色域转换, 颜色会偏淡
+    constexpr double kWhite = kHdrPeakNits / kSdrWhiteNits;
+    for (int code = 0; code < static_cast<int>(luma_lut_.size()); ++code) {
+        double e = full_range ? code / 1023.0 : (code - 64) / 876.0;
+        e = std::clamp(e, 0.0, 1.0);
+        double nits = trc == AVCOL_TRC_SMPTE2084 ? PqToNits(e) : HlgToNits(e);
+        double l = nits / kSdrWhiteNits;
+        double mapped = std::min(l * (1.0 + l / (kWhite * kWhite)) / (1.0 + l), 1.0);
+        double sdr = std::pow(mapped, 1.0 / 2.4);
+        double out = full_range ? sdr * 255.0 : 16.0 + sdr * 219.0;
+        luma_lut_[code] = static_cast<uint8_t>(std::lround(out));
+    }
+}
+
+void VideoConverter::ConvertHighBitDepth(const AVFrame* in, AVFrame* out) const {
+    int width = in->width;
+    int height = in->height;
+    int chroma_width = (width + 1) / 2;
+    int chroma_height = (height + 1) / 2;
+    auto row = [](const AVFrame* frame, int plane, int y) {
+        return reinterpret_cast<const uint16_t*>(frame->data[plane] + y * frame->linesize[plane]);
+    };
+    for (int y = 0; y < height; ++y) {
+        uint8_t* dst = out->data[0] + y * out->linesize[0];
+        if (tonemap_active_) {
+            ConvertP10ToP8Lut(row(in, 0, y), dst, width, in_shift_, luma_lut_.data());
+        } else {
+            ConvertP10ToP8(row(in, 0, y), dst, width, in_shift_);
+        }
+    }
+    for (int y = 0; y < chroma_height; ++y) {
+        if (in_format_ == AV_PIX_FMT_YUV420P10LE) {
+            ConvertP10ToP8(row(in, 1, y), out->data[1] + y * out->linesize[1], chroma_width,
+                           in_shift_);
+            ConvertP10ToP8(row(in, 2, y), out->data[2] + y * out->linesize[2], chroma_width,
+                           in_shift_);
+        } else if (out->format == AV_PIX_FMT_NV12) {
+            ConvertP10ToP8(row(in, 1, y), out->data[1] + y * out->linesize[1], chroma_width * 2,
+                           in_shift_);
+        } else {
+            DeinterleaveP10ToP8(row(in, 1, y), out->data[1] + y * out->linesize[1],
+                                out->data[2] + y * out->linesize[2], chroma_width, in_shift_);
+        }
+    }
+}
+
+int VideoConverter::Convert(AVFrame* in, AVFrame* out, uint32_t* texture_format) {
+    int level = downscale_failed_ ? 0 : downscale_level_;
+    if (in->width != in_width_ || in->height != in_height_ || in->format != in_format_ ||
+        in->color_trc != in_trc_ || in->color_range != in_range_ || level != out_level_) {
+        configured_ = Configure(in, level);
+        if (!configured_ && level > 0) {
+            // 缩放上下文创建失败: 之后不再降分辨率, 按原尺寸转换
+            LOG_WARN("视频格式转换: 降分辨率失败, 之后按原尺寸输出");
+            downscale_failed_ = true;
+            configured_ = Configure(in, 0);
+        }
+    }
+    if (path_ == Path::kPassthrough) {
+        *texture_format = texture_format_;
+        av_frame_move_ref(out, in);
+        return 0;
+    }
+    if (!configured_) {
+        return AVERROR(ENOSYS);  // 无法转换该输入 (Configure 已输出错误), 直到输入参数变化
+    }
+
+    out->width = out_width_;
+    out->height = out_height_;
+    out->format = out_format_;
+    int ret = pool_.GetVideoBuffer(out, nullptr, 0);
+    if (ret >= 0) {
+        if (path_ != Path::kKernel) {
+            ret = sws_scale_frame(sws_ctx_.get(), out, in);
+        } else if (out_level_ == 0) {
+            ConvertHighBitDepth(in, out);
+        } else {
+            ConvertHighBitDepth(in, stage_frame_.get());
+            ret = sws_scale_frame(sws_ctx_.get(), out, stage_frame_.get());
+        }
+    }
+    if (ret >= 0) {
+        ret = av_frame_copy_props(out, in);  // pts, 宽高比, opaque (包的字节位置) 等
+    }
+    if (ret < 0) {
+        av_frame_unref(out);
+        return ret;
+    }
+    if (path_ == Path::kKernel && tonemap_active_) {
+        out->color_trc = AVCOL_TRC_BT709;
+    }
+    *texture_format = texture_format_;
+    av_frame_unref(in);
+    return 0;
+}
+
+}  // namespace avplayer
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <avplayer/logger.hpp>
+#include <avplayer/vsync.hpp>
+
+namespace avplayer {
+
+namespace {
+
+constexpr double kCadenceTieMargin = 0.15;   // 距两个槽位正中小于此比例 (周期) 时视为平局
+constexpr double kPeriodGain = 0.02;         // 周期修正的平滑系数
+constexpr double kPhaseGain = 0.1;           // 相位 (锚点) 修正的平滑系数
+constexpr double kMaxPeriodDeviation = 0.1;  // 修正后的周期偏离标称值的上限 (比例)
+constexpr double kMaxSampleJitter = 0.1;     // 间隔样本偏离整数个周期的上限 (比例), 超过则不采样
+constexpr int kMaxSampleVsyncs = 4;          // 只用跨越不超过此周期数的间隔修正周期
+
+}  // namespace
+
+void VsyncScheduler::Reset(double refresh_hz) {
+    double nominal = refresh_hz > 0 ? 1.0 / refresh_hz : 0;
+    if (nominal == nominal_period_) {
+        return;
+    }
+    nominal_period_ = nominal;
+    period_ = nominal;
+    anchor_ = NAN;
+    last_presented_ = NAN;
+    last_vsyncs_ = 0;
+    period_ns_.store(static_cast<int64_t>(period_ * 1e9));
+    if (IsActive()) {
+        LOG_INFO("按垂直同步槽位调度视频帧, 标称刷新率 {} Hz", refresh_hz);
+    }
+}
+
+VsyncScheduler::Slot VsyncScheduler::Assign(double target) const {
+    if (!IsActive() || std::isnan(anchor_)) {
+        return {target, 0, false};
+    }
+    double ideal = (target - anchor_) / period_;
+    if (ideal < 0.5 - kCadenceTieMargin) {
+        // 上一帧所在的垂直同步离理想时刻最近
+        return {anchor_ + period_, 1, true};
+    }
+    double lower = std::floor(ideal);
+    double fraction = ideal - lower;
+    int vsyncs = static_cast<int>(lower);
+    if (std::abs(fraction - 0.5) < kCadenceTieMargin) {
+        // 平局: 与上一帧的选择交替 (上一帧取了较少的周期, 这一帧就取较多的, 反之亦然)
+        vsyncs += last_vsyncs_ == vsyncs ? 1 : 0;
+    } else if (fraction > 0.5) {
+        ++vsyncs;
+    }
+    // 平局区间的下界可能是 0: 至少下一次垂直同步 (同一次垂直同步只能显示一帧)
+    vsyncs = std::max(vsyncs, 1);
+    return {anchor_ + vsyncs * period_, vsyncs, false};
+}
+
+double VsyncScheduler::GetWakeTime(const Slot& slot) const {
+    return slot.vsyncs_ > 0 ? slot.time_ - period_ / 2 : slot.time_;
+}
+
+void VsyncScheduler::OnPresented(double target, const Slot& slot, double presented) {
+    if (!IsActive()) {
+        return;
+    }
+    // 用相邻两次呈现的间隔修正周期 (只用跨越少数几个周期的间隔, 否则整数周期数不可靠)
+    if (!std::isnan(last_presented_)) {
+        double interval = presented - last_presented_;
+        double vsyncs = std::round(interval / period_);
+        if (vsyncs >= 1 && vsyncs <= kMaxSampleVsyncs &&
+            std::abs(interval - vsyncs * period_) < kMaxSampleJitter * period_) {
+            period_ += kPeriodGain * (interval / vsyncs - period_);
+            period_ = std::clamp(period_, nominal_period_ * (1 - kMaxPeriodDeviation),
+                                 nominal_period_ * (1 + kMaxPeriodDeviation));
+            period_ns_.store(static_cast<int64_t>(period_ * 1e9));
+        }
+    }
+    last_presented_ = presented;
+
+    if (slot.vsyncs_ == 0) {
+        // 第一帧 (或相位丢失后): 以实际呈现时刻为锚点
+        anchor_ = presented;
+        last_vsyncs_ = 0;
+        return;
+    }
+    double offset = presented - slot.time_;
+    if (std::abs(offset) < period_ / 2) {
+        // 落在分配的垂直同步上: 平滑修正相位
+        anchor_ = slot.time_ + kPhaseGain * offset;
+    } else {
+        // 错过了 (或提前落在了前一次) 垂直同步: 直接以实际呈现时刻为新锚点
+        if (offset > 0) {
+            ++missed_;
+        }
+        anchor_ = presented;
+    }
+    last_vsyncs_ = slot.vsyncs_;
+
+    ++frames_;
+    auto error_us = static_cast<int64_t>(std::abs(slot.time_ - target) * 1e6);
+    cadence_error_us_ += error_us;
+    cadence_error_max_us_ = std::max(cadence_error_max_us_.load(), error_us);
+    ++vsyncs_[std::min<std::size_t>(slot.vsyncs_, vsyncs_.size()) - 1];
+}
+
+VsyncScheduler::Stats VsyncScheduler::GetStats() const {
+    Stats stats;
+    int64_t period_ns = period_ns_.load();
+    stats.active_ = period_ns > 0;
+    stats.refresh_hz_ = period_ns > 0 ? 1e9 / static_cast<double>(period_ns) : 0;
+    stats.frames_ = frames_.load();
+    stats.missed_ = missed_.load();
+    stats.dropped_ = dropped_.load();
+    if (stats.frames_ > 0) {
+        stats.avg_cadence_error_ms_ = cadence_error_us_.load() / 1000.0 / stats.frames_;
+    }
+    stats.max_cadence_error_ms_ = cadence_error_max_us_.load() / 1000.0;
+    for (std::size_t i = 0; i < stats.vsyncs_.size(); ++i) {
+        stats.vsyncs_[i] = vsyncs_[i].load();
+    }
+    return stats;
+}
+
+}  // namespace avplayer
@@ -12,14 +12,54 @@ add_requires("ffmpeg")
 add_requires("libsdl2")
 add_requires("spdlog")
 add_requires("cxxopts")
+-- 可选: 预读输入的 io_uring 后端 (找不到时使用线程池 pread)
+if is_plat("linux") then
+    add_requires("liburing", {optional = true})
+end
 
 target("avplayer", function () 
     set_kind("binary")
     add_files("src/*.cpp")
     add_includedirs("include")
-    add_packages("libsdl2", "ffmpeg", "spdlog", "cxxopts")
+    add_packages("libsdl2", "ffmpeg", "spdlog", "cxxopts", "liburing")
+    -- 找到可选的 liburing 时才编译预读输入的 io_uring 后端
+    if has_package("liburing") then
+        add_defines("AVPLAYER_HAVE_LIBURING")
+    end
     set_rundir("$(projectdir)")
 end)
 
+target("packet_queue_bench", function ()
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/packet_queue_bench.cpp", "src/core.cpp")
+    add_includedirs("include")
+    add_packages("libsdl2", "ffmpeg", "spdlog", "cxxopts")
+end)
 
+target("video_convert_bench", function ()
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/video_convert_bench.cpp", "src/core.cpp", "src/video_convert.cpp")
+    add_includedirs("include")
+    add_packages("libsdl2", "ffmpeg", "spdlog", "cxxopts")
+end)
 
+target("demux_bench", function ()
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/demux_bench.cpp", "src/core.cpp", "src/mmap_io.cpp")
+    add_includedirs("include")
+    add_packages("libsdl2", "ffmpeg", "spdlog", "cxxopts")
+end)
+
+target("read_ahead_bench", function ()
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/read_ahead_bench.cpp", "src/core.cpp", "src/read_ahead.cpp", "src/stats.cpp")
+    add_includedirs("include")
+    add_packages("libsdl2", "ffmpeg", "spdlog", "cxxopts", "liburing")
+    if has_package("liburing") then
+        add_defines("AVPLAYER_HAVE_LIBURING")
+    end
+end)